@@ -0,0 +1,153 @@
+// measures the throughput of the syntax highlighter's tokenizers in MB/s
+// usage: BFileX_highlight_bench [file]
+// without a file a synthetic C++ and markdown source are generated in memory
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/SyntaxHighlighter.hpp"
+
+namespace {
+    constexpr size_t syntheticSize = 64 * 1024 * 1024;
+
+    const std::string cppSample =
+            "#include <vector>\n"
+            "/* a block comment\n"
+            "   spanning lines */\n"
+            "static constexpr int limit = 0x7fff'ffff; // trailing comment\n"
+            "std::vector<std::string> split(const std::string& text, char separator) {\n"
+            "    std::vector<std::string> parts;\n"
+            "    const char* raw = R\"(raw \"string\" literal)\";\n"
+            "    for (size_t i = 0; i < text.size(); ++i) { if (text[i] == '\\n') parts.emplace_back(\"\\\"x\\\"\"); }\n"
+            "    return parts;\n"
+            "}\n";
+
+    const std::string markdownSample =
+            "# Heading\n"
+            "Some *emphasis*, **strong** text and `inline code` with a [link](https://example.com).\n"
+            "- list item\n"
+            "1. numbered item\n"
+            "> quoted text\n"
+            "```cpp\n"
+            "int main() { return 0; }\n"
+            "```\n";
+
+    std::string repeat(const std::string& sample, const size_t size) {
+        std::string text;
+        text.reserve(size + sample.size());
+        while (text.size() < size) {
+            text += sample;
+        }
+        return text;
+    }
+
+    std::vector<std::string_view> splitLines(const std::string_view text) {
+        std::vector<std::string_view> lines;
+        size_t start{};
+        for (size_t newLine; (newLine = text.find('\n', start)) != std::string_view::npos; start = newLine + 1) {
+            lines.push_back(text.substr(start, newLine - start));
+        }
+        if (start < text.size()) {
+            lines.push_back(text.substr(start));
+        }
+        return lines;
+    }
+
+    // lexes all lines, producing tokens or only tracking the state, and returns the throughput in MB/s
+    // the tokens produced are counted into `tokenCount`, which is printed so the work isn't optimized away
+    double measure(const std::vector<std::string_view>& lines, const size_t bytes, const Tokenizer tokenizer,
+                   const bool produceTokens, size_t& tokenCount) {
+        std::vector<Token> tokens;
+        tokenCount = 0;
+        LexState state = LexState::Normal;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& line : lines) {
+            tokens.clear();
+            state = tokenizer(line, state, produceTokens ? &tokens : nullptr);
+            tokenCount += tokens.size();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // the final state is counted too, so the state-only run is observable as well
+        tokenCount += static_cast<size_t>(state);
+
+        return static_cast<double>(bytes) / (1024.0 * 1024.0) / elapsed.count();
+    }
+
+    void report(const std::string& name, const std::string& text, const Tokenizer tokenizer) {
+        const auto lines = splitLines(text);
+
+        size_t stateCount{};
+        size_t tokenCount{};
+        const double stateOnly = measure(lines, text.size(), tokenizer, false, stateCount);
+        const double tokenize = measure(lines, text.size(), tokenizer, true, tokenCount);
+
+        std::printf("%-10s %8.1f MB  state-only %8.1f MB/s  tokenize %8.1f MB/s  %zu tokens\n",
+                    name.c_str(), text.size() / (1024.0 * 1024.0), stateOnly, tokenize, tokenCount - stateCount);
+    }
+
+    // measures how long finding the state deep into a file takes with cold and warm checkpoints
+    void reportCheckpoints(const std::string& path, const FileType fileType) {
+        SyntaxHighlighter highlighter;
+        highlighter.setFile(path, fileType);
+
+        const auto time = [&](const uint64_t offset) {
+            const auto start = std::chrono::steady_clock::now();
+            highlighter.getStateAt(offset);
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        // the start of a line deep into the file, within the catch-up limit
+        std::ifstream file(path, std::ios::binary);
+        file.seekg(std::min<uint64_t>(fs::file_size(path) / 2, SyntaxHighlighter::maxCatchUpBytes / 2));
+        std::string rest;
+        std::getline(file, rest);
+        const uint64_t offset = file ? static_cast<uint64_t>(file.tellg()) : 0;
+
+        const double cold = time(offset);
+        const double warm = time(offset);
+
+        std::printf("checkpoints: state at offset %llu  cold %.3f ms  warm %.3f ms\n",
+                    static_cast<unsigned long long>(offset), cold, warm);
+    }
+}
+
+int main(const int argc, char** argv) {
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (not file.is_open()) {
+            std::cerr << "Failed to open file: " << argv[1] << '\n';
+            return EXIT_FAILURE;
+        }
+
+        std::stringstream content;
+        content << file.rdbuf();
+
+        const FileType fileType = FileProperties::Types::determineFileType(argv[1]);
+        const Tokenizer tokenizer = Tokenizers::getTokenizer(fileType);
+        if (tokenizer == nullptr) {
+            std::cerr << "No tokenizer for file: " << argv[1] << '\n';
+            return EXIT_FAILURE;
+        }
+
+        report(fs::path(argv[1]).filename().string(), content.str(), tokenizer);
+        reportCheckpoints(argv[1], fileType);
+        return EXIT_SUCCESS;
+    }
+
+    report("cpp", repeat(cppSample, syntheticSize), Tokenizers::tokenizeCpp);
+    report("markdown", repeat(markdownSample, syntheticSize), Tokenizers::tokenizeMarkdown);
+
+    // write the synthetic source to a file to measure the checkpoints
+    const fs::path path = fs::temp_directory_path() / "BFileX_highlight_bench.cpp";
+    std::ofstream(path, std::ios::binary) << repeat(cppSample, SyntaxHighlighter::maxCatchUpBytes * 2);
+    reportCheckpoints(path.string(), FileType::Cpp);
+    fs::remove(path);
+}
@@ -0,0 +1,338 @@
+// measures the listing hot paths on synthetic directories: reading, sorting, searching and classifying entries
+// usage: BFileX_bench [--entries 10000,100000] [--name-length 8-24] [--hidden-ratio 0.1]
+//                     [--directory-ratio 0.2] [--repeat 5] [--seed 1] [--root path] [--output file] [--keep]
+// prints a table to stderr and the results as JSON to stdout, or to `--output`
+// cold runs drop the listing cache, and the kernel's caches too when run as root
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <sys/stat.h>
+
+#include "../src/FileManager.hpp"
+#include "../src/FileProperties.hpp"
+#include "../src/ListingCache.hpp"
+
+namespace {
+    struct Options {
+        std::vector<size_t> entryCounts{10000, 100000};
+        size_t minNameLength = 8;
+        size_t maxNameLength = 24;
+        double hiddenRatio = 0.1;
+        double directoryRatio = 0.2;
+        size_t repeat = 5;
+        uint32_t seed = 1;
+        fs::path root = fs::temp_directory_path() / "BFileX_bench";
+        std::string output;
+        bool keep{};
+    };
+
+    struct Result {
+        std::string name;
+        size_t entries{};
+        std::vector<double> times; // milliseconds
+    };
+
+    // extensions given to the files, so classifying them goes through the extension maps
+    const std::vector<std::string> extensions{"", ".cpp", ".hpp", ".md", ".txt", ".png", ".json", ".tar.gz", ".sh"};
+
+    std::vector<size_t> parseCounts(const std::string& text) {
+        std::vector<size_t> counts;
+        std::stringstream stream(text);
+        for (std::string count; std::getline(stream, count, ',');) {
+            counts.push_back(std::stoull(count));
+        }
+        return counts;
+    }
+
+    Options parseOptions(const int argc, char** argv) {
+        Options options;
+
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view argument = argv[i];
+            const auto next = [&]() -> std::string {
+                if (i + 1 == argc) {
+                    std::cerr << "Missing value for " << argument << '\n';
+                    std::exit(EXIT_FAILURE);
+                }
+                return argv[++i];
+            };
+
+            if (argument == "--entries") {
+                options.entryCounts = parseCounts(next());
+            } else if (argument == "--name-length") {
+                const std::string range = next();
+                const size_t dash = range.find('-');
+                options.minNameLength = std::stoull(range.substr(0, dash));
+                options.maxNameLength = dash == std::string::npos ? options.minNameLength
+                                                                  : std::stoull(range.substr(dash + 1));
+            } else if (argument == "--hidden-ratio") {
+                options.hiddenRatio = std::stod(next());
+            } else if (argument == "--directory-ratio") {
+                options.directoryRatio = std::stod(next());
+            } else if (argument == "--repeat") {
+                options.repeat = std::max<size_t>(std::stoull(next()), 1);
+            } else if (argument == "--seed") {
+                options.seed = static_cast<uint32_t>(std::stoul(next()));
+            } else if (argument == "--root") {
+                options.root = next();
+            } else if (argument == "--output") {
+                options.output = next();
+            } else if (argument == "--keep") {
+                options.keep = true;
+            } else {
+                std::cerr << "Unknown option: " << argument << '\n';
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        options.maxNameLength = std::max(options.maxNameLength, options.minNameLength);
+        return options;
+    }
+
+    // fills `directory` with `count` entries: files of random sizes and times, empty directories,
+    // some of both hidden, with random names of the configured lengths
+    void generateTree(const fs::path& directory, const size_t count, const Options& options) {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+
+        std::mt19937 random(options.seed);
+        std::uniform_int_distribution<size_t> nameLength(options.minNameLength, options.maxNameLength);
+        std::uniform_int_distribution<int> letter(0, 35);
+        std::uniform_int_distribution<size_t> extension(0, extensions.size() - 1);
+        std::uniform_real_distribution<double> ratio(0, 1);
+        std::uniform_int_distribution<off_t> size(0, 64 * 1024 * 1024);
+        std::uniform_int_distribution<time_t> age(0, 5 * 365 * 24 * 60 * 60);
+        const time_t now = std::time(nullptr);
+
+        for (size_t i = 0; i < count; ++i) {
+            std::string name = ratio(random) < options.hiddenRatio ? "." : "";
+            for (size_t length = nameLength(random); name.size() < length;) {
+                const int c = letter(random);
+                name += static_cast<char>(c < 26 ? 'a' + c : '0' + c - 26);
+            }
+            // the index keeps the names unique
+            name += "_" + std::to_string(i);
+
+            const fs::path path = directory / name;
+            if (ratio(random) < options.directoryRatio) {
+                mkdir(path.c_str(), 0755);
+                continue;
+            }
+
+            // sparse files, so their sizes differ without writing them
+            const std::string filePath = path.string() + extensions[extension(random)];
+            const int descriptor = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (descriptor < 0) {
+                std::cerr << "Failed to create " << filePath << ": " << std::strerror(errno) << '\n';
+                std::exit(EXIT_FAILURE);
+            }
+            const timespec modificationTime{now - age(random), 0};
+            const timespec times[2] = {modificationTime, modificationTime};
+            if (ftruncate(descriptor, size(random)) != 0 or futimens(descriptor, times) != 0) {
+                std::cerr << "Failed to resize " << filePath << ": " << std::strerror(errno) << '\n';
+            }
+            close(descriptor);
+        }
+
+        // a directory changed in the last second is read again every time, as it would be in the app
+        const timespec directoryTime{now - 60, 0};
+        const timespec directoryTimes[2] = {directoryTime, directoryTime};
+        utimensat(AT_FDCWD, directory.c_str(), directoryTimes, 0);
+    }
+
+    // drops the kernel's page, dentry and inode caches, only possible as root
+    bool dropKernelCaches() {
+        sync();
+        std::ofstream file("/proc/sys/vm/drop_caches");
+        return static_cast<bool>(file << "3" << std::flush);
+    }
+
+    // runs `work` `repeat` times, calling `prepare` untimed before every run
+    Result measure(const std::string& name, const size_t entries, const size_t repeat,
+                   const std::function<void()>& prepare, const std::function<void()>& work) {
+        Result result{name, entries, {}};
+        for (size_t i = 0; i < repeat; ++i) {
+            prepare();
+            const auto start = std::chrono::steady_clock::now();
+            work();
+            result.times.push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return result;
+    }
+
+    double getMedian(std::vector<double> times) {
+        std::sort(times.begin(), times.end());
+        const size_t middle = times.size() / 2;
+        return times.size() % 2 == 1 ? times[middle] : (times[middle - 1] + times[middle]) / 2;
+    }
+
+    double getMean(const std::vector<double>& times) {
+        double total{};
+        for (const double time : times) {
+            total += time;
+        }
+        return total / static_cast<double>(times.size());
+    }
+
+    std::vector<Result> runBenchmarks(const fs::path& directory, const size_t count, const Options& options,
+                                      const bool canDropKernelCaches) {
+        ListingCache& cache = ListingCache::getInstance();
+        std::vector<Result> results;
+        std::vector<fs::directory_entry> entries;
+        const size_t repeat = options.repeat;
+        const auto nothing = [] {};
+
+        // listing, from the disk and from the shared cache
+        const auto dropListing = [&] {
+            cache.invalidate(directory);
+            if (canDropKernelCaches) {
+                dropKernelCaches();
+            }
+        };
+        const auto list = [&] {
+            FileManager::setEntries(directory, entries, "", false, SortType::Normal, false);
+        };
+        results.push_back(measure("setEntries/cold", count, repeat, dropListing, list));
+        results.push_back(measure("setEntries/warm", count, repeat, nothing, list));
+
+        // showing hidden entries sorts the listing again from the cached entries
+        bool showHidden{};
+        results.push_back(measure("setEntries/resort", count, repeat, nothing, [&] {
+            showHidden = not showHidden;
+            FileManager::setEntries(directory, entries, "", showHidden, SortType::Normal, false);
+        }));
+
+        // sorting the listing from directory order, with the sizes and times read or already cached.
+        // the listing isn't sorted for `SortType::None`, so it isn't measured
+        FileManager::setEntries(directory, entries, "", true, SortType::None, false);
+        const std::vector<fs::directory_entry> unsortedEntries = entries;
+        const auto restore = [&] { entries = unsortedEntries; };
+
+        const std::vector<std::pair<std::string, SortType>> sortTypes{
+            {"normal", SortType::Normal}, {"time", SortType::Time}, {"size", SortType::Size}
+        };
+        for (const auto& [sortName, sortType] : sortTypes) {
+            if (sortType == SortType::Time or sortType == SortType::Size) {
+                // the listing is read again untimed, without the metadata read for the previous sort
+                results.push_back(measure("sortEntries/" + sortName + "/cold", count, repeat, [&] {
+                    cache.invalidate(directory);
+                    list();
+                    restore();
+                }, [&] { FileManager::sortEntries(entries, sortType, true, false); }));
+            }
+            results.push_back(measure("sortEntries/" + sortName + (sortType == SortType::Time or
+                                                                   sortType == SortType::Size ? "/warm" : ""),
+                                      count, repeat, restore,
+                                      [&] { FileManager::sortEntries(entries, sortType, true, false); }));
+        }
+
+        // searching the cached listing, the common case while typing a query
+        list();
+        for (const std::string query : {"a", "q7", "zzzz"}) {
+            results.push_back(measure("search/" + query, count, repeat, nothing, [&] {
+                FileManager::setEntries(directory, entries, query, false, SortType::Normal, false);
+            }));
+        }
+
+        // classifying the entries as rendering them does, for the icon and the color of every row
+        FileManager::setEntries(directory, entries, "", true, SortType::Normal, false);
+        size_t iconBytes{};
+        results.push_back(measure("getIcon", count, repeat, nothing, [&] {
+            for (const auto& entry : entries) {
+                iconBytes += FileProperties::Mapper::getIcon(entry).representation.size();
+            }
+        }));
+        results.push_back(measure("getColor", count, repeat, nothing, [&] {
+            for (const auto& entry : entries) {
+                iconBytes += static_cast<size_t>(FileProperties::Mapper::getColor(entry));
+            }
+        }));
+
+        // print what was computed, so the work isn't optimized away
+        std::fprintf(stderr, "classified %zu entries, checksum %zu\n", entries.size(), iconBytes);
+
+        return results;
+    }
+
+    std::string escape(const std::string& text) {
+        std::string escaped;
+        for (const char c : text) {
+            if (c == '"' or c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void writeJson(std::ostream& stream, const Options& options, const std::vector<Result>& results,
+                   const bool kernelCachesDropped) {
+        stream << "{\n"
+                << "  \"benchmark\": \"BFileX_bench\",\n"
+                << "  \"config\": {\"nameLength\": [" << options.minNameLength << ", " << options.maxNameLength << "], "
+                << "\"hiddenRatio\": " << options.hiddenRatio << ", "
+                << "\"directoryRatio\": " << options.directoryRatio << ", "
+                << "\"repeat\": " << options.repeat << ", "
+                << "\"seed\": " << options.seed << ", "
+                << "\"kernelCachesDropped\": " << (kernelCachesDropped ? "true" : "false") << "},\n"
+                << "  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            stream << "    {\"name\": \"" << escape(result.name) << "\", \"entries\": " << result.entries
+                    << ", \"minMs\": " << *std::min_element(result.times.begin(), result.times.end())
+                    << ", \"medianMs\": " << getMedian(result.times)
+                    << ", \"meanMs\": " << getMean(result.times)
+                    << ", \"timesMs\": [";
+            for (size_t j = 0; j < result.times.size(); ++j) {
+                stream << (j > 0 ? ", " : "") << result.times[j];
+            }
+            stream << "]}" << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+
+        stream << "  ]\n}\n";
+    }
+}
+
+int main(const int argc, char** argv) {
+    const Options options = parseOptions(argc, argv);
+    const bool kernelCachesDropped = dropKernelCaches();
+
+    std::vector<Result> results;
+    for (const size_t count : options.entryCounts) {
+        const fs::path directory = options.root / std::to_string(count);
+
+        std::fprintf(stderr, "generating %zu entries in %s\n", count, directory.c_str());
+        generateTree(directory, count, options);
+
+        for (Result& result : runBenchmarks(directory, count, options, kernelCachesDropped)) {
+            std::fprintf(stderr, "%-26s %9zu entries  min %10.3f ms  median %10.3f ms\n", result.name.c_str(),
+                         result.entries, *std::min_element(result.times.begin(), result.times.end()),
+                         getMedian(result.times));
+            results.push_back(std::move(result));
+        }
+
+        if (not options.keep) {
+            fs::remove_all(directory);
+        }
+    }
+
+    if (options.output.empty()) {
+        writeJson(std::cout, options, results, kernelCachesDropped);
+    } else {
+        std::ofstream file(options.output);
+        writeJson(file, options, results, kernelCachesDropped);
+    }
+}
@@ -0,0 +1,249 @@
+// replays scripted keys through the whole app with the output captured in memory, without a TTY
+// usage: BFileX_render_bench [--entries 100000] [--width 120] [--height 40] [--root path] [--output file] [--keep]
+// every key or resize is a step, reported with the time it took to handle and render and the bytes it wrote
+// prints a table to stderr and the results as JSON to stdout, or to `--output`
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/BFileX.hpp"
+#include "../src/InputHandler.hpp"
+#include "../src/OutputSink.hpp"
+
+namespace {
+    struct Options {
+        size_t entryCount = 100000;
+        int width = 120;
+        int height = 40;
+        fs::path root = fs::temp_directory_path() / "BFileX_render_bench";
+        std::string output;
+        bool keep{};
+    };
+
+    // a key, or a resize when `key` is 0
+    struct Step {
+        char key{};
+        int width{};
+        int height{};
+    };
+
+    struct Scenario {
+        std::string name;
+        bool showPreview{}; // set before the steps, untimed
+        std::vector<Step> steps;
+    };
+
+    struct StepResult {
+        double time{}; // microseconds
+        size_t bytes{};
+        size_t frames{};
+    };
+
+    Options parseOptions(const int argc, char** argv) {
+        Options options;
+
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view argument = argv[i];
+            const auto next = [&]() -> std::string {
+                if (i + 1 == argc) {
+                    std::cerr << "Missing value for " << argument << '\n';
+                    std::exit(EXIT_FAILURE);
+                }
+                return argv[++i];
+            };
+
+            if (argument == "--entries") {
+                options.entryCount = std::stoull(next());
+            } else if (argument == "--width") {
+                options.width = std::stoi(next());
+            } else if (argument == "--height") {
+                options.height = std::stoi(next());
+            } else if (argument == "--root") {
+                options.root = next();
+            } else if (argument == "--output") {
+                options.output = next();
+            } else if (argument == "--keep") {
+                options.keep = true;
+            } else {
+                std::cerr << "Unknown option: " << argument << '\n';
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        return options;
+    }
+
+    // a directory of small text files, so toggling the preview reads and highlights them, with a few directories
+    void generateTree(const fs::path& directory, const size_t count) {
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+
+        for (size_t i = 0; i < count; ++i) {
+            const std::string name = "entry_" + std::to_string(i);
+            if (i % 10 == 0) {
+                fs::create_directory(directory / name);
+                continue;
+            }
+
+            std::ofstream file(directory / (name + ".txt"));
+            file << "line " << i << " of a generated file\n";
+        }
+    }
+
+    std::vector<Scenario> getScenarios(const Options& options) {
+        std::vector<Scenario> scenarios;
+
+        // every entry from the top to the bottom, one key per entry
+        Scenario scroll{"scroll", false, {}};
+        scroll.steps.assign(options.entryCount, Step{'j'});
+        scenarios.push_back(std::move(scroll));
+
+        // scrolling with the preview shown, then hiding it
+        Scenario preview{"preview", true, {}};
+        for (int i = 0; i < 1000; ++i) {
+            preview.steps.push_back({'k'});
+        }
+        preview.steps.push_back({'p'});
+        scenarios.push_back(std::move(preview));
+
+        // growing and shrinking the terminal with the preview shown
+        Scenario resize{"resize", true, {}};
+        for (int i = 0; i < 300; ++i) {
+            resize.steps.push_back({0, 80, 24});
+            resize.steps.push_back({0, 200, 60});
+            resize.steps.push_back({0, options.width, options.height});
+        }
+        scenarios.push_back(std::move(resize));
+
+        return scenarios;
+    }
+
+    std::vector<StepResult> replay(const Scenario& scenario, const FrameBuffer& frames) {
+        App::getInstance().setShowPreview(scenario.showPreview);
+
+        std::vector<StepResult> results;
+        results.reserve(scenario.steps.size());
+
+        for (const Step& step : scenario.steps) {
+            const size_t bytes = frames.getTotalBytes();
+            const size_t frameCount = frames.getFrameCount();
+
+            const auto start = std::chrono::steady_clock::now();
+            if (step.key != 0) {
+                InputHandler::handleKey(step.key);
+            } else {
+                BFileX::resize(step.width, step.height);
+            }
+            const auto end = std::chrono::steady_clock::now();
+
+            results.push_back({
+                std::chrono::duration<double, std::micro>(end - start).count(),
+                frames.getTotalBytes() - bytes,
+                frames.getFrameCount() - frameCount
+            });
+        }
+
+        return results;
+    }
+
+    double getPercentile(const std::vector<double>& sortedValues, const double percentile) {
+        if (sortedValues.empty()) {
+            return 0;
+        }
+        const auto index = static_cast<size_t>(percentile / 100 * static_cast<double>(sortedValues.size() - 1));
+        return sortedValues[index];
+    }
+
+    void writeResult(std::FILE* file, const Scenario& scenario, const std::vector<StepResult>& results,
+                     const bool isLast) {
+        std::vector<double> times;
+        size_t totalBytes{};
+        size_t maxBytes{};
+        size_t frameCount{};
+        for (const StepResult& result : results) {
+            times.push_back(result.time);
+            totalBytes += result.bytes;
+            maxBytes = std::max(maxBytes, result.bytes);
+            frameCount += result.frames;
+        }
+        std::sort(times.begin(), times.end());
+
+        double totalTime{};
+        for (const double time : times) {
+            totalTime += time;
+        }
+        const double meanTime = times.empty() ? 0 : totalTime / static_cast<double>(times.size());
+        const double meanBytes = results.empty() ? 0 : static_cast<double>(totalBytes) / results.size();
+
+        std::fprintf(file,
+                     "    {\"name\": \"%s\", \"steps\": %zu, \"frames\": %zu, "
+                     "\"latencyUs\": {\"min\": %.2f, \"median\": %.2f, \"mean\": %.2f, \"p95\": %.2f, "
+                     "\"p99\": %.2f, \"max\": %.2f}, "
+                     "\"bytes\": {\"total\": %zu, \"meanPerStep\": %.1f, \"max\": %zu}}%s\n",
+                     scenario.name.c_str(), results.size(), frameCount,
+                     getPercentile(times, 0), getPercentile(times, 50), meanTime, getPercentile(times, 95),
+                     getPercentile(times, 99), getPercentile(times, 100),
+                     totalBytes, meanBytes, maxBytes, isLast ? "" : ",");
+
+        std::fprintf(stderr, "%-8s %7zu steps  median %9.2f us  p99 %9.2f us  max %10.2f us  %9.1f bytes/step\n",
+                     scenario.name.c_str(), results.size(), getPercentile(times, 50), getPercentile(times, 99),
+                     getPercentile(times, 100), meanBytes);
+    }
+}
+
+int main(const int argc, char** argv) {
+    const Options options = parseOptions(argc, argv);
+    const fs::path directory = options.root / "entries";
+
+    std::fprintf(stderr, "generating %zu entries in %s\n", options.entryCount, directory.c_str());
+    generateTree(directory, options.entryCount);
+
+    // keep the visited directories and thumbnails out of the user's data
+    setenv("XDG_DATA_HOME", (options.root / "data").c_str(), 1);
+    setenv("XDG_CACHE_HOME", (options.root / "cache").c_str(), 1);
+
+    // everything written through `std::cout` from here on is captured, the results are written with stdio.
+    // both outlive `main`, the UI restores the terminal into them when the program exits
+    auto& frames = *new FrameBuffer;
+    new OutputRedirect(frames);
+
+    std::string path = directory.string();
+    char name[] = "BFileX";
+    char* arguments[] = {name, path.data()};
+    BFileX::start(2, arguments);
+    BFileX::resize(options.width, options.height);
+
+    std::FILE* file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Failed to open %s\n", options.output.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::fprintf(file,
+                 "{\n  \"benchmark\": \"BFileX_render_bench\",\n"
+                 "  \"config\": {\"entries\": %zu, \"width\": %d, \"height\": %d},\n  \"scenarios\": [\n",
+                 options.entryCount, options.width, options.height);
+
+    const std::vector<Scenario> scenarios = getScenarios(options);
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        const std::vector<StepResult> results = replay(scenarios[i], frames);
+        writeResult(file, scenarios[i], results, i + 1 == scenarios.size());
+    }
+
+    std::fprintf(file, "  ]\n}\n");
+    if (file != stdout) {
+        std::fclose(file);
+    }
+
+    if (not options.keep) {
+        for (const char* generated : {"entries", "data", "cache"}) {
+            fs::remove_all(options.root / generated);
+        }
+    }
+}
@@ -1,16 +1,23 @@
 #include "App.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <filesystem>
+#include <unistd.h>
+#include <unordered_set>
 
 #include "FileProperties.hpp"
+#include "JumpDatabase.hpp"
+#include "ListingCache.hpp"
 #include "Terminal++.hpp"
 
 App::App()
-    : isRunning_(true), entryIndex(0), reverseEntries(false), showHiddenEntries(false),
-      showPreview(true), sortType(SortType::Normal), customFooter(nullptr), uiUpdateCallBack(nullptr),
-      initializeTerminalCallBack(nullptr) {
-    updateEntries(false);
+    : isRunning_(true), tabs(1), tabIndex(0), showPreview(true), showColumns(false), useTrash(true),
+      clipboardCut(false), customFooter(nullptr), uiUpdateCallBack(nullptr), initializeTerminalCallBack(nullptr),
+      pendingResizeCallBack(nullptr) {
+    // the first tab starts where BFileX was started, the working directory isn't used after this
+    getTab().path = fs::current_path();
+    readEntries();
 }
 
 App& App::getInstance() {
@@ -26,51 +33,187 @@ void App::quit() {
     isRunning_.store(false);
 }
 
+Tab& App::getTab() {
+    return tabs[tabIndex];
+}
+
+const Tab& App::getTab() const {
+    return tabs[tabIndex];
+}
+
+const fs::path& App::getCurrentPath() const {
+    return getTab().path;
+}
+
+fs::path App::getAbsolutePath(const fs::path& path) const {
+    fs::path absolutePath = (getCurrentPath() / path).lexically_normal();
+
+    // `a/..` normalizes to `a/`, without the trailing separator it compares equal to the listed paths
+    if (not absolutePath.has_filename() and absolutePath.has_relative_path()) {
+        absolutePath = absolutePath.parent_path();
+    }
+    return absolutePath;
+}
+
+void App::openTab() {
+    // the new tab shows the same listing, copying it doesn't read the directory again
+    Tab tab = getTab();
+    tab.selection.clear();
+
+    getTab().entriesIndices[getCurrentPath()] = getCurrentEntryIndex();
+    tabs.insert(tabs.begin() + static_cast<std::ptrdiff_t>(tabIndex) + 1, std::move(tab));
+    ++tabIndex;
+    updateUI();
+}
+
+void App::closeTab() {
+    if (tabs.size() == 1) {
+        return;
+    }
+
+    tabs.erase(tabs.begin() + static_cast<std::ptrdiff_t>(tabIndex));
+    setTabIndex(std::min(tabIndex, tabs.size() - 1));
+}
+
+void App::setTabIndex(const size_t index) {
+    if (index >= tabs.size()) {
+        return;
+    }
+    tabIndex = index;
+
+    // the directory may have changed while the tab wasn't shown, reading it is free if it didn't
+    readEntries();
+    setCurrentEntryIndex(getCurrentEntryIndex());
+}
+
+size_t App::getTabIndex() const {
+    return tabIndex;
+}
+
+size_t App::getTabCount() const {
+    return tabs.size();
+}
+
 size_t App::getCachedIndex(const fs::path& entry) const {
+    const auto& entriesIndices = getTab().entriesIndices;
     if (const auto it = entriesIndices.find(entry); it != entriesIndices.end()) {
         return it->second;
     }
     return 0;
 }
 
-std::vector<fs::directory_entry> App::getCurrentEntryChildren() {
+ListingOptions App::getListingOptions(const size_t maxRead) const {
+    return {getSearchQuery(), shouldShowHiddenEntries(), getSortType(), shouldReverseEntries(), maxRead};
+}
+
+DirectoryPage App::getCurrentEntryChildren(const size_t maxEntries, const size_t maxRead) {
     if (getCurrentEntry().is_directory()) {
-        std::vector<fs::directory_entry> children;
-        setEntries(children, getCurrentEntry().path());
-        return children;
+        const ListingOptions options = getListingOptions(maxRead);
+
+        // a directory shown in a tab or a column, e.g. the one just left, is already listed and sorted
+        if (const std::vector<fs::directory_entry>* entries = ListingCache::getInstance().findSortedEntries(
+                getCurrentEntry().path(), options.showHidden, options.sortType, options.reverse);
+            entries != nullptr and options.searchQuery.empty()) {
+            const size_t kept = std::min(entries->size(), std::max<size_t>(maxEntries, 1));
+            return {{entries->begin(), entries->begin() + static_cast<std::ptrdiff_t>(kept)}, entries->size() - kept};
+        }
+
+        // use the listing made while the entry was next to the selected one
+        if (auto page = Prefetcher::getInstance().getListing(getCurrentEntry().path(), options, maxEntries)) {
+            return std::move(*page);
+        }
+
+        return FileManager::getDirectoryPage(
+            getCurrentEntry().path(),
+            options.searchQuery,
+            options.showHidden,
+            options.sortType,
+            options.reverse,
+            maxEntries,
+            maxRead
+        );
     }
 
     return {};
 }
 
+std::pair<std::vector<fs::directory_entry>, size_t> App::getParentEntries(const size_t rows) const {
+    const fs::path& currentPath = getCurrentPath();
+    if (not currentPath.has_relative_path() or rows == 0) {
+        return {};
+    }
+
+    try {
+        // the parent is listed like the current directory, without its search
+        const std::vector<fs::directory_entry>& entries = ListingCache::getInstance().getSortedEntries(
+            currentPath.parent_path(), shouldShowHiddenEntries(), getSortType(), shouldReverseEntries());
+
+        // the current directory isn't listed in its parent if it's hidden, nothing is highlighted then
+        std::optional<size_t> foundIndex = FileManager::findSortedIndex(
+            fs::directory_entry(currentPath), entries, getSortType(), shouldShowHiddenEntries(),
+            shouldReverseEntries());
+        // changes in the current directory change its time, it may not be where the parent was sorted with it
+        if (not foundIndex and getSortType() == SortType::Time) {
+            const auto position = std::find_if(entries.begin(), entries.end(), [&](const fs::directory_entry& entry) {
+                return entry.path() == currentPath;
+            });
+            if (position != entries.end()) {
+                foundIndex = static_cast<size_t>(position - entries.begin());
+            }
+        }
+        const size_t index = foundIndex.value_or(0);
+
+        // only the rows shown are copied, with the current directory in the middle when it's not near the ends
+        const size_t first = std::min(index - std::min(index, rows / 2),
+                                      entries.size() - std::min(entries.size(), rows));
+        const size_t last = std::min(first + rows, entries.size());
+
+        return {
+            {entries.begin() + static_cast<std::ptrdiff_t>(first), entries.begin() + static_cast<std::ptrdiff_t>(last)},
+            foundIndex ? index - first : rows
+        };
+    } catch (const fs::filesystem_error&) {
+        return {};
+    }
+}
+
 void App::setCurrentEntryIndex(const size_t index) {
     // update the index to be the min between the previous index and the largest index
-    entryIndex = std::min(index, getEntries().size() - 1);
+    getTab().entryIndex = std::min(index, getEntries().size() - 1);
     updateUI();
 }
 
 [[nodiscard]] size_t App::getCurrentEntryIndex() const {
-    return entryIndex;
+    return getTab().entryIndex;
 }
 
 void App::incrementCurrentEntryIndex() {
-    setCurrentEntryIndex((getCurrentEntryIndex() + 1) % static_cast<int>(entries.size()));
+    setCurrentEntryIndex((getCurrentEntryIndex() + 1) % static_cast<int>(getEntries().size()));
 }
 
 void App::decrementCurrentEntryIndex() {
     if (getCurrentEntryIndex() == 0) {
-        setCurrentEntryIndex(static_cast<int>(entries.size()) - 1);
+        setCurrentEntryIndex(static_cast<int>(getEntries().size()) - 1);
     } else {
         setCurrentEntryIndex(getCurrentEntryIndex() - 1);
     }
 }
 
 fs::directory_entry& App::getCurrentEntry() {
-    return entries[getCurrentEntryIndex()];
+    return getEntries()[getCurrentEntryIndex()];
+}
+
+void App::readEntries() {
+    // keep the same entries marked after reading them again
+    const std::vector<fs::path> selectedPaths = getSelectedPaths();
+    setEntries(getEntries(), getCurrentPath());
+    restoreSelection(selectedPaths);
 }
 
 void App::updateEntries(const bool updateIndex) {
-    setEntries(getEntries(), fs::current_path());
+    // something changed on disk, the cached listing may not show it
+    ListingCache::getInstance().invalidate(getCurrentPath());
+    readEntries();
 
     if (updateIndex) {
         // make sure the current index is valid
@@ -90,56 +233,198 @@ void App::setEntries(std::vector<fs::directory_entry>& entries, const fs::path&
 }
 
 void App::sortEntries() {
+    const std::vector<fs::path> selectedPaths = getSelectedPaths();
     FileManager::sortEntries(
         getEntries(),
         getSortType(),
         shouldShowHiddenEntries(),
         shouldReverseEntries()
     );
+    restoreSelection(selectedPaths);
     updateUI();
 }
 
+Selection& App::getSelection() {
+    return getTab().selection;
+}
+
+std::vector<fs::path> App::getSelectedPaths() const {
+    const std::vector<fs::directory_entry>& entries = getTab().entries;
+
+    std::vector<fs::path> paths;
+    for (const size_t index : getTab().selection.getIndices()) {
+        if (index < entries.size()) {
+            paths.push_back(entries[index].path());
+        }
+    }
+    return paths;
+}
+
+void App::restoreSelection(const std::vector<fs::path>& selectedPaths) {
+    std::vector<fs::directory_entry>& entries = getEntries();
+    Selection& selection = getSelection();
+
+    selection.reset(entries.size());
+    if (selectedPaths.empty()) {
+        return;
+    }
+
+    const std::unordered_set<fs::path> selectedSet(selectedPaths.begin(), selectedPaths.end());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (selectedSet.count(entries[i].path()) > 0) {
+            selection.select(i);
+        }
+    }
+}
+
+void App::removeEntries(const std::vector<fs::path>& paths) {
+    if (paths.empty()) {
+        return;
+    }
+
+    std::vector<fs::directory_entry>& entries = getEntries();
+    Selection& selection = getSelection();
+    const size_t entryIndex = getCurrentEntryIndex();
+
+    const std::unordered_set<fs::path> removedSet(paths.begin(), paths.end());
+    std::vector<size_t> selectedIndices;
+    size_t currentIndex = entryIndex;
+    size_t keptEntries = 0;
+
+    // compact the entries in place, keeping their order and marks
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (removedSet.count(entries[i].path()) > 0) {
+            // keep the cursor on the same entry, or the one after it if it was removed
+            if (i < entryIndex) {
+                --currentIndex;
+            }
+            continue;
+        }
+
+        if (selection.isSelected(i)) {
+            selectedIndices.push_back(keptEntries);
+        }
+        if (keptEntries != i) {
+            entries[keptEntries] = std::move(entries[i]);
+        }
+        ++keptEntries;
+    }
+    entries.resize(keptEntries);
+
+    selection.reset(entries.size());
+    for (const size_t index : selectedIndices) {
+        selection.select(index);
+    }
+
+    setCurrentEntryIndex(currentIndex);
+}
+
+std::optional<size_t> App::findEntry(const fs::path& path) const {
+    std::error_code error;
+    const fs::directory_entry target(path.lexically_normal(), error);
+
+    return FileManager::findSortedIndex(target, getTab().entries, getSortType(), shouldShowHiddenEntries(),
+                                        shouldReverseEntries());
+}
+
+std::optional<size_t> App::insertEntry(const fs::path& path) {
+    const fs::path entryPath = path.lexically_normal();
+    if (entryPath.parent_path() != getCurrentPath()) {
+        return std::nullopt;
+    }
+
+    std::error_code error;
+    const fs::directory_entry entry(entryPath, error);
+    if (error or not FileManager::isListed(entry, getSearchQuery(), shouldShowHiddenEntries())) {
+        return std::nullopt;
+    }
+
+    // an entry that was replaced is listed again at the position of its new contents
+    if (const auto index = findEntry(entryPath)) {
+        eraseEntry(*index);
+    }
+
+    std::vector<fs::directory_entry>& entries = getEntries();
+    size_t index;
+    try {
+        index = FileManager::getInsertionIndex(entry, entries, getSortType(), shouldShowHiddenEntries(),
+                                               shouldReverseEntries());
+    } catch (const fs::filesystem_error&) {
+        // an entry was removed since the listing was read, read it again
+        updateEntries(false);
+        return findEntry(entryPath);
+    }
+
+    entries.insert(entries.begin() + static_cast<std::ptrdiff_t>(index), entry);
+    getSelection().insert(index);
+
+    // keep the cursor on the same entry
+    if (index <= getTab().entryIndex and entries.size() > 1) {
+        ++getTab().entryIndex;
+    }
+
+    return index;
+}
+
+void App::eraseEntry(const size_t index) {
+    std::vector<fs::directory_entry>& entries = getEntries();
+    size_t& entryIndex = getTab().entryIndex;
+
+    if (index >= entries.size()) {
+        return;
+    }
+
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(index));
+    getSelection().erase(index);
+
+    // keep the cursor on the same entry, or the one after it if it was removed
+    if (index < entryIndex) {
+        --entryIndex;
+    }
+    entryIndex = std::min(entryIndex, entries.empty() ? 0 : entries.size() - 1);
+}
+
 std::vector<fs::directory_entry>& App::getEntries() {
-    return entries;
+    return getTab().entries;
 }
 
 void App::setShowHiddenEntries(const bool showHiddenFiles) {
-    this->showHiddenEntries = showHiddenFiles;
+    getTab().showHiddenEntries = showHiddenFiles;
 }
 
 [[nodiscard]] bool App::shouldShowHiddenEntries() const {
-    return showHiddenEntries;
+    return getTab().showHiddenEntries;
 }
 
 void App::setReverseEntries(const bool reverseEntries) {
-    this->reverseEntries = reverseEntries;
+    getTab().reverseEntries = reverseEntries;
     sortEntries();
 }
 
 [[nodiscard]] bool App::shouldReverseEntries() const {
-    return reverseEntries;
+    return getTab().reverseEntries;
 }
 
 void App::setSortType(const SortType sortType) {
-    this->sortType = sortType;
+    getTab().sortType = sortType;
     sortEntries();
 }
 
 [[nodiscard]] SortType App::getSortType() const {
-    return sortType;
+    return getTab().sortType;
 }
 
 void App::setSearchQuery(std::string searchQuery) {
-    this->searchQuery = std::move(searchQuery);
-    updateEntries(false);
+    getTab().searchQuery = std::move(searchQuery);
+    readEntries();
 
     // set the index to first result if there are more than one result
     // else set it to zero ( the `..` entry)
-    setCurrentEntryIndex(entries.size() > 1 ? 1 : 0);
+    setCurrentEntryIndex(getEntries().size() > 1 ? 1 : 0);
 }
 
 bool App::resetSearchQuery() {
-    if (not searchQuery.empty()) {
+    if (std::string& searchQuery = getTab().searchQuery; not searchQuery.empty()) {
         searchQuery.clear();
         return true;
     }
@@ -147,7 +432,25 @@ bool App::resetSearchQuery() {
 }
 
 const std::string& App::getSearchQuery() const {
-    return searchQuery;
+    return getTab().searchQuery;
+}
+
+void App::setClipboard(std::vector<fs::path> paths, const bool cut) {
+    clipboard = std::move(paths);
+    clipboardCut = cut;
+}
+
+const std::vector<fs::path>& App::getClipboard() const {
+    return clipboard;
+}
+
+bool App::isClipboardCut() const {
+    return clipboardCut;
+}
+
+void App::clearClipboard() {
+    clipboard.clear();
+    clipboardCut = false;
 }
 
 void App::setCustomFooter(std::function<void()> customFooter, const bool updateUI_) {
@@ -177,38 +480,47 @@ const std::function<void()>& App::getCustomFooter() const {
 }
 
 void App::changeDirectory(const fs::path& path) {
-    const fs::path currentPath = fs::current_path();
+    const fs::path currentPath = getCurrentPath();
+    // `path` may be the path of one of the entries, which are read again below
+    const bool isGoingBack = FileProperties::Utilities::isDotDot(path);
 
     // return if trying to go back from root directory
-    if (FileProperties::Utilities::isDotDot(path) and currentPath == fs::path("/")) {
+    if (isGoingBack and currentPath == fs::path("/")) {
         return;
     }
 
     // the current path is the previous parent if we go back
     const fs::path& previousParent = currentPath;
 
-    // cache the index of the selected entry in the current path
-    entriesIndices[currentPath] = getCurrentEntryIndex();
-
-    try {
-        fs::current_path(path); // change directory to the given path
-        resetSearchQuery();     // reset search query after changing directory
-        updateEntries(false);   // get the new entries
-
-        if (FileProperties::Utilities::isDotDot(path) and currentPath.has_parent_path()) {
-            // when going back highlight the parent of the current directory
-
-            // search for the previous parent's index in the current directory
-            // and set the current entry's index to its index
-            setCurrentEntryIndex(FileManager::getIndex(previousParent, entries));
-        } else {
-            // if entry visited before get it's stored index
-            setCurrentEntryIndex(getCachedIndex(path));
-        }
-    } catch (const fs::filesystem_error&) {
+    // the tab's path is resolved like the working directory was, symlinks included,
+    // and only has to be a directory that can be entered
+    std::error_code error;
+    const fs::path newPath = fs::canonical(getAbsolutePath(path), error);
+    if (error or not fs::is_directory(newPath, error) or access(newPath.c_str(), X_OK) != 0) {
         setCustomFooter([] {
             Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Cannot change directory: Permission denied");
         }, true);
+        return;
+    }
+
+    // cache the index of the selected entry in the current path
+    getTab().entriesIndices[currentPath] = getCurrentEntryIndex();
+
+    getTab().path = newPath;
+    JumpDatabase::getInstance().addVisit(newPath);
+    getSelection().clear(); // marks only apply to the directory they were made in
+    resetSearchQuery();     // reset search query after changing directory
+    readEntries();          // get the new entries, shared with the tabs showing the same directory
+
+    if (isGoingBack and currentPath.has_parent_path()) {
+        // when going back highlight the parent of the current directory
+
+        // search for the previous parent's index in the current directory
+        // and set the current entry's index to its index
+        setCurrentEntryIndex(findEntry(previousParent).value_or(0));
+    } else {
+        // if entry visited before get it's stored index
+        setCurrentEntryIndex(getCachedIndex(newPath));
     }
 }
 
@@ -227,6 +539,16 @@ void App::setUiUpdateCallBack(std::function<void()> function) {
     uiUpdateCallBack = std::move(function);
 }
 
+void App::handlePendingResize() const {
+    if (pendingResizeCallBack != nullptr) {
+        pendingResizeCallBack();
+    }
+}
+
+void App::setPendingResizeCallBack(std::function<void()> function) {
+    pendingResizeCallBack = std::move(function);
+}
+
 void App::setShowPreview(const bool showPreview) {
     this->showPreview = showPreview;
     updateUI();
@@ -236,6 +558,23 @@ bool App::shouldShowPreview() const {
     return showPreview;
 }
 
+void App::setShowColumns(const bool showColumns) {
+    this->showColumns = showColumns;
+    updateUI();
+}
+
+bool App::shouldShowColumns() const {
+    return showColumns;
+}
+
+void App::setUseTrash(const bool useTrash) {
+    this->useTrash = useTrash;
+}
+
+bool App::shouldUseTrash() const {
+    return useTrash;
+}
+
 void App::setStartingEntry(const fs::path& path) {
     try {
         changeDirectory(path);
@@ -3,28 +3,61 @@
 #include <atomic>
 #include <filesystem>
 #include <functional>
+#include <optional>
 #include <unordered_map>
 #include "FileManager.hpp"
+#include "Prefetcher.hpp"
+#include "Selection.hpp"
 
 namespace fs = std::filesystem;
 
-class App {
+// a place being browsed, every tab keeps its own directory, cursor, sort and filter
+// the directories they show are read through the shared `ListingCache`
+struct Tab {
+    fs::path path; // absolute, the working directory of the process doesn't follow the tabs
     std::vector<fs::directory_entry> entries;
-    std::atomic_bool isRunning_;
 
-    size_t entryIndex;
+    size_t entryIndex{};
     std::unordered_map<fs::path, size_t> entriesIndices;
 
-    bool reverseEntries;
-    bool showHiddenEntries;
-    bool showPreview;
-    SortType sortType;
+    // entries marked for bulk operations, kept in sync with `entries`
+    Selection selection;
+
+    bool reverseEntries{};
+    bool showHiddenEntries{};
+    SortType sortType{SortType::Normal};
 
     std::string searchQuery;
+};
+
+class App {
+    std::atomic_bool isRunning_;
+
+    std::vector<Tab> tabs;
+    size_t tabIndex;
+
+    Tab& getTab();
+    [[nodiscard]] const Tab& getTab() const;
+
+    // marks the entries at the given paths in the current listing
+    void restoreSelection(const std::vector<fs::path>& selectedPaths);
+    // lists the current tab's directory, from the shared listing if it didn't change
+    void readEntries();
+
+    bool showPreview;
+    // the parent directory is shown in a column left of the current one
+    bool showColumns;
+    // deleted entries are moved to the trash instead of being deleted permanently
+    bool useTrash;
+
+    // entries yanked or cut to be pasted in another directory
+    std::vector<fs::path> clipboard;
+    bool clipboardCut;
 
     std::function<void()> customFooter;
     std::function<void()> uiUpdateCallBack;
     std::function<void()> initializeTerminalCallBack;
+    std::function<void()> pendingResizeCallBack;
 
     App();
 
@@ -35,8 +68,28 @@ public:
     [[nodiscard]] bool isRunning() const;
     void quit();
 
+    // the directory shown in the current tab
+    [[nodiscard]] const fs::path& getCurrentPath() const;
+    // resolves a path relative to the current tab's directory, e.g. typed by the user
+    [[nodiscard]] fs::path getAbsolutePath(const fs::path& path) const;
+
+    // opens a tab on the same directory as the current one, with the same options, and switches to it
+    void openTab();
+    // closes the current tab, the last one isn't closed
+    void closeTab();
+    // switches to a tab, reading its directory again if it changed since it was last shown
+    void setTabIndex(size_t index);
+    [[nodiscard]] size_t getTabIndex() const;
+    [[nodiscard]] size_t getTabCount() const;
+
     [[nodiscard]] size_t getCachedIndex(const fs::path& entry) const;
-    [[nodiscard]] std::vector<fs::directory_entry> getCurrentEntryChildren();
+    // options directory previews are listed with, reading at most `maxRead` children
+    [[nodiscard]] ListingOptions getListingOptions(size_t maxRead) const;
+    // lists the first `maxEntries` children of the current entry, reading at most `maxRead` of them
+    [[nodiscard]] DirectoryPage getCurrentEntryChildren(size_t maxEntries, size_t maxRead);
+    // returns at most `rows` entries of the current directory's parent around the current directory,
+    // and the index of the current directory in them; nothing at the root or if the parent can't be read
+    [[nodiscard]] std::pair<std::vector<fs::directory_entry>, size_t> getParentEntries(size_t rows) const;
     [[nodiscard]] size_t getCurrentEntryIndex() const;
 
     void setCurrentEntryIndex(size_t index);
@@ -46,7 +99,23 @@ public:
     fs::directory_entry& getCurrentEntry();
     std::vector<fs::directory_entry>& getEntries();
 
+    Selection& getSelection();
+    // paths of the marked entries in listing order
+    [[nodiscard]] std::vector<fs::path> getSelectedPaths() const;
+    // removes the entries at the given paths from the listing without reading the directory again
+    void removeEntries(const std::vector<fs::path>& paths);
+
+    // returns the index of a path in the listing, found with a binary search
+    [[nodiscard]] std::optional<size_t> findEntry(const fs::path& path) const;
+    // adds the entry at `path` at its sorted position without reading the directory again, the position is found
+    // with a binary search and the entries after it are shifted.
+    // returns its index, or nothing if it isn't listed in the current directory with the current options
+    std::optional<size_t> insertEntry(const fs::path& path);
+    // removes the entry at `index` from the listing, keeping the cursor and the marks on the other entries
+    void eraseEntry(size_t index);
+
     void changeDirectory(const fs::path& path);
+    // reads the current directory again, the listing shared with the other tabs is dropped first
     void updateEntries(bool updateIndex);
     void setEntries(std::vector<fs::directory_entry>& entries, const fs::path& path) const;
     void sortEntries();
@@ -64,6 +133,11 @@ public:
     bool resetSearchQuery();
     const std::string& getSearchQuery() const;
 
+    void setClipboard(std::vector<fs::path> paths, bool cut);
+    [[nodiscard]] const std::vector<fs::path>& getClipboard() const;
+    [[nodiscard]] bool isClipboardCut() const;
+    void clearClipboard();
+
     void setCustomFooter(std::function<void()> customFooter, bool updateUI_);
     const std::function<void()>& getCustomFooter() const;
     void resetFooter(bool updateUI_ = true);
@@ -74,8 +148,18 @@ public:
     void updateUI() const;
     void setUiUpdateCallBack(std::function<void()> function);
 
+    // lays out the UI again if the terminal was resized since the last call, only called from the input thread
+    void handlePendingResize() const;
+    void setPendingResizeCallBack(std::function<void()> function);
+
     void setShowPreview(bool showPreview);
     [[nodiscard]] bool shouldShowPreview() const;
 
+    void setShowColumns(bool showColumns);
+    [[nodiscard]] bool shouldShowColumns() const;
+
+    void setUseTrash(bool useTrash);
+    [[nodiscard]] bool shouldUseTrash() const;
+
     void setStartingEntry(const fs::path& path);
 };
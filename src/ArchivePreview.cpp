@@ -0,0 +1,635 @@
+#include "ArchivePreview.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef BFILEX_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    constexpr size_t tarBlockSize = 512;
+    // maximum size of a long name or pax header read from a tar archive
+    constexpr uint64_t maxTarMetadataSize = 64 * 1024;
+    // number of bytes of the central directory of a zip archive read at a time
+    constexpr size_t zipChunkSize = 256 * 1024;
+
+    uint16_t readLE16(const unsigned char* data) {
+        return static_cast<uint16_t>(data[0] | data[1] << 8);
+    }
+
+    uint32_t readLE32(const unsigned char* data) {
+        return static_cast<uint32_t>(readLE16(data)) | static_cast<uint32_t>(readLE16(data + 2)) << 16;
+    }
+
+    uint64_t readLE64(const unsigned char* data) {
+        return static_cast<uint64_t>(readLE32(data)) | static_cast<uint64_t>(readLE32(data + 4)) << 32;
+    }
+
+    // reads until `size` bytes are read or the end of the file, returns the number of bytes read
+    size_t readAt(const int fd, void* buffer, const size_t size, const uint64_t offset) {
+        size_t total{};
+        while (total < size) {
+            const ssize_t bytesRead = pread(fd, static_cast<char*>(buffer) + total, size - total,
+                                            static_cast<off_t>(offset + total));
+            if (bytesRead <= 0) {
+                break;
+            }
+            total += bytesRead;
+        }
+        return total;
+    }
+
+    // reads a rar variable length integer, 7 bits per byte with the high bit set on all but the last byte
+    bool readVarInt(const unsigned char*& data, const unsigned char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; data < end and shift < 64; shift += 7) {
+            const unsigned char byte = *data++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // parses an octal or base-256 encoded tar number field
+    uint64_t parseTarNumber(const unsigned char* field, const size_t length) {
+        // base-256 encoding is used for values that don't fit in octal
+        if (field[0] & 0x80) {
+            uint64_t value = field[0] & 0x3F;
+            for (size_t i = 1; i < length; ++i) {
+                value = value << 8 | field[i];
+            }
+            return value;
+        }
+
+        uint64_t value{};
+        size_t i{};
+        while (i < length and field[i] == ' ') {
+            ++i;
+        }
+        for (; i < length and field[i] >= '0' and field[i] <= '7'; ++i) {
+            value = value << 3 | (field[i] - '0');
+        }
+        return value;
+    }
+
+    // returns the string stored in a fixed size, possibly not terminated, field
+    std::string parseTarString(const unsigned char* field, const size_t length) {
+        const auto* end = static_cast<const unsigned char*>(std::memchr(field, '\0', length));
+        return {reinterpret_cast<const char*>(field), end != nullptr ? static_cast<size_t>(end - field) : length};
+    }
+
+    // checks the header checksum, which is computed with the checksum field itself taken as spaces
+    bool isTarHeader(const unsigned char* block) {
+        uint64_t sum{};
+        for (size_t i = 0; i < tarBlockSize; ++i) {
+            sum += i >= 148 and i < 156 ? ' ' : block[i];
+        }
+        return sum == parseTarNumber(block + 148, 8) and sum != 8 * ' ';
+    }
+
+    uint64_t roundUpToBlock(const uint64_t size) {
+        return (size + tarBlockSize - 1) / tarBlockSize * tarBlockSize;
+    }
+
+    // tar members read with pread, seeking over their contents
+    struct FileSource {
+        int fd;
+        uint64_t offset{};
+
+        bool read(unsigned char* buffer, const size_t size) {
+            const size_t bytesRead = readAt(fd, buffer, size, offset);
+            offset += bytesRead;
+            return bytesRead == size;
+        }
+
+        bool skip(const uint64_t size) {
+            offset += size;
+            return true;
+        }
+    };
+
+#ifdef BFILEX_HAS_ZLIB
+    // tar members decompressed on the fly, skipping contents still decompresses them but doesn't keep them
+    struct GzipSource {
+        gzFile file;
+
+        bool read(unsigned char* buffer, const size_t size) {
+            return gzread(file, buffer, static_cast<unsigned>(size)) == static_cast<int>(size);
+        }
+
+        bool skip(const uint64_t size) {
+            if (static_cast<uint64_t>(gztell(file)) + size > ArchivePreview::maxDecompressedBytes) {
+                return false;
+            }
+            return gzseek(file, static_cast<z_off_t>(size), SEEK_CUR) >= 0;
+        }
+    };
+#endif
+
+    // reads the member headers of a tar stream, stopping after `maxMembers` members
+    template<typename Source>
+    void readTarMembers(Source& source, const size_t maxMembers, ArchiveListing& listing) {
+        unsigned char block[tarBlockSize];
+
+        // names and sizes set by GNU long name and pax headers for the next member
+        std::string nextName;
+        uint64_t nextSize{};
+        bool hasNextSize{};
+
+        while (true) {
+            if (not source.read(block, tarBlockSize)) {
+                return;
+            }
+
+            // the archive ends with zero blocks
+            if (std::all_of(block, block + tarBlockSize, [](const unsigned char c) { return c == 0; })) {
+                return;
+            }
+
+            if (not isTarHeader(block)) {
+                listing.error = "Corrupted tar header";
+                return;
+            }
+
+            const uint64_t size = parseTarNumber(block + 124, 12);
+            const char type = static_cast<char>(block[156]);
+
+            // metadata for the next member is stored in the contents of these headers
+            if (type == 'L' or type == 'x') {
+                const uint64_t readSize = std::min(size, maxTarMetadataSize);
+                std::string data(roundUpToBlock(readSize), '\0');
+
+                if (not source.read(reinterpret_cast<unsigned char*>(data.data()), data.size()) or
+                    not source.skip(roundUpToBlock(size) - data.size())) {
+                    return;
+                }
+                data.resize(readSize);
+
+                if (type == 'L') {
+                    nextName = data.substr(0, data.find('\0'));
+                    continue;
+                }
+
+                // pax records are formatted as "<length> <key>=<value>\n"
+                for (size_t position = 0; position < data.size();) {
+                    const size_t length = std::strtoull(data.c_str() + position, nullptr, 10);
+                    if (length == 0) {
+                        break;
+                    }
+
+                    const std::string record = data.substr(position, length);
+                    const size_t space = record.find(' ');
+                    const size_t equals = record.find('=');
+
+                    if (space != std::string::npos and equals != std::string::npos and equals > space) {
+                        const std::string key = record.substr(space + 1, equals - space - 1);
+                        std::string value = record.substr(equals + 1);
+                        if (not value.empty() and value.back() == '\n') {
+                            value.pop_back();
+                        }
+
+                        if (key == "path") {
+                            nextName = value;
+                        } else if (key == "size") {
+                            nextSize = std::strtoull(value.c_str(), nullptr, 10);
+                            hasNextSize = true;
+                        }
+                    }
+                    position += length;
+                }
+                continue;
+            }
+
+            const uint64_t memberSize = hasNextSize ? nextSize : size;
+
+            // global pax headers and long link names don't describe a member
+            if (type != 'g' and type != 'K') {
+                ArchiveMember member;
+
+                if (not nextName.empty()) {
+                    member.name = std::move(nextName);
+                } else {
+                    member.name = parseTarString(block, 100);
+
+                    // ustar archives store the start of long paths in a separate prefix field
+                    if (std::memcmp(block + 257, "ustar", 5) == 0 and block[345] != '\0') {
+                        member.name = parseTarString(block + 345, 155) + "/" + member.name;
+                    }
+                }
+
+                member.isDirectory = type == '5' or (not member.name.empty() and member.name.back() == '/');
+                member.size = member.isDirectory ? 0 : memberSize;
+
+                if (listing.members.size() == maxMembers) {
+                    listing.hasMore = true;
+                    return;
+                }
+                listing.members.push_back(std::move(member));
+            }
+
+            nextName.clear();
+            hasNextSize = false;
+
+            // seek over the member's contents to the next header
+            if (not source.skip(roundUpToBlock(memberSize))) {
+                listing.hasMore = true;
+                return;
+            }
+        }
+    }
+}
+
+void ArchivePreview::listZip(const int fd, const uint64_t fileSize, const size_t maxMembers,
+                             ArchiveListing& listing) {
+    listing.format = "zip";
+
+    // the end of central directory record is 22 bytes followed by a comment of up to 64 KB
+    constexpr size_t endRecordSize = 22;
+    const size_t tailSize = std::min<uint64_t>(fileSize, endRecordSize + 0xFFFF);
+
+    std::vector<unsigned char> tail(tailSize);
+    if (tailSize < endRecordSize or readAt(fd, tail.data(), tailSize, fileSize - tailSize) != tailSize) {
+        listing.error = "Invalid zip archive";
+        return;
+    }
+
+    // search backward for the end of central directory signature
+    size_t recordIndex = tailSize - endRecordSize + 1;
+    do {
+        --recordIndex;
+    } while (recordIndex > 0 and readLE32(tail.data() + recordIndex) != 0x06054b50);
+
+    if (readLE32(tail.data() + recordIndex) != 0x06054b50) {
+        listing.error = "Invalid zip archive";
+        return;
+    }
+
+    const unsigned char* record = tail.data() + recordIndex;
+    uint64_t memberCount = readLE16(record + 10);
+    uint64_t directorySize = readLE32(record + 12);
+    uint64_t directoryOffset = readLE32(record + 16);
+
+    // zip64 archives store the real values in a separate record, found through a locator right before
+    if ((memberCount == 0xFFFF or directorySize == 0xFFFFFFFF or directoryOffset == 0xFFFFFFFF) and
+        recordIndex >= 20 and readLE32(record - 20) == 0x07064b50) {
+        unsigned char zip64Record[56];
+
+        if (readAt(fd, zip64Record, sizeof(zip64Record), readLE64(record - 20 + 8)) == sizeof(zip64Record) and
+            readLE32(zip64Record) == 0x06064b50) {
+            memberCount = readLE64(zip64Record + 32);
+            directorySize = readLE64(zip64Record + 40);
+            directoryOffset = readLE64(zip64Record + 48);
+        }
+    }
+
+    listing.memberCount = memberCount;
+
+    // read the central directory a chunk at a time until enough members are found
+    const uint64_t directoryEnd = std::min(directoryOffset + directorySize, fileSize);
+    std::vector<unsigned char> chunk;
+    uint64_t position = directoryOffset;
+
+    while (listing.members.size() < maxMembers and position < directoryEnd) {
+        chunk.resize(std::min<uint64_t>(zipChunkSize, directoryEnd - position));
+        chunk.resize(readAt(fd, chunk.data(), chunk.size(), position));
+
+        size_t index{};
+        while (listing.members.size() < maxMembers) {
+            constexpr size_t headerSize = 46;
+            if (index + headerSize > chunk.size()) {
+                break;
+            }
+
+            const unsigned char* header = chunk.data() + index;
+            if (readLE32(header) != 0x02014b50) {
+                listing.error = "Corrupted zip central directory";
+                return;
+            }
+
+            const size_t nameLength = readLE16(header + 28);
+            const size_t extraLength = readLE16(header + 30);
+            const size_t commentLength = readLE16(header + 32);
+            const size_t entrySize = headerSize + nameLength + extraLength + commentLength;
+
+            // the entry continues in the next chunk
+            if (index + entrySize > chunk.size()) {
+                break;
+            }
+
+            ArchiveMember member;
+            member.name.assign(reinterpret_cast<const char*>(header + headerSize), nameLength);
+            member.isDirectory = not member.name.empty() and member.name.back() == '/';
+            member.size = readLE32(header + 24);
+
+            // zip64 sizes are stored in an extra field
+            if (member.size == 0xFFFFFFFF) {
+                const unsigned char* extra = header + headerSize + nameLength;
+                for (size_t i = 0; i + 4 <= extraLength;) {
+                    const uint16_t id = readLE16(extra + i);
+                    const uint16_t length = readLE16(extra + i + 2);
+                    if (id == 0x0001 and length >= 8 and i + 4 + 8 <= extraLength) {
+                        member.size = readLE64(extra + i + 4);
+                        break;
+                    }
+                    i += 4 + length;
+                }
+            }
+
+            listing.members.push_back(std::move(member));
+            index += entrySize;
+        }
+
+        // no progress means the entry is larger than the chunk or the directory is truncated
+        if (index == 0) {
+            break;
+        }
+        position += index;
+    }
+
+    listing.hasMore = listing.members.size() < memberCount;
+}
+
+void ArchivePreview::listTar(const int fd, const size_t maxMembers, ArchiveListing& listing) {
+    listing.format = "tar";
+
+    FileSource source{fd};
+    readTarMembers(source, maxMembers, listing);
+}
+
+void ArchivePreview::listGzip(const std::string& path, const int fd, const uint64_t fileSize,
+                              [[maybe_unused]] const size_t maxMembers, ArchiveListing& listing) {
+#ifdef BFILEX_HAS_ZLIB
+    if (gzFile file = gzopen(path.c_str(), "rb"); file != nullptr) {
+        gzbuffer(file, 128 * 1024);
+
+        // check whether the decompressed content starts with a tar header
+        unsigned char block[tarBlockSize];
+        const bool isTar = gzread(file, block, tarBlockSize) == tarBlockSize and isTarHeader(block);
+
+        if (isTar) {
+            listing.format = "tar.gz";
+
+            gzrewind(file);
+            GzipSource source{file};
+            readTarMembers(source, maxMembers, listing);
+        }
+
+        gzclose(file);
+
+        if (isTar) {
+            return;
+        }
+    }
+#else
+    // without zlib compressed tar archives can only be recognized by their name
+    if (path.size() >= 4 and (path.substr(path.size() - 4) == ".tgz" or
+                              (path.size() >= 7 and path.substr(path.size() - 7) == ".tar.gz"))) {
+        listing.format = "tar.gz";
+        listing.error = "Listing compressed tar archives requires zlib";
+        return;
+    }
+#endif
+
+    // a single compressed file, its name is in the header and its size in the trailer
+    listing.format = "gzip";
+
+    unsigned char header[10];
+    unsigned char trailer[4];
+    if (fileSize < sizeof(header) + sizeof(trailer) or
+        readAt(fd, header, sizeof(header), 0) != sizeof(header) or
+        readAt(fd, trailer, sizeof(trailer), fileSize - sizeof(trailer)) != sizeof(trailer)) {
+        listing.error = "Invalid gzip file";
+        return;
+    }
+
+    ArchiveMember member;
+    const unsigned char flags = header[3];
+    uint64_t offset = sizeof(header);
+
+    // skip the extra field
+    if (flags & 0x04) {
+        unsigned char extraLength[2];
+        readAt(fd, extraLength, sizeof(extraLength), offset);
+        offset += sizeof(extraLength) + readLE16(extraLength);
+    }
+
+    // the original file name is stored as a null terminated string
+    if (flags & 0x08) {
+        char name[256];
+        const size_t bytesRead = readAt(fd, name, sizeof(name), offset);
+        member.name.assign(name, strnlen(name, bytesRead));
+    }
+
+    if (member.name.empty()) {
+        const size_t slash = path.find_last_of('/');
+        member.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+        if (member.name.size() > 3 and member.name.substr(member.name.size() - 3) == ".gz") {
+            member.name.resize(member.name.size() - 3);
+        }
+    }
+
+    // the trailer only stores the size modulo 4 GB
+    member.size = readLE32(trailer);
+    listing.members.push_back(std::move(member));
+    listing.memberCount = 1;
+}
+
+void ArchivePreview::listRar(const int fd, const uint64_t fileSize, const size_t maxMembers,
+                             ArchiveListing& listing) {
+    unsigned char signature[8];
+    readAt(fd, signature, sizeof(signature), 0);
+
+    // maximum size of a header read from the archive
+    constexpr size_t maxHeaderSize = 64 * 1024;
+    std::vector<unsigned char> header;
+
+    if (signature[6] == 0x01 and signature[7] == 0x00) {
+        listing.format = "rar5";
+
+        // every header starts with a crc32 followed by the header size as a variable length integer
+        for (uint64_t offset = sizeof(signature); offset < fileSize;) {
+            unsigned char prefix[4 + 10];
+            const size_t prefixSize = readAt(fd, prefix, sizeof(prefix), offset);
+
+            const unsigned char* data = prefix + 4;
+            uint64_t headerSize;
+            if (prefixSize <= 4 or not readVarInt(data, prefix + prefixSize, headerSize) or
+                headerSize > maxHeaderSize) {
+                break;
+            }
+
+            const uint64_t headerStart = offset + (data - prefix);
+            header.resize(headerSize);
+            if (readAt(fd, header.data(), headerSize, headerStart) != headerSize) {
+                break;
+            }
+
+            const unsigned char* position = header.data();
+            const unsigned char* end = header.data() + header.size();
+            uint64_t type{}, flags{}, extraSize{}, dataSize{};
+
+            readVarInt(position, end, type);
+            readVarInt(position, end, flags);
+            if (flags & 0x01) {
+                readVarInt(position, end, extraSize);
+            }
+            if (flags & 0x02) {
+                readVarInt(position, end, dataSize);
+            }
+
+            // archive encryption header, the rest of the headers are encrypted
+            if (type == 4) {
+                listing.error = "Encrypted rar archive";
+                return;
+            }
+
+            // end of archive header
+            if (type == 5) {
+                return;
+            }
+
+            if (type == 2) {
+                uint64_t fileFlags{}, unpackedSize{}, attributes{}, compression{}, hostOs{}, nameLength{};
+                readVarInt(position, end, fileFlags);
+                readVarInt(position, end, unpackedSize);
+                readVarInt(position, end, attributes);
+
+                // optional modification time and crc32
+                position += (fileFlags & 0x02 ? 4 : 0) + (fileFlags & 0x04 ? 4 : 0);
+
+                readVarInt(position, end, compression);
+                readVarInt(position, end, hostOs);
+                readVarInt(position, end, nameLength);
+
+                if (position > end or nameLength > static_cast<uint64_t>(end - position)) {
+                    listing.error = "Corrupted rar header";
+                    return;
+                }
+
+                if (listing.members.size() == maxMembers) {
+                    listing.hasMore = true;
+                    return;
+                }
+
+                ArchiveMember member;
+                member.name.assign(reinterpret_cast<const char*>(position), nameLength);
+                member.isDirectory = fileFlags & 0x01;
+                member.size = member.isDirectory ? 0 : unpackedSize;
+                listing.members.push_back(std::move(member));
+            }
+
+            // seek over the member's packed data to the next header
+            offset = headerStart + headerSize + dataSize;
+        }
+        return;
+    }
+
+    listing.format = "rar";
+
+    // rar 4 headers start with a 7 byte base header: crc16, type, flags and size
+    for (uint64_t offset = 7; offset < fileSize;) {
+        unsigned char base[7 + 4];
+        const size_t baseSize = readAt(fd, base, sizeof(base), offset);
+        if (baseSize < 7) {
+            break;
+        }
+
+        const unsigned char type = base[2];
+        const uint16_t flags = readLE16(base + 3);
+        const uint16_t headerSize = readLE16(base + 5);
+
+        if (headerSize < 7) {
+            listing.error = "Corrupted rar header";
+            return;
+        }
+
+        // encrypted headers
+        if (type == 0x73 and (flags & 0x80)) {
+            listing.error = "Encrypted rar archive";
+            return;
+        }
+
+        // end of archive header
+        if (type == 0x7B) {
+            return;
+        }
+
+        uint64_t dataSize = (flags & 0x8000) and baseSize >= 11 ? readLE32(base + 7) : 0;
+
+        if (type == 0x74) {
+            header.resize(headerSize);
+            if (headerSize < 32 or readAt(fd, header.data(), headerSize, offset) != headerSize) {
+                break;
+            }
+
+            const bool hasLargeSizes = flags & 0x100;
+            const size_t nameOffset = hasLargeSizes ? 40 : 32;
+            const size_t nameLength = readLE16(header.data() + 26);
+
+            if (nameOffset + nameLength > headerSize) {
+                listing.error = "Corrupted rar header";
+                return;
+            }
+
+            dataSize = readLE32(header.data() + 7);
+            uint64_t unpackedSize = readLE32(header.data() + 11);
+            if (hasLargeSizes) {
+                dataSize |= static_cast<uint64_t>(readLE32(header.data() + 32)) << 32;
+                unpackedSize |= static_cast<uint64_t>(readLE32(header.data() + 36)) << 32;
+            }
+
+            if (listing.members.size() == maxMembers) {
+                listing.hasMore = true;
+                return;
+            }
+
+            // unicode names follow the ascii name after a null byte
+            const auto* name = reinterpret_cast<const char*>(header.data() + nameOffset);
+
+            ArchiveMember member;
+            member.name.assign(name, strnlen(name, nameLength));
+            member.isDirectory = (flags & 0xE0) == 0xE0;
+            member.size = member.isDirectory ? 0 : unpackedSize;
+            listing.members.push_back(std::move(member));
+        }
+
+        offset += headerSize + dataSize;
+    }
+}
+
+ArchiveListing ArchivePreview::list(const std::string& path, const size_t maxMembers) {
+    ArchiveListing listing;
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        listing.error = "Failed to open archive";
+        return listing;
+    }
+
+    struct stat status{};
+    const uint64_t fileSize = fstat(fd, &status) == 0 ? status.st_size : 0;
+
+    unsigned char magic[tarBlockSize]{};
+    const size_t magicSize = readAt(fd, magic, sizeof(magic), 0);
+
+    if (magicSize >= 4 and magic[0] == 'P' and magic[1] == 'K') {
+        listZip(fd, fileSize, maxMembers, listing);
+    } else if (magicSize >= 2 and magic[0] == 0x1F and magic[1] == 0x8B) {
+        listGzip(path, fd, fileSize, maxMembers, listing);
+    } else if (magicSize >= 8 and std::memcmp(magic, "Rar!\x1A\x07", 6) == 0) {
+        listRar(fd, fileSize, maxMembers, listing);
+    } else if (magicSize == tarBlockSize and isTarHeader(magic)) {
+        listTar(fd, maxMembers, listing);
+    } else {
+        listing.error = "Unsupported archive format";
+    }
+
+    close(fd);
+    return listing;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// a file or directory stored in an archive
+struct ArchiveMember {
+    std::string name;
+    uint64_t size{};
+    bool isDirectory{};
+};
+
+// the first members of an archive
+struct ArchiveListing {
+    std::string format;                  // archive format shown in the preview
+    std::vector<ArchiveMember> members;  // members in archive order, at most the requested amount
+    std::optional<uint64_t> memberCount; // total number of members when the format stores it
+    bool hasMore{};                      // true if the listing stopped before the end of the archive
+    std::string error;                   // reason the archive couldn't be listed, empty on success
+};
+
+// lists archive members without extracting them
+// zip archives only read their central directory from the end of the file, tar archives read the member
+// headers and seek over the member contents, so the cost depends on the number of members listed
+// rather than the size of the archive
+class ArchivePreview {
+    // reads the central directory of a zip archive
+    static void listZip(int fd, uint64_t fileSize, size_t maxMembers, ArchiveListing& listing);
+    // reads the member headers of an uncompressed tar archive
+    static void listTar(int fd, size_t maxMembers, ArchiveListing& listing);
+    // reads the member headers of a gzip compressed tar archive, decompressing on the fly
+    // or shows the name and size of the compressed file if it's not a tar archive
+    static void listGzip(const std::string& path, int fd, uint64_t fileSize, size_t maxMembers,
+                         ArchiveListing& listing);
+    // reads the file headers of a rar archive
+    static void listRar(int fd, uint64_t fileSize, size_t maxMembers, ArchiveListing& listing);
+
+public:
+    // maximum number of bytes decompressed to list a compressed tar archive
+    static constexpr uint64_t maxDecompressedBytes = 64 * 1024 * 1024;
+
+    // lists up to `maxMembers` members of the archive, detecting its format from its content
+    static ArchiveListing list(const std::string& path, size_t maxMembers);
+};
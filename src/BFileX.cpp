@@ -7,6 +7,8 @@
 #include "App.hpp"
 #include "CommandLineParser.hpp"
 #include "Terminal++.hpp"
+#include "Trace.hpp"
+#include "Trash.hpp"
 #include "UI.hpp"
 
 void BFileX::signalHandler(int) {
@@ -17,32 +19,41 @@ void BFileX::signalHandler(int) {
 }
 
 void BFileX::handleResize(int) {
-    static std::atomic_bool resizing{false};
-
-    if (not resizing.exchange(true)) {
-        auto [width, height] = Terminal::size();
-
-        terminalWidth = width;
-        terminalHeight = height;
+    resizePending.store(true);
+}
 
-        ui.resize(width, height);
-        app.updateUI();
+void BFileX::resize(const int width, const int height) {
+    terminalWidth = width;
+    terminalHeight = height;
 
-        resizing.store(false);
-    }
+    ui.resize(width, height);
+    app.updateUI();
 }
 
 void BFileX::renderUI() {
+    const Trace::Span span("renderUI");
+
     // check if a full UI re-render is needed:
     // - The current entry index was changed
     // - Terminal was resized
     // - Entries list was updated
+    // - Entries were marked or unmarked
+    // - A tab was opened, closed or switched to
+    // - The parent directory's column was shown or hidden
 
     if (previousIndex != app.getCurrentEntryIndex() or
         std::tie(previousWidth, previousHeight) != std::tie(terminalWidth, terminalHeight) or
-        previousEntries != app.getEntries()
+        previousEntries != app.getEntries() or
+        previousSelection != app.getSelection() or
+        previousTabIndex != app.getTabIndex() or
+        previousTabCount != app.getTabCount() or
+        previousColumnsOn != app.shouldShowColumns()
     ) { // full UI re-render
         fullRenderUI();
+    } else if (app.shouldShowPreview() and previousPreviewScrollOffset != ui.getPreviewScrollOffset()) {
+        // the preview was scrolled
+        ui.renderPreview(app.getCurrentEntry());
+        ui.renderFooter(app);
     } else if (previousPreviewOn != app.shouldShowPreview()) {
         // preview state changed
         if (app.shouldShowPreview()) {
@@ -62,40 +73,72 @@ void BFileX::renderUI() {
     // Update previous state for comparison in the next render cycle
     previousIndex = app.getCurrentEntryIndex();
     previousPreviewOn = app.shouldShowPreview();
+    previousPreviewScrollOffset = ui.getPreviewScrollOffset();
     previousEntries = app.getEntries();
+    previousSelection = app.getSelection();
+    previousTabIndex = app.getTabIndex();
+    previousTabCount = app.getTabCount();
+    previousColumnsOn = app.shouldShowColumns();
     previousWidth = terminalWidth;
     previousHeight = terminalHeight;
 }
 
 void BFileX::fullRenderUI() {
+    const Trace::Span span("fullRenderUI");
+
     Screen::clear();
-    ui.renderTopBar(fs::absolute(app.getCurrentEntry()));
+    // the entries' paths are absolute, except for an error shown in place of the listing
+    ui.renderTopBar(app.getCurrentPath() / app.getCurrentEntry().path(), app.getTabCount(), app.getTabIndex());
 
     // render preview if enabled
     if (app.shouldShowPreview()) {
         ui.renderPreview(app.getCurrentEntry());
     }
 
+    // render the parent directory in a column left of the entries, only the rows shown are copied
+    if (app.shouldShowColumns()) {
+        const auto [parentEntries, parentIndex] = app.getParentEntries(ui.getPageSize());
+        ui.renderParentEntries(parentEntries, parentIndex);
+    }
+
     // render entries and footer
-    ui.renderEntries(app.getEntries(), app.getCurrentEntryIndex(), 1, 2);
+    const auto [entriesX, entriesWidth] = ui.getEntriesColumn(app.shouldShowColumns());
+    ui.renderEntries(app.getEntries(), app.getCurrentEntryIndex(), entriesX, 2, &app.getSelection(), entriesWidth);
     ui.renderFooter(app);
 }
 
-void BFileX::run(const int argc, char** argv) {
+void BFileX::start(const int argc, char** argv) {
     // handling command line options
     CommandLineParser::parse(argc, argv);
 
-    // setup signal handling
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
-    signal(SIGWINCH, handleResize);
+    UI::initialize();
 
     app.setUiUpdateCallBack(renderUI);
     app.setInitalizeTerminalCallBack([] {
         UI::initialize();
         fullRenderUI();
     });
+    app.setPendingResizeCallBack([] {
+        if (resizePending.exchange(false)) {
+            auto [width, height] = Terminal::size();
+            resize(width, height);
+        }
+    });
     app.updateUI();
+}
+
+void BFileX::run(const int argc, char** argv) {
+    start(argc, argv);
+
+    // setup signal handling
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+    signal(SIGWINCH, handleResize);
+
+    // start purging the expired entries in the trash
+    if (app.shouldUseTrash()) {
+        Trash::getInstance();
+    }
 
     // handling user input
     InputHandler::handleInput();
@@ -106,7 +149,14 @@ App& BFileX::app = App::getInstance();
 
 size_t BFileX::previousIndex{};
 bool BFileX::previousPreviewOn{};
+uint64_t BFileX::previousPreviewScrollOffset{};
 std::vector<fs::directory_entry> BFileX::previousEntries{};
+Selection BFileX::previousSelection{};
+size_t BFileX::previousTabIndex{};
+size_t BFileX::previousTabCount{1};
+bool BFileX::previousColumnsOn{};
+
+std::atomic_bool BFileX::resizePending{false};
 
 int BFileX::terminalWidth{};
 int BFileX::terminalHeight{};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "App.hpp"
 #include "UI.hpp"
 
@@ -9,18 +11,31 @@ class BFileX {
 
     static size_t previousIndex;
     static bool previousPreviewOn;
+    static uint64_t previousPreviewScrollOffset;
     static std::vector<fs::directory_entry> previousEntries;
+    static Selection previousSelection;
+    static size_t previousTabIndex;
+    static size_t previousTabCount;
+    static bool previousColumnsOn;
 
     static int terminalWidth;
     static int terminalHeight;
     static int previousWidth;
     static int previousHeight;
 
+    // set by `SIGWINCH`, the UI is laid out again on the input thread, which owns the listings it renders
+    static std::atomic_bool resizePending;
+
     static void signalHandler(int);
     static void handleResize(int);
     static void renderUI();
     static void fullRenderUI();
 
 public:
+    // parses the arguments, sets up the terminal and renders the first frame, without reading any input
+    static void start(int argc, char** argv);
+    // lays out the UI for a terminal of the given size and renders it again
+    static void resize(int width, int height);
+    // starts the app and handles input until it's quit
     static void run(int argc, char** argv);
 };
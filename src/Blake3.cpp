@@ -0,0 +1,398 @@
+#include "Blake3.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#define BFILEX_BLAKE3_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr uint32_t iv[8] = {
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+    };
+
+    // the domain flags, plain integers since they're combined in conditionals with 0
+    constexpr uint32_t ChunkStart = 1 << 0;
+    constexpr uint32_t ChunkEnd = 1 << 1;
+    constexpr uint32_t Parent = 1 << 2;
+    constexpr uint32_t Root = 1 << 3;
+
+    constexpr size_t rounds = 7;
+
+    // the message words used by each round, every round permutes the ones of the previous round
+    struct MessageSchedule {
+        size_t words[rounds][16]{};
+
+        constexpr MessageSchedule() {
+            constexpr size_t permutation[16] = {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8};
+            for (size_t i = 0; i < 16; ++i) {
+                words[0][i] = i;
+            }
+            for (size_t round = 1; round < rounds; ++round) {
+                for (size_t i = 0; i < 16; ++i) {
+                    words[round][i] = words[round - 1][permutation[i]];
+                }
+            }
+        }
+    };
+
+    constexpr MessageSchedule schedule;
+
+    uint32_t rotateRight(const uint32_t value, const int bits) {
+        return value >> bits | value << (32 - bits);
+    }
+
+    void mix(uint32_t* state, const size_t a, const size_t b, const size_t c, const size_t d,
+             const uint32_t x, const uint32_t y) {
+        state[a] = state[a] + state[b] + x;
+        state[d] = rotateRight(state[d] ^ state[a], 16);
+        state[c] = state[c] + state[d];
+        state[b] = rotateRight(state[b] ^ state[c], 12);
+        state[a] = state[a] + state[b] + y;
+        state[d] = rotateRight(state[d] ^ state[a], 8);
+        state[c] = state[c] + state[d];
+        state[b] = rotateRight(state[b] ^ state[c], 7);
+    }
+
+    // compresses a block into a 16 word output, the first 8 words are the new chaining value
+    void compress(const uint32_t* chainingValue, const unsigned char* block, const uint32_t blockSize,
+                  const uint64_t counter, const uint32_t flags, uint32_t* output) {
+        uint32_t message[16];
+        std::memcpy(message, block, Blake3::blockLength); // little-endian words
+
+        uint32_t state[16] = {
+            chainingValue[0], chainingValue[1], chainingValue[2], chainingValue[3],
+            chainingValue[4], chainingValue[5], chainingValue[6], chainingValue[7],
+            iv[0], iv[1], iv[2], iv[3],
+            static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), blockSize, flags,
+        };
+
+        for (const auto& words : schedule.words) {
+            mix(state, 0, 4, 8, 12, message[words[0]], message[words[1]]);
+            mix(state, 1, 5, 9, 13, message[words[2]], message[words[3]]);
+            mix(state, 2, 6, 10, 14, message[words[4]], message[words[5]]);
+            mix(state, 3, 7, 11, 15, message[words[6]], message[words[7]]);
+            mix(state, 0, 5, 10, 15, message[words[8]], message[words[9]]);
+            mix(state, 1, 6, 11, 12, message[words[10]], message[words[11]]);
+            mix(state, 2, 7, 8, 13, message[words[12]], message[words[13]]);
+            mix(state, 3, 4, 9, 14, message[words[14]], message[words[15]]);
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            output[i] = state[i] ^ state[i + 8];
+            output[i + 8] = state[i + 8] ^ chainingValue[i];
+        }
+    }
+
+    // the last compression of a chunk or parent, done with the root flag for the final digest
+    struct Output {
+        uint32_t chainingValue[8];
+        unsigned char block[Blake3::blockLength];
+        uint32_t blockSize;
+        uint64_t counter;
+        uint32_t flags;
+
+        void getChainingValue(uint32_t* result) const {
+            uint32_t output[16];
+            compress(chainingValue, block, blockSize, counter, flags, output);
+            std::memcpy(result, output, 8 * sizeof(uint32_t));
+        }
+    };
+
+    Output getParentOutput(const uint32_t* left, const uint32_t* right) {
+        Output output{};
+        std::copy(iv, iv + 8, output.chainingValue);
+        std::memcpy(output.block, left, 8 * sizeof(uint32_t));
+        std::memcpy(output.block + 8 * sizeof(uint32_t), right, 8 * sizeof(uint32_t));
+        output.blockSize = Blake3::blockLength;
+        output.flags = Parent;
+        return output;
+    }
+
+    // hashes whole chunks one at a time
+    void hashChunks(const unsigned char* input, const size_t chunks, const uint64_t counter, uint32_t (*results)[8]) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk, input += Blake3::chunkLength) {
+            uint32_t chainingValue[8];
+            std::copy(iv, iv + 8, chainingValue);
+
+            constexpr size_t blocks = Blake3::chunkLength / Blake3::blockLength;
+            for (size_t block = 0; block < blocks; ++block) {
+                const uint32_t flags = (block == 0 ? ChunkStart : 0) | (block == blocks - 1 ? ChunkEnd : 0);
+
+                uint32_t output[16];
+                compress(chainingValue, input + block * Blake3::blockLength, Blake3::blockLength,
+                         counter + chunk, flags, output);
+                std::memcpy(chainingValue, output, sizeof(chainingValue));
+            }
+
+            std::memcpy(results[chunk], chainingValue, sizeof(chainingValue));
+        }
+    }
+
+#ifdef BFILEX_BLAKE3_AVX2
+    // rotations by whole bytes are a single shuffle
+    template <int bits>
+    __attribute__((target("avx2"), always_inline)) inline __m256i rotateRightAvx2(const __m256i value) {
+        if constexpr (bits == 16) {
+            return _mm256_shuffle_epi8(value, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                                              13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+        } else if constexpr (bits == 8) {
+            return _mm256_shuffle_epi8(value, _mm256_set_epi8(12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1,
+                                                              12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1));
+        } else {
+            return _mm256_or_si256(_mm256_srli_epi32(value, bits), _mm256_slli_epi32(value, 32 - bits));
+        }
+    }
+
+    __attribute__((target("avx2"), always_inline))
+    inline void mixAvx2(__m256i& a, __m256i& b, __m256i& c, __m256i& d, const __m256i x, const __m256i y) {
+        a = _mm256_add_epi32(_mm256_add_epi32(a, b), x);
+        d = rotateRightAvx2<16>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi32(c, d);
+        b = rotateRightAvx2<12>(_mm256_xor_si256(b, c));
+        a = _mm256_add_epi32(_mm256_add_epi32(a, b), y);
+        d = rotateRightAvx2<8>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi32(c, d);
+        b = rotateRightAvx2<7>(_mm256_xor_si256(b, c));
+    }
+
+    // one round with the message words of `round` known at compile time
+    template <size_t round>
+    __attribute__((target("avx2"), always_inline)) inline void roundAvx2(__m256i* state, const __m256i* message) {
+        constexpr const size_t* words = schedule.words[round];
+        mixAvx2(state[0], state[4], state[8], state[12], message[words[0]], message[words[1]]);
+        mixAvx2(state[1], state[5], state[9], state[13], message[words[2]], message[words[3]]);
+        mixAvx2(state[2], state[6], state[10], state[14], message[words[4]], message[words[5]]);
+        mixAvx2(state[3], state[7], state[11], state[15], message[words[6]], message[words[7]]);
+        mixAvx2(state[0], state[5], state[10], state[15], message[words[8]], message[words[9]]);
+        mixAvx2(state[1], state[6], state[11], state[12], message[words[10]], message[words[11]]);
+        mixAvx2(state[2], state[7], state[8], state[13], message[words[12]], message[words[13]]);
+        mixAvx2(state[3], state[4], state[9], state[14], message[words[14]], message[words[15]]);
+    }
+
+    // turns 8 rows of 8 words into 8 columns
+    __attribute__((target("avx2"), always_inline)) inline void transpose(__m256i* rows) {
+        const __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+        const __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+        const __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+        const __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+        const __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+        const __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+        const __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+        const __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+        const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+        const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+        const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+        const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+        const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+        const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+        const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+        const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+        rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+    // hashes 8 chunks at once, each lane of a vector holds the same word of another chunk
+    __attribute__((target("avx2")))
+    void hashEightChunksAvx2(const unsigned char* input, const uint64_t counter, uint32_t (*results)[8]) {
+        __m256i chainingValue[8];
+        for (size_t i = 0; i < 8; ++i) {
+            chainingValue[i] = _mm256_set1_epi32(static_cast<int>(iv[i]));
+        }
+
+        uint32_t counterLow[8];
+        uint32_t counterHigh[8];
+        for (size_t lane = 0; lane < 8; ++lane) {
+            counterLow[lane] = static_cast<uint32_t>(counter + lane);
+            counterHigh[lane] = static_cast<uint32_t>((counter + lane) >> 32);
+        }
+
+        constexpr size_t blocks = Blake3::chunkLength / Blake3::blockLength;
+        for (size_t block = 0; block < blocks; ++block) {
+            __m256i message[16];
+            for (size_t lane = 0; lane < 8; ++lane) {
+                const unsigned char* data = input + lane * Blake3::chunkLength + block * Blake3::blockLength;
+                message[lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+                message[lane + 8] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+            }
+            transpose(message);
+            transpose(message + 8);
+
+            const uint32_t flags = (block == 0 ? ChunkStart : 0) | (block == blocks - 1 ? ChunkEnd : 0);
+
+            __m256i state[16] = {
+                chainingValue[0], chainingValue[1], chainingValue[2], chainingValue[3],
+                chainingValue[4], chainingValue[5], chainingValue[6], chainingValue[7],
+                _mm256_set1_epi32(static_cast<int>(iv[0])), _mm256_set1_epi32(static_cast<int>(iv[1])),
+                _mm256_set1_epi32(static_cast<int>(iv[2])), _mm256_set1_epi32(static_cast<int>(iv[3])),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counterLow)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counterHigh)),
+                _mm256_set1_epi32(static_cast<int>(Blake3::blockLength)),
+                _mm256_set1_epi32(static_cast<int>(flags)),
+            };
+
+            roundAvx2<0>(state, message);
+            roundAvx2<1>(state, message);
+            roundAvx2<2>(state, message);
+            roundAvx2<3>(state, message);
+            roundAvx2<4>(state, message);
+            roundAvx2<5>(state, message);
+            roundAvx2<6>(state, message);
+
+            for (size_t i = 0; i < 8; ++i) {
+                chainingValue[i] = _mm256_xor_si256(state[i], state[i + 8]);
+            }
+        }
+
+        // back to one row per chunk
+        transpose(chainingValue);
+        for (size_t lane = 0; lane < 8; ++lane) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(results[lane]), chainingValue[lane]);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void hashChunksAvx2(const unsigned char* input, size_t chunks, uint64_t counter, uint32_t (*results)[8]) {
+        for (; chunks >= 8; chunks -= 8, input += 8 * Blake3::chunkLength, counter += 8, results += 8) {
+            hashEightChunksAvx2(input, counter, results);
+        }
+        hashChunks(input, chunks, counter, results);
+    }
+#endif
+
+    using HashChunks = void (*)(const unsigned char*, size_t, uint64_t, uint32_t (*)[8]);
+
+    HashChunks getHashChunks() {
+#ifdef BFILEX_BLAKE3_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            return hashChunksAvx2;
+        }
+#endif
+        return hashChunks;
+    }
+
+    const HashChunks hashChunksKernel = getHashChunks();
+}
+
+Blake3::Blake3() : chainingValue{} {
+    std::copy(iv, iv + 8, chainingValue);
+}
+
+size_t Blake3::getChunkSize() const {
+    return blocksCompressed * blockLength + blockSize;
+}
+
+void Blake3::updateChunk(const unsigned char* input, size_t size) {
+    while (size > 0) {
+        // a block is only compressed once more input follows it, the last one gets the end flag
+        if (blockSize == blockLength) {
+            uint32_t output[16];
+            compress(chainingValue, block, blockLength, chunkCounter, blocksCompressed == 0 ? ChunkStart : 0,
+                     output);
+            std::memcpy(chainingValue, output, sizeof(chainingValue));
+            ++blocksCompressed;
+            blockSize = 0;
+        }
+
+        const size_t copied = std::min(size, blockLength - blockSize);
+        std::memcpy(block + blockSize, input, copied);
+        blockSize += copied;
+        input += copied;
+        size -= copied;
+    }
+}
+
+void Blake3::addChunk(const uint32_t* chunkChainingValue) {
+    uint32_t merged[8];
+    std::memcpy(merged, chunkChainingValue, sizeof(merged));
+
+    // every trailing zero bit of the chunk count is a subtree completed by this chunk
+    for (uint64_t chunks = chunkCounter + 1; (chunks & 1) == 0; chunks >>= 1) {
+        getParentOutput(subtrees[--subtreeCount], merged).getChainingValue(merged);
+    }
+    std::memcpy(subtrees[subtreeCount++], merged, sizeof(merged));
+
+    ++chunkCounter;
+    std::copy(iv, iv + 8, chainingValue);
+    blockSize = 0;
+    blocksCompressed = 0;
+}
+
+void Blake3::update(const void* data, size_t size) {
+    auto input = static_cast<const unsigned char*>(data);
+
+    while (size > 0) {
+        // whole chunks followed by more input are hashed directly, several at once
+        if (getChunkSize() == 0 and size > chunkLength) {
+            constexpr size_t batchSize = 64;
+            uint32_t results[batchSize][8];
+
+            const size_t chunks = std::min((size - 1) / chunkLength, batchSize);
+            hashChunksKernel(input, chunks, chunkCounter, results);
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                addChunk(results[chunk]);
+            }
+
+            input += chunks * chunkLength;
+            size -= chunks * chunkLength;
+            continue;
+        }
+
+        // the chunk is only finished once more input follows it, the last one may be the root
+        if (getChunkSize() == chunkLength) {
+            uint32_t chunkChainingValue[8];
+            Output output{};
+            std::memcpy(output.chainingValue, chainingValue, sizeof(chainingValue));
+            std::memcpy(output.block, block, blockLength);
+            output.blockSize = static_cast<uint32_t>(blockSize);
+            output.counter = chunkCounter;
+            output.flags = (blocksCompressed == 0 ? ChunkStart : 0) | ChunkEnd;
+            output.getChainingValue(chunkChainingValue);
+            addChunk(chunkChainingValue);
+        }
+
+        const size_t copied = std::min(size, chunkLength - getChunkSize());
+        updateChunk(input, copied);
+        input += copied;
+        size -= copied;
+    }
+}
+
+Blake3::Digest Blake3::digest() const {
+    Output output{};
+    std::memcpy(output.chainingValue, chainingValue, sizeof(chainingValue));
+    std::memcpy(output.block, block, blockSize); // zero padded past `blockSize`
+    output.blockSize = static_cast<uint32_t>(blockSize);
+    output.counter = chunkCounter;
+    output.flags = (blocksCompressed == 0 ? ChunkStart : 0) | ChunkEnd;
+
+    // merge the subtrees from the right, the last merge is the root
+    for (size_t i = subtreeCount; i > 0; --i) {
+        uint32_t right[8];
+        output.getChainingValue(right);
+        output = getParentOutput(subtrees[i - 1], right);
+    }
+
+    uint32_t words[16];
+    compress(output.chainingValue, output.block, output.blockSize, output.counter, output.flags | Root, words);
+
+    Digest result{};
+    std::memcpy(result.data(), words, digestLength);
+    return result;
+}
+
+Blake3::Digest Blake3::hash(const void* data, const size_t size) {
+    Blake3 hasher;
+    hasher.update(data, size);
+    return hasher.digest();
+}
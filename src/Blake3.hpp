@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// streaming BLAKE3 hash with the default 32 byte output, matching `b3sum`
+// on x86-64 eight chunks are compressed at once with AVX2 when the CPU supports it
+class Blake3 {
+public:
+    static constexpr size_t blockLength = 64;
+    static constexpr size_t chunkLength = 1024;
+    static constexpr size_t digestLength = 32;
+
+    using Digest = std::array<unsigned char, digestLength>;
+
+private:
+    // the chunk being hashed
+    uint32_t chainingValue[8];
+    uint64_t chunkCounter{};
+    unsigned char block[blockLength]{};
+    size_t blockSize{};
+    size_t blocksCompressed{};
+
+    // chaining values of the completed subtrees, one per level at most
+    uint32_t subtrees[54][8]{};
+    size_t subtreeCount{};
+
+    [[nodiscard]] size_t getChunkSize() const;
+    void updateChunk(const unsigned char* input, size_t size);
+    // adds the chaining value of a completed chunk, merging the subtrees it completes
+    void addChunk(const uint32_t* chunkChainingValue);
+
+public:
+    Blake3();
+
+    void update(const void* data, size_t size);
+    [[nodiscard]] Digest digest() const;
+
+    // hashes a whole input at once
+    static Digest hash(const void* data, size_t size);
+};
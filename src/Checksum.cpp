@@ -0,0 +1,271 @@
+#include "Checksum.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unistd.h>
+#include "Blake3.hpp"
+#include "Xxh3.hpp"
+
+#ifdef BFILEX_HAS_OPENSSL
+#include <openssl/evp.h>
+#endif
+
+namespace {
+    std::string toHex(const unsigned char* data, const size_t size) {
+        constexpr char hexDigits[] = "0123456789abcdef";
+
+        std::string hex;
+        hex.reserve(size * 2);
+        for (size_t i = 0; i < size; ++i) {
+            hex += {hexDigits[data[i] >> 4], hexDigits[data[i] & 0xf]};
+        }
+        return hex;
+    }
+
+    class Hasher {
+    public:
+        virtual ~Hasher() = default;
+        virtual void update(const unsigned char* data, size_t size) = 0;
+        virtual std::string finish() = 0;
+    };
+
+    class Xxh3Hasher final : public Hasher {
+        Xxh3 state;
+
+    public:
+        void update(const unsigned char* data, const size_t size) override {
+            state.update(data, size);
+        }
+
+        // printed big-endian like `xxhsum`
+        std::string finish() override {
+            const uint64_t digest = state.digest();
+
+            unsigned char bytes[8];
+            for (size_t i = 0; i < 8; ++i) {
+                bytes[i] = static_cast<unsigned char>(digest >> (56 - 8 * i));
+            }
+            return toHex(bytes, sizeof(bytes));
+        }
+    };
+
+    class Blake3Hasher final : public Hasher {
+        Blake3 state;
+
+    public:
+        void update(const unsigned char* data, const size_t size) override {
+            state.update(data, size);
+        }
+
+        std::string finish() override {
+            const Blake3::Digest digest = state.digest();
+            return toHex(digest.data(), digest.size());
+        }
+    };
+
+#ifdef BFILEX_HAS_OPENSSL
+    class Sha256Hasher final : public Hasher {
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context{EVP_MD_CTX_new(), EVP_MD_CTX_free};
+
+    public:
+        Sha256Hasher() {
+            if (context == nullptr or EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr) != 1) {
+                throw std::runtime_error("Failed to initialize SHA-256");
+            }
+        }
+
+        void update(const unsigned char* data, const size_t size) override {
+            EVP_DigestUpdate(context.get(), data, size);
+        }
+
+        std::string finish() override {
+            unsigned char digest[EVP_MAX_MD_SIZE];
+            unsigned int size{};
+            EVP_DigestFinal_ex(context.get(), digest, &size);
+            return toHex(digest, size);
+        }
+    };
+#endif
+
+    std::unique_ptr<Hasher> createHasher(const ChecksumAlgorithm algorithm) {
+        switch (algorithm) {
+            case ChecksumAlgorithm::Xxh3:
+                return std::make_unique<Xxh3Hasher>();
+            case ChecksumAlgorithm::Blake3:
+                return std::make_unique<Blake3Hasher>();
+            case ChecksumAlgorithm::Sha256:
+#ifdef BFILEX_HAS_OPENSSL
+                return std::make_unique<Sha256Hasher>();
+#else
+                break;
+#endif
+        }
+        throw std::runtime_error("Checksum algorithm not available");
+    }
+
+    // closes the descriptor when leaving the scope
+    struct FileDescriptor {
+        int descriptor;
+
+        ~FileDescriptor() {
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+        }
+    };
+}
+
+std::string_view Checksum::getName(const ChecksumAlgorithm algorithm) {
+    switch (algorithm) {
+        case ChecksumAlgorithm::Xxh3:
+            return "XXH3";
+        case ChecksumAlgorithm::Blake3:
+            return "BLAKE3";
+        case ChecksumAlgorithm::Sha256:
+            return "SHA-256";
+    }
+    return "";
+}
+
+std::string_view Checksum::getReportName(const ChecksumAlgorithm algorithm) {
+    switch (algorithm) {
+        case ChecksumAlgorithm::Xxh3:
+            return "XXH3SUMS";
+        case ChecksumAlgorithm::Blake3:
+            return "B3SUMS";
+        case ChecksumAlgorithm::Sha256:
+            return "SHA256SUMS";
+    }
+    return "";
+}
+
+bool Checksum::isAvailable([[maybe_unused]] const ChecksumAlgorithm algorithm) {
+#ifndef BFILEX_HAS_OPENSSL
+    if (algorithm == ChecksumAlgorithm::Sha256) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+std::string Checksum::computeFile(const fs::path& path, const ChecksumAlgorithm algorithm,
+                                  OperationProgress& progress) {
+    const FileDescriptor file{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (file.descriptor < 0) {
+        throw fs::filesystem_error("Failed to open", path, std::error_code(errno, std::generic_category()));
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    // read ahead more aggressively, the whole file is read once from start to end
+    posix_fadvise(file.descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    thread_local std::vector<unsigned char> buffer(bufferSize);
+    const std::unique_ptr<Hasher> hasher = createHasher(algorithm);
+
+    while (true) {
+        if (progress.cancelled.load(std::memory_order_relaxed)) {
+            throw fs::filesystem_error("Cancelled", path, std::make_error_code(std::errc::operation_canceled));
+        }
+
+        const ssize_t bytesRead = read(file.descriptor, buffer.data(), buffer.size());
+        if (bytesRead < 0 and errno == EINTR) {
+            continue;
+        }
+        if (bytesRead < 0) {
+            throw fs::filesystem_error("Failed to read", path, std::error_code(errno, std::generic_category()));
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+
+        hasher->update(buffer.data(), static_cast<size_t>(bytesRead));
+        progress.bytes.fetch_add(static_cast<uint64_t>(bytesRead), std::memory_order_relaxed);
+    }
+
+    return hasher->finish();
+}
+
+std::vector<fs::path> Checksum::collectFiles(const std::vector<fs::path>& paths, OperationProgress& progress) {
+    std::vector<fs::path> files;
+    uint64_t totalBytes = 0;
+
+    const auto addFile = [&](const fs::directory_entry& entry) {
+        std::error_code error;
+        if (entry.is_regular_file(error)) {
+            files.push_back(entry.path());
+            totalBytes += entry.file_size(error);
+        }
+    };
+
+    for (const fs::path& path : paths) {
+        std::error_code error;
+        const fs::directory_entry entry(path, error);
+
+        // symlinks to directories aren't followed, like `find`
+        if (not entry.is_directory(error) or entry.is_symlink(error)) {
+            addFile(entry);
+            continue;
+        }
+
+        for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, error);
+             it != fs::recursive_directory_iterator() and not progress.cancelled.load(); it.increment(error)) {
+            addFile(*it);
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+
+    progress.totalItems.store(files.size());
+    progress.totalBytes.store(totalBytes);
+    return files;
+}
+
+std::vector<ChecksumResult> Checksum::computeAll(const std::vector<fs::path>& files,
+                                                 const ChecksumAlgorithm algorithm, ThreadPool& pool,
+                                                 OperationProgress& progress) {
+    std::vector<ChecksumResult> results(files.size());
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        results[i].path = files[i];
+
+        // every task writes its own result only
+        pool.submit([&, i] {
+            if (progress.cancelled.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            try {
+                results[i].digest = computeFile(files[i], algorithm, progress);
+                progress.items.fetch_add(1, std::memory_order_relaxed);
+            } catch (const fs::filesystem_error& error) {
+                if (not progress.cancelled.load(std::memory_order_relaxed)) {
+                    progress.addError(error.what());
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    return results;
+}
+
+void Checksum::writeReport(const fs::path& reportPath, const std::vector<ChecksumResult>& results,
+                           const fs::path& directory) {
+    std::ofstream report(reportPath);
+
+    for (const ChecksumResult& result : results) {
+        if (not result.digest.empty()) {
+            report << result.digest << "  " << result.path.lexically_relative(directory).string() << '\n';
+        }
+    }
+
+    if (not report.flush()) {
+        throw fs::filesystem_error("Failed to write", reportPath, std::make_error_code(std::errc::io_error));
+    }
+}
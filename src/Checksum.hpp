@@ -0,0 +1,54 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+enum class ChecksumAlgorithm {
+    Xxh3,   // fastest, to detect corruption
+    Blake3, // cryptographic and still fast
+    Sha256, // the most widely published, needs libcrypto
+};
+
+// the checksum of a file, `digest` is empty if it couldn't be read
+struct ChecksumResult {
+    fs::path path;
+    std::string digest;
+};
+
+// checksums files to verify them after transfers
+// every file is a separate task on the pool and is read sequentially with a large buffer, the hash
+// kernels use the vector instructions of the CPU when it has them: AVX2 for xxh3 and BLAKE3, and
+// whatever libcrypto picks for SHA-256, e.g. the SHA extensions
+class Checksum {
+public:
+    // size of the reads, large enough for the readahead to keep up
+    static constexpr size_t bufferSize = 4 * 1024 * 1024;
+
+    // e.g. "SHA-256"
+    static std::string_view getName(ChecksumAlgorithm algorithm);
+    // name of the report written for several files, e.g. "SHA256SUMS"
+    static std::string_view getReportName(ChecksumAlgorithm algorithm);
+    // whether the algorithm was built in
+    static bool isAvailable(ChecksumAlgorithm algorithm);
+
+    // returns the hex digest of a file's contents, throws `fs::filesystem_error` if it can't be read
+    static std::string computeFile(const fs::path& path, ChecksumAlgorithm algorithm, OperationProgress& progress);
+
+    // returns the regular files in the given entries and the directories under them in path order,
+    // and sets the totals of `progress`
+    static std::vector<fs::path> collectFiles(const std::vector<fs::path>& paths, OperationProgress& progress);
+
+    // checksums the files in parallel, returns the results in the same order
+    static std::vector<ChecksumResult> computeAll(const std::vector<fs::path>& files, ChecksumAlgorithm algorithm,
+                                                  ThreadPool& pool, OperationProgress& progress);
+
+    // writes the results in the format of `sha256sum`, with paths relative to `directory`,
+    // throws `fs::filesystem_error` if it can't be written
+    static void writeReport(const fs::path& reportPath, const std::vector<ChecksumResult>& results,
+                            const fs::path& directory);
+};
@@ -21,6 +21,8 @@ void CommandLineParser::CommandLinePrinter::printHelp() {
     printCommand("-r, --reverse", "Reverse entries");
     printCommand("-a, --all", "Show all entries");
     printCommand("-np, --no-preview", "Don't show file preview");
+    printCommand("-c, --columns", "Show the parent directory in a column");
+    printCommand("-nt, --no-trash", "Delete entries permanently instead of moving them to the trash");
     printCommand("-h, --help", "Show help screen", false);
 }
 
@@ -86,6 +88,12 @@ void CommandLineParser::parse(const int argc, char** argv) {
             case Action::TogglePreview:
                 app.setShowPreview(false);
                 break;
+            case Action::ToggleColumns:
+                app.setShowColumns(true);
+                break;
+            case Action::ToggleTrash:
+                app.setUseTrash(false);
+                break;
             case Action::SetStartingDirectory:
                 if (not changedStartingDirectory) {
                     app.setStartingEntry(argument);
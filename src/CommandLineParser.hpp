@@ -30,6 +30,12 @@ class CommandLineParser {
         {"-np", Action::TogglePreview},
         {"--no-preview", Action::TogglePreview},
 
+        {"-c", Action::ToggleColumns},
+        {"--columns", Action::ToggleColumns},
+
+        {"-nt", Action::ToggleTrash},
+        {"--no-trash", Action::ToggleTrash},
+
         {"-h", Action::ToggleHelp},
         {"--help", Action::ToggleHelp},
     };
@@ -0,0 +1,382 @@
+#include "CopyEngine.hpp"
+#include "DeleteEngine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+namespace {
+    // state shared by the tasks copying a tree
+    struct CopyState {
+        ThreadPool& pool;
+        OperationProgress& progress;
+
+        // directories are created writable so their contents can be copied, their permissions
+        // and timestamps are set once everything in them is copied
+        std::mutex mutex;
+        std::vector<std::pair<std::string, struct stat>> directories;
+    };
+
+    void copyEntry(CopyState& state, const std::string& source, const std::string& destination,
+                   const struct stat& status);
+
+    void getTimes(const struct stat& status, timespec (&times)[2]) {
+#ifdef __APPLE__
+        times[0] = status.st_atimespec;
+        times[1] = status.st_mtimespec;
+#else
+        times[0] = status.st_atim;
+        times[1] = status.st_mtim;
+#endif
+    }
+
+    // `error` is taken from `errno` unless it was saved before a call that may overwrite it
+    std::string describeError(const std::string& action, const std::string& path, const int error = errno) {
+        return action + " " + path + ": " + std::strerror(error);
+    }
+
+    // copies `length` bytes at `offset` with reads and writes
+    bool copyRangeWithBuffer(const int in, const int out, off_t offset, uint64_t length, OperationProgress& progress) {
+        thread_local std::vector<char> buffer(CopyEngine::bufferSize);
+
+        while (length > 0) {
+            if (progress.cancelled.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            const ssize_t bytesRead = pread(in, buffer.data(), std::min<uint64_t>(length, buffer.size()), offset);
+            if (bytesRead < 0 and errno == EINTR) {
+                continue;
+            }
+            if (bytesRead <= 0) {
+                return bytesRead == 0; // the file shrank while copying
+            }
+
+            for (ssize_t written = 0; written < bytesRead;) {
+                const ssize_t result = pwrite(out, buffer.data() + written, bytesRead - written, offset + written);
+                if (result < 0 and errno == EINTR) {
+                    continue;
+                }
+                if (result <= 0) {
+                    return false;
+                }
+                written += result;
+            }
+
+            offset += bytesRead;
+            length -= bytesRead;
+            progress.bytes.fetch_add(bytesRead, std::memory_order_relaxed);
+        }
+
+        return true;
+    }
+
+    // copies `length` bytes at `offset` inside the kernel, falling back to reads and writes
+    bool copyRange(const int in, const int out, off_t offset, uint64_t length, OperationProgress& progress) {
+#ifdef __linux__
+        while (length > 0) {
+            if (progress.cancelled.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            loff_t inOffset = offset, outOffset = offset;
+            const ssize_t copied = copy_file_range(in, &inOffset, out, &outOffset,
+                                                   std::min<uint64_t>(length, CopyEngine::chunkSize), 0);
+            if (copied < 0 and errno == EINTR) {
+                continue;
+            }
+            if (copied < 0) {
+                // not supported between these files, e.g. across filesystems on older kernels
+                if (errno == EXDEV or errno == ENOSYS or errno == EINVAL or errno == EOPNOTSUPP) {
+                    break;
+                }
+                return false;
+            }
+            if (copied == 0) {
+                return true; // the file shrank while copying
+            }
+
+            offset += copied;
+            length -= copied;
+            progress.bytes.fetch_add(copied, std::memory_order_relaxed);
+        }
+#endif
+        return copyRangeWithBuffer(in, out, offset, length, progress);
+    }
+
+    bool copyContents(const int in, const int out, const uint64_t size, OperationProgress& progress) {
+#ifdef FICLONE
+        // share the data blocks on copy-on-write filesystems, nothing is copied
+        if (ioctl(out, FICLONE, in) == 0) {
+            progress.bytes.fetch_add(size, std::memory_order_relaxed);
+            return true;
+        }
+#endif
+
+        // only copy the data regions, the holes between them are left unwritten
+        for (uint64_t offset = 0; offset < size;) {
+            off_t dataStart = static_cast<off_t>(offset);
+            off_t dataEnd = static_cast<off_t>(size);
+#ifdef SEEK_DATA
+            dataStart = lseek(in, static_cast<off_t>(offset), SEEK_DATA);
+            if (dataStart < 0 and errno == ENXIO) {
+                break; // the rest of the file is a hole
+            }
+            if (dataStart < 0) {
+                dataStart = static_cast<off_t>(offset); // the filesystem doesn't report holes
+            } else if (const off_t holeStart = lseek(in, dataStart, SEEK_HOLE); holeStart > dataStart) {
+                dataEnd = std::min(holeStart, static_cast<off_t>(size));
+            }
+#endif
+            if (not copyRange(in, out, dataStart, dataEnd - dataStart, progress)) {
+                return false;
+            }
+            offset = dataEnd;
+        }
+
+        // set the size so a hole at the end of the file is kept
+        return ftruncate(out, static_cast<off_t>(size)) == 0;
+    }
+
+    void copyFile(CopyState& state, const std::string& source, const std::string& destination,
+                  const struct stat& status) {
+        const int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) {
+            state.progress.addError(describeError("Failed to open", source));
+            return;
+        }
+
+        // never overwrite an existing file
+        const int out = open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (out < 0) {
+            state.progress.addError(describeError("Failed to create", destination));
+            close(in);
+            return;
+        }
+
+        const bool copied = copyContents(in, out, status.st_size, state.progress);
+        // closing the files below may overwrite the error of the copy
+        const int copyError = errno;
+
+        if (copied) {
+            // keep the permissions and timestamps of the source
+            timespec times[2];
+            getTimes(status, times);
+            fchmod(out, status.st_mode & 07777);
+            futimens(out, times);
+        }
+
+        close(in);
+        close(out);
+
+        if (not copied) {
+            if (not state.progress.cancelled.load()) {
+                state.progress.addError(describeError("Failed to copy", source, copyError));
+            }
+            unlink(destination.c_str());
+            return;
+        }
+
+        state.progress.items.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void copyDirectory(CopyState& state, const std::string& source, const std::string& destination,
+                       const struct stat& status) {
+        if (mkdir(destination.c_str(), (status.st_mode & 07777) | S_IRWXU) != 0) {
+            state.progress.addError(describeError("Failed to create", destination));
+            return;
+        }
+
+        {
+            std::lock_guard lock(state.mutex);
+            state.directories.emplace_back(destination, status);
+        }
+        state.progress.items.fetch_add(1, std::memory_order_relaxed);
+
+        DIR* directory = opendir(source.c_str());
+        if (directory == nullptr) {
+            state.progress.addError(describeError("Failed to open", source));
+            return;
+        }
+
+        while (const dirent* child = readdir(directory)) {
+            if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            const std::string_view name = child->d_name;
+            if (name == "." or name == "..") {
+                continue;
+            }
+
+            struct stat status{};
+            if (fstatat(dirfd(directory), child->d_name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+                state.progress.addError(describeError("Failed to read", source + "/" + child->d_name));
+                continue;
+            }
+
+            std::string childSource = source + "/" + child->d_name;
+            std::string childDestination = destination + "/" + child->d_name;
+
+            // subdirectories and large files are copied in parallel, small files right away
+            if (S_ISDIR(status.st_mode) or (S_ISREG(status.st_mode) and
+                                            static_cast<uint64_t>(status.st_size) >= CopyEngine::largeFileSize)) {
+                state.pool.submit([&state, childSource = std::move(childSource),
+                                   childDestination = std::move(childDestination), status] {
+                    copyEntry(state, childSource, childDestination, status);
+                });
+            } else {
+                copyEntry(state, childSource, childDestination, status);
+            }
+        }
+
+        closedir(directory);
+    }
+
+    void copyEntry(CopyState& state, const std::string& source, const std::string& destination,
+                   const struct stat& status) {
+        if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        if (S_ISDIR(status.st_mode)) {
+            copyDirectory(state, source, destination, status);
+        } else if (S_ISREG(status.st_mode)) {
+            copyFile(state, source, destination, status);
+        } else if (S_ISLNK(status.st_mode)) {
+            std::string target(status.st_size > 0 ? status.st_size + 1 : PATH_MAX, '\0');
+            const ssize_t length = readlink(source.c_str(), target.data(), target.size());
+
+            if (length < 0 or symlink(target.substr(0, length).c_str(), destination.c_str()) != 0) {
+                state.progress.addError(describeError("Failed to copy link", source));
+                return;
+            }
+            state.progress.items.fetch_add(1, std::memory_order_relaxed);
+        } else if (S_ISFIFO(status.st_mode)) {
+            if (mkfifo(destination.c_str(), status.st_mode & 07777) != 0) {
+                state.progress.addError(describeError("Failed to create", destination));
+                return;
+            }
+            state.progress.items.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            errno = ENOTSUP;
+            state.progress.addError(describeError("Can't copy", source));
+        }
+    }
+}
+
+void CopyEngine::copy(const fs::path& source, const fs::path& destination, ThreadPool& pool,
+                      OperationProgress& progress) {
+    struct stat status{};
+    if (lstat(source.c_str(), &status) != 0) {
+        progress.addError(describeError("Failed to read", source.string()));
+        return;
+    }
+
+    // a directory can't be copied into itself
+    if (S_ISDIR(status.st_mode)) {
+        const fs::path normalizedSource = source.lexically_normal();
+        const fs::path normalizedDestination = destination.lexically_normal();
+        const auto [sourceEnd, destinationEnd] = std::mismatch(normalizedSource.begin(), normalizedSource.end(),
+                                                               normalizedDestination.begin(),
+                                                               normalizedDestination.end());
+        if (sourceEnd == normalizedSource.end()) {
+            errno = EINVAL;
+            progress.addError(describeError("Can't copy a directory into itself:", source.string()));
+            return;
+        }
+    }
+
+    CopyState state{pool, progress, {}, {}};
+    copyEntry(state, source.string(), destination.string(), status);
+    pool.wait();
+
+    // restore the permissions and timestamps of the directories, deepest first
+    // so setting them isn't undone by the entries created inside them
+    std::sort(state.directories.begin(), state.directories.end(), [](const auto& first, const auto& second) {
+        return first.first.size() > second.first.size();
+    });
+    for (const auto& [directory, status] : state.directories) {
+        timespec times[2];
+        getTimes(status, times);
+        chmod(directory.c_str(), status.st_mode & 07777);
+        utimensat(AT_FDCWD, directory.c_str(), times, 0);
+    }
+}
+
+void CopyEngine::move(const fs::path& source, const fs::path& destination, ThreadPool& pool,
+                      OperationProgress& progress) {
+    if (rename(source.c_str(), destination.c_str()) == 0) {
+        progress.items.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (errno != EXDEV) {
+        progress.addError(describeError("Failed to move", source.string()));
+        return;
+    }
+
+    // the destination is on another filesystem
+    const uint64_t previousErrors = progress.errors.load();
+    copy(source, destination, pool, progress);
+
+    // only delete the source if everything was copied
+    if (progress.errors.load() == previousErrors and not progress.cancelled.load()) {
+        // the deleted entries aren't counted, they were counted when copied
+        OperationProgress deleteProgress;
+        DeleteEngine::remove(source, pool, deleteProgress);
+        if (deleteProgress.errors.load() > 0) {
+            progress.addError(deleteProgress.getFirstError());
+        }
+    }
+}
+
+void CopyEngine::measure(const fs::path& source, OperationProgress& progress) {
+    uint64_t items = 1, bytes = 0;
+
+    std::error_code error;
+    if (fs::symlink_status(source, error).type() == fs::file_type::regular) {
+        bytes = fs::file_size(source, error);
+    } else if (fs::is_directory(fs::symlink_status(source, error))) {
+        for (auto it = fs::recursive_directory_iterator(source, fs::directory_options::skip_permission_denied, error);
+             it != fs::recursive_directory_iterator() and not progress.cancelled.load(); it.increment(error)) {
+            ++items;
+            if (it->symlink_status(error).type() == fs::file_type::regular) {
+                bytes += it->file_size(error);
+            }
+        }
+    }
+
+    progress.totalItems.fetch_add(items);
+    progress.totalBytes.fetch_add(bytes);
+}
+
+fs::path CopyEngine::getAvailablePath(const fs::path& directory, const fs::path& name) {
+    fs::path path = directory / name;
+
+    std::error_code error;
+    if (not fs::exists(fs::symlink_status(path, error))) {
+        return path;
+    }
+
+    // keep the extension at the end for files, "notes (copy).txt"
+    const std::string stem = name.stem().string();
+    const std::string extension = name.extension().string();
+
+    for (int copy = 1;; ++copy) {
+        path = directory / (stem + (copy == 1 ? " (copy)" : " (copy " + std::to_string(copy) + ")") + extension);
+        if (not fs::exists(fs::symlink_status(path, error))) {
+            return path;
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <filesystem>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+// copies and moves files, symlinks and directory trees
+// file contents are copied with the cheapest method the filesystem supports: a reflink sharing the
+// data blocks, then `copy_file_range` inside the kernel over the data regions only so holes stay holes,
+// and finally a read/write loop with a large buffer. directory trees are copied in parallel, every
+// subdirectory and large file being a separate task on the pool
+class CopyEngine {
+public:
+    // size of the buffer of the read/write fallback
+    static constexpr size_t bufferSize = 1024 * 1024;
+    // number of bytes copied between checks for cancellation
+    static constexpr size_t chunkSize = 16 * 1024 * 1024;
+    // files at least this large are copied as separate tasks
+    static constexpr uint64_t largeFileSize = 8 * 1024 * 1024;
+
+    // copies a file, symlink or directory tree to `destination`, which must not exist
+    static void copy(const fs::path& source, const fs::path& destination, ThreadPool& pool,
+                     OperationProgress& progress);
+
+    // moves an entry with a rename, or a copy followed by a delete when it's on another filesystem
+    static void move(const fs::path& source, const fs::path& destination, ThreadPool& pool,
+                     OperationProgress& progress);
+
+    // sets the totals of `progress` to the number of entries and bytes a copy of `source` processes
+    static void measure(const fs::path& source, OperationProgress& progress);
+
+    // returns the path of `name` in `directory`, with " (copy)" or " (copy N)" added before the extension
+    // if an entry with that name already exists
+    static fs::path getAvailablePath(const fs::path& directory, const fs::path& name);
+};
@@ -0,0 +1,322 @@
+#include "DeleteEngine.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+    // a directory being deleted, removed from its parent once its children are deleted
+    struct Directory {
+        std::shared_ptr<Directory> parent;
+        int parentDescriptor{};
+        std::string name;
+        int descriptor = -1;
+
+        // the listing of the directory and the subdirectories being deleted by other tasks
+        std::atomic<size_t> pending{1};
+        // set when a child couldn't be deleted, the directory isn't empty then
+        std::atomic_bool failed{};
+    };
+
+    // state shared by the tasks deleting a tree
+    struct DeleteState {
+        ThreadPool& pool;
+        OperationProgress& progress;
+        std::string rootParentPath;
+
+        // directories submitted to the pool and not finished yet, whether they're queued or have their
+        // descriptor open
+        std::atomic<size_t> inFlightDirectories{};
+    };
+
+    std::string getPath(const DeleteState& state, const Directory& directory) {
+        return (directory.parent != nullptr ? getPath(state, *directory.parent) : state.rootParentPath) + "/" +
+               directory.name;
+    }
+
+    void addError(const DeleteState& state, const std::string& action, const std::string& path) {
+        // the errors after a cancellation are expected
+        if (not state.progress.cancelled.load(std::memory_order_relaxed)) {
+            state.progress.addError(action + " " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    // deletes everything in the directory but its subdirectories, whose names are returned in `subdirectories`
+    // returns false if the directory can't be read or an entry in it can't be deleted
+    bool deleteFiles(const DeleteState& state, const int descriptor, const std::string& path,
+                     std::vector<std::string>& subdirectories) {
+        const int listingDescriptor = dup(descriptor);
+        DIR* stream = listingDescriptor >= 0 ? fdopendir(listingDescriptor) : nullptr;
+        if (stream == nullptr) {
+            addError(state, "Failed to open", path);
+            if (listingDescriptor >= 0) {
+                close(listingDescriptor);
+            }
+            return false;
+        }
+
+        // the whole listing is read before deleting, removing entries while reading a directory
+        // can make some filesystems skip entries
+        std::vector<std::pair<std::string, unsigned char>> children;
+        while (const dirent* child = readdir(stream)) {
+            const std::string_view name = child->d_name;
+            if (name != "." and name != "..") {
+                children.emplace_back(name, child->d_type);
+            }
+        }
+        closedir(stream);
+
+        bool deleted = true;
+        for (const auto& [name, type] : children) {
+            if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            bool isDirectory = type == DT_DIR;
+            if (type == DT_UNKNOWN) {
+                struct stat status{};
+                isDirectory = fstatat(descriptor, name.c_str(), &status, AT_SYMLINK_NOFOLLOW) == 0 and
+                              S_ISDIR(status.st_mode);
+            }
+
+            if (not isDirectory) {
+                if (unlinkat(descriptor, name.c_str(), 0) == 0) {
+                    state.progress.items.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                // the type reported by the listing was out of date
+                if (errno != EISDIR and errno != EPERM) {
+                    addError(state, "Failed to delete", path + "/" + name);
+                    deleted = false;
+                    continue;
+                }
+            }
+
+            subdirectories.push_back(name);
+        }
+
+        return deleted;
+    }
+
+    // deletes a directory tree in the calling task, depth first without recursing
+    // only the directory the walk is in is kept open, it goes back up through `..`, checking it's the directory
+    // it came from. returns false if anything is left
+    bool deleteTree(const DeleteState& state, const int parentDescriptor, const std::string& name,
+                    const std::string& path) {
+        struct Level {
+            std::string name;
+            std::string path;
+            std::vector<std::string> subdirectories; // not deleted yet
+            bool failed;
+            dev_t device;
+            ino_t inode;
+        };
+        std::vector<Level> levels;
+        int descriptor = -1; // of the last level
+
+        // opens a directory in the current one and deletes its files, returns false if it can't be opened
+        const auto enter = [&](const std::string& directoryName, const std::string& directoryPath) {
+            const int directoryDescriptor = openat(levels.empty() ? parentDescriptor : descriptor,
+                                                   directoryName.c_str(),
+                                                   O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            struct stat status{};
+            if (directoryDescriptor < 0 or fstat(directoryDescriptor, &status) != 0) {
+                addError(state, "Failed to open", directoryPath);
+                if (directoryDescriptor >= 0) {
+                    close(directoryDescriptor);
+                }
+                return false;
+            }
+
+            Level level{directoryName, directoryPath, {}, false, status.st_dev, status.st_ino};
+            level.failed = not deleteFiles(state, directoryDescriptor, directoryPath, level.subdirectories);
+            levels.push_back(std::move(level));
+
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+            descriptor = directoryDescriptor;
+            return true;
+        };
+
+        if (not enter(name, path)) {
+            return false;
+        }
+
+        while (not levels.empty()) {
+            if (Level& level = levels.back();
+                not level.subdirectories.empty() and not state.progress.cancelled.load(std::memory_order_relaxed)) {
+                const std::string subdirectory = std::move(level.subdirectories.back());
+                level.subdirectories.pop_back();
+
+                if (not enter(subdirectory, level.path + "/" + subdirectory)) {
+                    levels.back().failed = true;
+                }
+                continue;
+            }
+
+            // everything in the directory was deleted, go back to its parent and remove it from there
+            const Level level = std::move(levels.back());
+            levels.pop_back();
+
+            int nextDescriptor = parentDescriptor;
+            if (not levels.empty()) {
+                nextDescriptor = openat(descriptor, "..", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+                // the directory was moved while it was deleted
+                struct stat status{};
+                if (nextDescriptor < 0 or fstat(nextDescriptor, &status) != 0 or
+                    status.st_dev != levels.back().device or status.st_ino != levels.back().inode) {
+                    addError(state, "Failed to go back to", levels.back().path);
+                    if (nextDescriptor >= 0) {
+                        close(nextDescriptor);
+                    }
+                    close(descriptor);
+                    return false;
+                }
+            }
+            close(descriptor);
+            descriptor = levels.empty() ? -1 : nextDescriptor;
+
+            const bool removed = not level.failed and not state.progress.cancelled.load(std::memory_order_relaxed)
+                                 and unlinkat(nextDescriptor, level.name.c_str(), AT_REMOVEDIR) == 0;
+
+            if (removed) {
+                state.progress.items.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (not level.failed) {
+                addError(state, "Failed to delete", level.path);
+            }
+            if (levels.empty()) {
+                return false;
+            }
+            levels.back().failed = true;
+        }
+
+        return true;
+    }
+
+    // releases a reference to the directory, removing it and then its parents once nothing in them is pending
+    void finishDirectory(DeleteState& state, std::shared_ptr<Directory> directory) {
+        while (directory != nullptr and directory->pending.fetch_sub(1) == 1) {
+            if (directory->descriptor >= 0) {
+                close(directory->descriptor);
+            }
+            state.inFlightDirectories.fetch_sub(1);
+
+            const bool deleted = not directory->failed.load() and
+                                 not state.progress.cancelled.load(std::memory_order_relaxed) and
+                                 unlinkat(directory->parentDescriptor, directory->name.c_str(), AT_REMOVEDIR) == 0;
+
+            if (deleted) {
+                state.progress.items.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                if (not directory->failed.load()) {
+                    addError(state, "Failed to delete", getPath(state, *directory));
+                }
+                if (directory->parent != nullptr) {
+                    directory->parent->failed.store(true);
+                }
+            }
+
+            directory = directory->parent;
+        }
+    }
+
+    void deleteDirectory(DeleteState& state, const std::shared_ptr<Directory>& directory) {
+        if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+            return finishDirectory(state, directory);
+        }
+
+        const std::string path = getPath(state, *directory);
+        directory->descriptor = openat(directory->parentDescriptor, directory->name.c_str(),
+                                       O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (directory->descriptor < 0) {
+            addError(state, "Failed to open", path);
+            directory->failed.store(true);
+            return finishDirectory(state, directory);
+        }
+
+        std::vector<std::string> subdirectories;
+        if (not deleteFiles(state, directory->descriptor, path, subdirectories)) {
+            directory->failed.store(true);
+        }
+
+        for (const std::string& name : subdirectories) {
+            if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            // subdirectories are deleted in parallel until enough are in flight, then in this task
+            if (state.inFlightDirectories.fetch_add(1) >= DeleteEngine::maxParallelDirectories) {
+                state.inFlightDirectories.fetch_sub(1);
+                if (not deleteTree(state, directory->descriptor, name, path + "/" + name)) {
+                    directory->failed.store(true);
+                }
+                continue;
+            }
+
+            auto subdirectory = std::make_shared<Directory>();
+            subdirectory->parent = directory;
+            subdirectory->parentDescriptor = directory->descriptor;
+            subdirectory->name = name;
+            directory->pending.fetch_add(1);
+
+            state.pool.submit([&state, subdirectory = std::move(subdirectory)] {
+                deleteDirectory(state, subdirectory);
+            });
+        }
+
+        finishDirectory(state, directory);
+    }
+}
+
+uint64_t DeleteEngine::remove(const fs::path& path, ThreadPool& pool, OperationProgress& progress) {
+    const uint64_t previousItems = progress.items.load();
+
+    fs::path normalizedPath = path.lexically_normal();
+    if (not normalizedPath.has_filename()) {
+        normalizedPath = normalizedPath.parent_path(); // trailing separator
+    }
+
+    struct stat status{};
+    if (lstat(normalizedPath.c_str(), &status) != 0) {
+        progress.addError("Failed to delete " + normalizedPath.string() + ": " + std::strerror(errno));
+        return 0;
+    }
+
+    if (not S_ISDIR(status.st_mode)) {
+        if (unlink(normalizedPath.c_str()) != 0) {
+            progress.addError("Failed to delete " + normalizedPath.string() + ": " + std::strerror(errno));
+            return 0;
+        }
+        progress.items.fetch_add(1);
+        return 1;
+    }
+
+    const fs::path parentPath = normalizedPath.has_parent_path() ? normalizedPath.parent_path() : fs::path(".");
+    const int parentDescriptor = open(parentPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (parentDescriptor < 0) {
+        progress.addError("Failed to open " + parentPath.string() + ": " + std::strerror(errno));
+        return 0;
+    }
+
+    DeleteState state{pool, progress, parentPath.string()};
+
+    auto root = std::make_shared<Directory>();
+    root->parentDescriptor = parentDescriptor;
+    root->name = normalizedPath.filename().string();
+
+    state.inFlightDirectories.fetch_add(1);
+    deleteDirectory(state, root);
+    pool.wait();
+
+    close(parentDescriptor);
+    return progress.items.load() - previousItems;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <filesystem>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+// deletes files and directory trees
+// trees are walked relative to open directory descriptors with `openat` and `unlinkat`, so no path is
+// resolved twice, and subdirectories are deleted in parallel on the pool. a directory is removed by
+// whichever task finishes its last child
+class DeleteEngine {
+public:
+    // maximum number of directories deleted as separate tasks at once, queued or started. a started one keeps
+    // its descriptor open until everything in it is deleted. past the limit a task deletes the subdirectories
+    // it finds itself, with a walk keeping only the directory it's in open, so at most this many descriptors
+    // and a few per thread are open however deep the tree is
+    static constexpr size_t maxParallelDirectories = 128;
+
+    // deletes a file, symlink or directory tree, counting every deleted entry in `progress.items`
+    // returns the number of deleted entries
+    // waits for the pool to finish, so it must never be called from one of the pool's tasks
+    static uint64_t remove(const fs::path& path, ThreadPool& pool, OperationProgress& progress);
+};
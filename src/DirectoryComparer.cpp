@@ -0,0 +1,276 @@
+#include "DirectoryComparer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Checksum.hpp"
+#include "CopyEngine.hpp"
+
+namespace {
+    // an entry found while listing one of the trees
+    struct ListedEntry {
+        std::string relativePath;
+        mode_t type{};
+        uint64_t size{}; // of regular files
+        timespec modificationTime{};
+        std::string linkTarget; // of symlinks
+    };
+
+    // state shared by the tasks listing a tree
+    struct WalkState {
+        ThreadPool& pool;
+        OperationProgress& progress;
+        const std::string root;
+
+        std::mutex mutex;
+        std::vector<ListedEntry> entries;
+    };
+
+    void walkDirectory(WalkState& state, const std::string& relativePath) {
+        if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const std::string path = relativePath.empty()
+                                     ? state.root
+                                     : state.root + (state.root.back() == '/' ? "" : "/") + relativePath;
+
+        const int descriptor = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR* stream = descriptor >= 0 ? fdopendir(descriptor) : nullptr;
+        if (stream == nullptr) {
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+            state.progress.addError("Failed to open " + path + ": " + std::strerror(errno));
+            return;
+        }
+
+        std::vector<ListedEntry> entries;
+        while (const dirent* child = readdir(stream)) {
+            const std::string_view name = child->d_name;
+            if (name == "." or name == "..") {
+                continue;
+            }
+
+            struct stat status{};
+            if (fstatat(descriptor, child->d_name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            ListedEntry entry{relativePath.empty() ? std::string(name) : relativePath + "/" + child->d_name,
+                              status.st_mode & S_IFMT, S_ISREG(status.st_mode) ? static_cast<uint64_t>(status.st_size) : 0,
+                              status.st_mtim, {}};
+
+            if (S_ISLNK(status.st_mode)) {
+                char target[PATH_MAX];
+                const ssize_t length = readlinkat(descriptor, child->d_name, target, sizeof(target));
+                entry.linkTarget.assign(target, std::max<ssize_t>(length, 0));
+            } else if (S_ISDIR(status.st_mode)) {
+                state.pool.submit([&state, childPath = entry.relativePath] {
+                    walkDirectory(state, childPath);
+                });
+            }
+
+            entries.push_back(std::move(entry));
+        }
+        closedir(stream);
+
+        state.progress.items.fetch_add(entries.size(), std::memory_order_relaxed);
+
+        std::lock_guard lock(state.mutex);
+        std::move(entries.begin(), entries.end(), std::back_inserter(state.entries));
+    }
+
+    // orders paths component by component, so a directory comes right before its contents
+    bool isBefore(const std::string& first, const std::string& second) {
+        return std::lexicographical_compare(first.begin(), first.end(), second.begin(), second.end(),
+                                            [](const char a, const char b) {
+                                                return (a == '/' ? 0 : static_cast<unsigned char>(a)) <
+                                                       (b == '/' ? 0 : static_cast<unsigned char>(b));
+                                            });
+    }
+
+    bool isInside(const std::string& path, const std::string& directory) {
+        return path.size() > directory.size() and path[directory.size()] == '/' and
+               path.compare(0, directory.size(), directory) == 0;
+    }
+
+    ComparedFile describe(const ListedEntry* entry) {
+        if (entry == nullptr) {
+            return {};
+        }
+        return {true, S_ISDIR(entry->type), entry->size};
+    }
+}
+
+std::vector<ComparedEntry> DirectoryComparer::compare(const fs::path& left, const fs::path& right, ThreadPool& pool,
+                                                      OperationProgress& progress) {
+    // list both trees at once on the same pool
+    WalkState leftState{pool, progress, left.string(), {}, {}};
+    WalkState rightState{pool, progress, right.string(), {}, {}};
+    pool.submit([&] { walkDirectory(leftState, ""); });
+    pool.submit([&] { walkDirectory(rightState, ""); });
+    pool.wait();
+
+    std::vector<ListedEntry>& leftEntries = leftState.entries;
+    std::vector<ListedEntry>& rightEntries = rightState.entries;
+    const auto byPath = [](const ListedEntry& first, const ListedEntry& second) {
+        return isBefore(first.relativePath, second.relativePath);
+    };
+    std::sort(leftEntries.begin(), leftEntries.end(), byPath);
+    std::sort(rightEntries.begin(), rightEntries.end(), byPath);
+
+    std::vector<ComparedEntry> compared;
+    // files with the same size but different times, compared by their contents below
+    std::vector<size_t> hashedIndices;
+    // the last directory whose contents aren't listed
+    std::string skippedDirectory;
+
+    // match the entries of both sides in a single pass over the sorted lists
+    size_t leftIndex = 0, rightIndex = 0;
+    while (leftIndex < leftEntries.size() or rightIndex < rightEntries.size()) {
+        const ListedEntry* leftEntry = nullptr;
+        const ListedEntry* rightEntry = nullptr;
+
+        if (rightIndex == rightEntries.size() or
+            (leftIndex < leftEntries.size() and byPath(leftEntries[leftIndex], rightEntries[rightIndex]))) {
+            leftEntry = &leftEntries[leftIndex++];
+        } else if (leftIndex == leftEntries.size() or byPath(rightEntries[rightIndex], leftEntries[leftIndex])) {
+            rightEntry = &rightEntries[rightIndex++];
+        } else {
+            leftEntry = &leftEntries[leftIndex++];
+            rightEntry = &rightEntries[rightIndex++];
+        }
+
+        const std::string& relativePath = (leftEntry != nullptr ? leftEntry : rightEntry)->relativePath;
+        if (not skippedDirectory.empty() and isInside(relativePath, skippedDirectory)) {
+            continue;
+        }
+
+        ComparedEntry entry{relativePath, ComparisonStatus::Same, describe(leftEntry), describe(rightEntry)};
+
+        if (rightEntry == nullptr) {
+            entry.status = ComparisonStatus::OnlyLeft;
+        } else if (leftEntry == nullptr) {
+            entry.status = ComparisonStatus::OnlyRight;
+        } else if (leftEntry->type != rightEntry->type) {
+            entry.status = ComparisonStatus::Different;
+        } else if (S_ISREG(leftEntry->type)) {
+            if (leftEntry->size != rightEntry->size) {
+                entry.status = ComparisonStatus::Different;
+            } else if (leftEntry->modificationTime.tv_sec != rightEntry->modificationTime.tv_sec or
+                       leftEntry->modificationTime.tv_nsec != rightEntry->modificationTime.tv_nsec) {
+                hashedIndices.push_back(compared.size());
+            }
+        } else if (S_ISLNK(leftEntry->type) and leftEntry->linkTarget != rightEntry->linkTarget) {
+            entry.status = ComparisonStatus::Different;
+        }
+
+        // the contents of a directory missing from the other side, or replaced by a file there, all differ
+        if (entry.status != ComparisonStatus::Same and (entry.left.isDirectory or entry.right.isDirectory)) {
+            skippedDirectory = relativePath;
+        }
+
+        compared.push_back(std::move(entry));
+    }
+
+    // hash both copies of the files only their times tell apart, every copy is a separate task
+    uint64_t totalBytes = 0;
+    for (const size_t index : hashedIndices) {
+        totalBytes += 2 * compared[index].left.size;
+    }
+    progress.items.store(0);
+    progress.totalItems.store(2 * hashedIndices.size());
+    progress.bytes.store(0);
+    progress.totalBytes.store(totalBytes);
+
+    std::vector<std::string> digests(2 * hashedIndices.size());
+    for (size_t i = 0; i < hashedIndices.size(); ++i) {
+        for (size_t side = 0; side < 2; ++side) {
+            pool.submit([&, i, side] {
+                if (progress.cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                try {
+                    const std::string& relativePath = compared[hashedIndices[i]].relativePath;
+                    digests[2 * i + side] = Checksum::computeFile((side == 0 ? left : right) / relativePath,
+                                                                  ChecksumAlgorithm::Blake3, progress);
+                    progress.items.fetch_add(1, std::memory_order_relaxed);
+                } catch (const fs::filesystem_error& error) {
+                    if (not progress.cancelled.load(std::memory_order_relaxed)) {
+                        progress.addError(error.what());
+                    }
+                }
+            });
+        }
+    }
+    pool.wait();
+
+    // a file that couldn't be read counts as different
+    for (size_t i = 0; i < hashedIndices.size(); ++i) {
+        const bool isSame = not digests[2 * i].empty() and digests[2 * i] == digests[2 * i + 1];
+        compared[hashedIndices[i]].status = isSame ? ComparisonStatus::Same : ComparisonStatus::Different;
+    }
+
+    return compared;
+}
+
+void DirectoryComparer::sync(const fs::path& left, const fs::path& right, const std::vector<ComparedEntry>& entries,
+                             ThreadPool& pool, OperationProgress& progress) {
+    const auto isCopied = [](const ComparedEntry& entry) {
+        return entry.status == ComparisonStatus::OnlyLeft or entry.status == ComparisonStatus::Different;
+    };
+
+    // the totals give the sync an ETA
+    for (const ComparedEntry& entry : entries) {
+        if (isCopied(entry)) {
+            CopyEngine::measure(left / entry.relativePath, progress);
+        }
+    }
+
+    for (const ComparedEntry& entry : entries) {
+        if (progress.cancelled.load()) {
+            return;
+        }
+        if (not isCopied(entry)) {
+            continue;
+        }
+
+        const fs::path source = left / entry.relativePath;
+        const fs::path destination = right / entry.relativePath;
+
+        // every copy uses the whole pool, so the entries are copied one after the other
+        if (entry.status == ComparisonStatus::OnlyLeft) {
+            CopyEngine::copy(source, destination, pool, progress);
+            continue;
+        }
+
+        if (entry.left.isDirectory or entry.right.isDirectory) {
+            progress.addError("Can't replace " + destination.string() + ": " + std::strerror(EISDIR));
+            continue;
+        }
+
+        // copy next to the destination first and rename it over the destination, so it's never missing
+        const fs::path temporaryPath = destination.parent_path() / ("." + destination.filename().string() +
+                                                                    ".BFileX-sync");
+        std::error_code error;
+        fs::remove(temporaryPath, error);
+
+        const uint64_t previousErrors = progress.errors.load();
+        CopyEngine::copy(source, temporaryPath, pool, progress);
+
+        if (progress.errors.load() != previousErrors or progress.cancelled.load()) {
+            fs::remove(temporaryPath, error);
+        } else if (rename(temporaryPath.c_str(), destination.c_str()) != 0) {
+            progress.addError("Failed to replace " + destination.string() + ": " + std::strerror(errno));
+            fs::remove(temporaryPath, error);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+enum class ComparisonStatus {
+    OnlyLeft,
+    OnlyRight,
+    Same,
+    Different,
+};
+
+// one side of a compared entry
+struct ComparedFile {
+    bool exists{};
+    bool isDirectory{};
+    uint64_t size{}; // of regular files
+};
+
+// an entry of either directory, matched to the other one by its relative path
+struct ComparedEntry {
+    std::string relativePath;
+    ComparisonStatus status{};
+    ComparedFile left;
+    ComparedFile right;
+};
+
+// compares two directory trees entry by entry
+// both trees are listed in parallel, a task per directory, and matched by relative path. entries are
+// told apart by their type, size and modification time first, files of the same size but different
+// times are then hashed to check if only their times differ. a directory found on one side only is
+// listed once, without its contents
+class DirectoryComparer {
+public:
+    // returns the entries of both trees in path order, a directory right before its contents
+    static std::vector<ComparedEntry> compare(const fs::path& left, const fs::path& right, ThreadPool& pool,
+                                              OperationProgress& progress);
+
+    // makes `right` match `left` for the entries only on the left and the ones that differ, the entries
+    // only on the right are kept. a file is replaced by renaming a copy over it, an entry whose type
+    // changed to or from a directory is reported as an error and left as is
+    static void sync(const fs::path& left, const fs::path& right, const std::vector<ComparedEntry>& entries,
+                     ThreadPool& pool, OperationProgress& progress);
+};
@@ -0,0 +1,162 @@
+#include "DirectoryTree.hpp"
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+DirectoryTree::DirectoryTree(const fs::path& rootPath, const bool showHidden)
+    : rootPath(rootPath), showHidden(showHidden) {
+    nodes.push_back({noNode, 0, 0, 0, 0, 0, true, false, false});
+    expand(0);
+}
+
+bool DirectoryTree::listChildren(const uint32_t index) {
+    const int descriptor = open(getPath(index).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* stream = descriptor >= 0 ? fdopendir(descriptor) : nullptr;
+    if (stream == nullptr) {
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        return false;
+    }
+
+    struct Child {
+        std::string name;
+        bool isDirectory;
+    };
+    std::vector<Child> children;
+
+    while (const dirent* entry = readdir(stream)) {
+        const std::string_view name = entry->d_name;
+        if (name == "." or name == ".." or (not showHidden and name.front() == '.')) {
+            continue;
+        }
+
+        // symlinks aren't followed, so the tree can't loop
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat status{};
+            isDirectory = fstatat(descriptor, entry->d_name, &status, AT_SYMLINK_NOFOLLOW) == 0 and
+                          S_ISDIR(status.st_mode);
+        }
+
+        children.push_back({std::string(name), isDirectory});
+    }
+    closedir(stream);
+
+    std::sort(children.begin(), children.end(), [](const Child& first, const Child& second) {
+        if (first.isDirectory != second.isDirectory) {
+            return first.isDirectory;
+        }
+        return strcasecmp(first.name.c_str(), second.name.c_str()) < 0;
+    });
+
+    // the indices and offsets are 32 bits
+    size_t namesSize = names.size();
+    for (const Child& child : children) {
+        namesSize += child.name.size();
+    }
+    if (nodes.size() + children.size() >= noNode or namesSize > UINT32_MAX) {
+        return false;
+    }
+
+    const auto firstChild = static_cast<uint32_t>(nodes.size());
+    const auto depth = static_cast<uint16_t>(nodes[index].depth + 1);
+    nodes.reserve(nodes.size() + children.size());
+
+    for (const Child& child : children) {
+        nodes.push_back({index, 0, 0, static_cast<uint32_t>(names.size()), static_cast<uint32_t>(child.name.size()),
+                         depth, child.isDirectory, false, false});
+        names += child.name;
+    }
+
+    TreeNode& node = nodes[index];
+    node.firstChild = firstChild;
+    node.childCount = static_cast<uint32_t>(children.size());
+    node.isListed = true;
+    return true;
+}
+
+const TreeNode& DirectoryTree::getNode(const uint32_t index) const {
+    return nodes[index];
+}
+
+std::string_view DirectoryTree::getName(const uint32_t index) const {
+    return std::string_view(names).substr(nodes[index].nameOffset, nodes[index].nameLength);
+}
+
+fs::path DirectoryTree::getPath(const uint32_t index) const {
+    // the names from the node up to the root's child
+    std::vector<std::string_view> components;
+    for (uint32_t current = index; current != 0; current = nodes[current].parent) {
+        components.push_back(getName(current));
+    }
+
+    fs::path path = rootPath;
+    for (auto it = components.rbegin(); it != components.rend(); ++it) {
+        path /= *it;
+    }
+    return path;
+}
+
+uint32_t DirectoryTree::getFirst() const {
+    return nodes[0].childCount > 0 ? nodes[0].firstChild : noNode;
+}
+
+bool DirectoryTree::expand(const uint32_t index) {
+    if (not nodes[index].isDirectory or (not nodes[index].isListed and not listChildren(index))) {
+        return false;
+    }
+
+    nodes[index].isExpanded = true;
+    return true;
+}
+
+void DirectoryTree::collapse(const uint32_t index) {
+    // the children stay listed, expanding it again doesn't read it
+    nodes[index].isExpanded = false;
+}
+
+uint32_t DirectoryTree::getNext(const uint32_t index) const {
+    const TreeNode& node = nodes[index];
+    if (node.isExpanded and node.childCount > 0) {
+        return node.firstChild;
+    }
+
+    // the next sibling of the node or of its closest ancestor that has one
+    for (uint32_t current = index; current != 0; current = nodes[current].parent) {
+        const TreeNode& parent = nodes[nodes[current].parent];
+        if (current + 1 < parent.firstChild + parent.childCount) {
+            return current + 1;
+        }
+    }
+    return noNode;
+}
+
+uint32_t DirectoryTree::getPrevious(const uint32_t index) const {
+    const uint32_t parent = nodes[index].parent;
+    if (index == nodes[parent].firstChild) {
+        return parent == 0 ? noNode : parent;
+    }
+
+    // the last node shown inside the previous sibling
+    uint32_t current = index - 1;
+    while (nodes[current].isExpanded and nodes[current].childCount > 0) {
+        current = nodes[current].firstChild + nodes[current].childCount - 1;
+    }
+    return current;
+}
+
+uint32_t DirectoryTree::getVisibleAncestor(const uint32_t index) const {
+    uint32_t visible = index;
+    for (uint32_t current = nodes[index].parent; current != noNode and current != 0;
+         current = nodes[current].parent) {
+        if (not nodes[current].isExpanded) {
+            visible = current;
+        }
+    }
+    return visible;
+}
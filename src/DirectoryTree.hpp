@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// a node of a `DirectoryTree`, the children of a node are stored next to each other
+struct TreeNode {
+    uint32_t parent;     // `DirectoryTree::noNode` for the root
+    uint32_t firstChild; // meaningful once `isListed` is set
+    uint32_t childCount;
+    uint32_t nameOffset; // of the name in the tree's name buffer
+    uint32_t nameLength;
+    uint16_t depth;      // 0 for the root
+    bool isDirectory;
+    bool isListed;       // the children were read
+    bool isExpanded;     // the children are shown
+};
+
+// a directory tree whose directories are read when they're first expanded
+// the nodes live in a single vector and refer to each other by index, and their names in a single buffer,
+// so a tree with millions of nodes stays a few allocations. the nodes shown are never collected in a list:
+// the next and previous ones are found by walking the tree from the current one, which costs the depth
+// of the tree and not its size, so only the nodes in the visible window are ever looked at
+class DirectoryTree {
+    std::vector<TreeNode> nodes;
+    std::string names;
+    fs::path rootPath;
+    bool showHidden;
+
+    // reads the children of a directory, in the order of the default sort: directories first, then by name
+    bool listChildren(uint32_t index);
+
+public:
+    static constexpr uint32_t noNode = UINT32_MAX;
+
+    // lists the root's children, the root itself isn't shown
+    DirectoryTree(const fs::path& rootPath, bool showHidden);
+
+    [[nodiscard]] const TreeNode& getNode(uint32_t index) const;
+    [[nodiscard]] std::string_view getName(uint32_t index) const;
+    // builds the path of a node from its ancestors
+    [[nodiscard]] fs::path getPath(uint32_t index) const;
+    // the first node shown, `noNode` if the root is empty
+    [[nodiscard]] uint32_t getFirst() const;
+
+    // shows the children of a directory, reading them the first time
+    // returns false if the node isn't a directory or it can't be read
+    bool expand(uint32_t index);
+    void collapse(uint32_t index);
+
+    // the node shown after or before a node, `noNode` past the ends
+    [[nodiscard]] uint32_t getNext(uint32_t index) const;
+    [[nodiscard]] uint32_t getPrevious(uint32_t index) const;
+
+    // returns the node shown in place of a node: its outermost collapsed ancestor, or the node itself
+    [[nodiscard]] uint32_t getVisibleAncestor(uint32_t index) const;
+};
@@ -0,0 +1,264 @@
+#include "DisplayWidth.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+#if defined(__AVX2__) or defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    struct Range {
+        char32_t first;
+        char32_t last;
+    };
+
+    // the tables are generated from the Unicode 14.0 character database, unassigned code points between
+    // two ranges are merged into them
+
+    // nonspacing, enclosing and spacing marks, format characters, Hangul medial and final jamo,
+    // and emoji skin tone modifiers, all of which continue the grapheme cluster before them
+    constexpr Range zeroWidthRanges[] = {
+        {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF}, {0x05C1, 0x05C2}, {0x05C4, 0x05C5},
+        {0x05C7, 0x05C7}, {0x0600, 0x0605}, {0x0610, 0x061A}, {0x061C, 0x061C}, {0x064B, 0x065F}, {0x0670, 0x0670},
+        {0x06D6, 0x06DD}, {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x070F, 0x070F}, {0x0711, 0x0711},
+        {0x0730, 0x074A}, {0x07A6, 0x07B0}, {0x07EB, 0x07F3}, {0x07FD, 0x07FD}, {0x0816, 0x0819}, {0x081B, 0x0823},
+        {0x0825, 0x0827}, {0x0829, 0x082D}, {0x0859, 0x085B}, {0x0890, 0x089F}, {0x08CA, 0x0903}, {0x093A, 0x093C},
+        {0x093E, 0x094F}, {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0981, 0x0983}, {0x09BC, 0x09BC}, {0x09BE, 0x09CD},
+        {0x09D7, 0x09D7}, {0x09E2, 0x09E3}, {0x09FE, 0x0A03}, {0x0A3C, 0x0A51}, {0x0A70, 0x0A71}, {0x0A75, 0x0A75},
+        {0x0A81, 0x0A83}, {0x0ABC, 0x0ABC}, {0x0ABE, 0x0ACD}, {0x0AE2, 0x0AE3}, {0x0AFA, 0x0B03}, {0x0B3C, 0x0B3C},
+        {0x0B3E, 0x0B57}, {0x0B62, 0x0B63}, {0x0B82, 0x0B82}, {0x0BBE, 0x0BCD}, {0x0BD7, 0x0BD7}, {0x0C00, 0x0C04},
+        {0x0C3C, 0x0C3C}, {0x0C3E, 0x0C56}, {0x0C62, 0x0C63}, {0x0C81, 0x0C83}, {0x0CBC, 0x0CBC}, {0x0CBE, 0x0CD6},
+        {0x0CE2, 0x0CE3}, {0x0D00, 0x0D03}, {0x0D3B, 0x0D3C}, {0x0D3E, 0x0D4D}, {0x0D57, 0x0D57}, {0x0D62, 0x0D63},
+        {0x0D81, 0x0D83}, {0x0DCA, 0x0DDF}, {0x0DF2, 0x0DF3}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E},
+        {0x0EB1, 0x0EB1}, {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECD}, {0x0F18, 0x0F19}, {0x0F35, 0x0F35}, {0x0F37, 0x0F37},
+        {0x0F39, 0x0F39}, {0x0F3E, 0x0F3F}, {0x0F71, 0x0F84}, {0x0F86, 0x0F87}, {0x0F8D, 0x0FBC}, {0x0FC6, 0x0FC6},
+        {0x102B, 0x103E}, {0x1056, 0x1059}, {0x105E, 0x1060}, {0x1062, 0x1064}, {0x1067, 0x106D}, {0x1071, 0x1074},
+        {0x1082, 0x108D}, {0x108F, 0x108F}, {0x109A, 0x109D}, {0x1160, 0x11FF}, {0x135D, 0x135F}, {0x1712, 0x1715},
+        {0x1732, 0x1734}, {0x1752, 0x1753}, {0x1772, 0x1773}, {0x17B4, 0x17D3}, {0x17DD, 0x17DD}, {0x180B, 0x180F},
+        {0x1885, 0x1886}, {0x18A9, 0x18A9}, {0x1920, 0x193B}, {0x1A17, 0x1A1B}, {0x1A55, 0x1A7F}, {0x1AB0, 0x1B04},
+        {0x1B34, 0x1B44}, {0x1B6B, 0x1B73}, {0x1B80, 0x1B82}, {0x1BA1, 0x1BAD}, {0x1BE6, 0x1BF3}, {0x1C24, 0x1C37},
+        {0x1CD0, 0x1CD2}, {0x1CD4, 0x1CE8}, {0x1CED, 0x1CED}, {0x1CF4, 0x1CF4}, {0x1CF7, 0x1CF9}, {0x1DC0, 0x1DFF},
+        {0x200B, 0x200F}, {0x202A, 0x202E}, {0x2060, 0x206F}, {0x20D0, 0x20F0}, {0x2CEF, 0x2CF1}, {0x2D7F, 0x2D7F},
+        {0x2DE0, 0x2DFF}, {0x302A, 0x302F}, {0x3099, 0x309A}, {0xA66F, 0xA672}, {0xA674, 0xA67D}, {0xA69E, 0xA69F},
+        {0xA6F0, 0xA6F1}, {0xA802, 0xA802}, {0xA806, 0xA806}, {0xA80B, 0xA80B}, {0xA823, 0xA827}, {0xA82C, 0xA82C},
+        {0xA880, 0xA881}, {0xA8B4, 0xA8C5}, {0xA8E0, 0xA8F1}, {0xA8FF, 0xA8FF}, {0xA926, 0xA92D}, {0xA947, 0xA953},
+        {0xA980, 0xA983}, {0xA9B3, 0xA9C0}, {0xA9E5, 0xA9E5}, {0xAA29, 0xAA36}, {0xAA43, 0xAA43}, {0xAA4C, 0xAA4D},
+        {0xAA7B, 0xAA7D}, {0xAAB0, 0xAAB0}, {0xAAB2, 0xAAB4}, {0xAAB7, 0xAAB8}, {0xAABE, 0xAABF}, {0xAAC1, 0xAAC1},
+        {0xAAEB, 0xAAEF}, {0xAAF5, 0xAAF6}, {0xABE3, 0xABEA}, {0xABEC, 0xABED}, {0xFB1E, 0xFB1E}, {0xFE00, 0xFE0F},
+        {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0xFFF9, 0xFFFB}, {0x101FD, 0x101FD}, {0x102E0, 0x102E0},
+        {0x10376, 0x1037A}, {0x10A01, 0x10A0F}, {0x10A38, 0x10A3F}, {0x10AE5, 0x10AE6}, {0x10D24, 0x10D27},
+        {0x10EAB, 0x10EAC}, {0x10F46, 0x10F50}, {0x10F82, 0x10F85}, {0x11000, 0x11002}, {0x11038, 0x11046},
+        {0x11070, 0x11070}, {0x11073, 0x11074}, {0x1107F, 0x11082}, {0x110B0, 0x110BA}, {0x110BD, 0x110BD},
+        {0x110C2, 0x110CD}, {0x11100, 0x11102}, {0x11127, 0x11134}, {0x11145, 0x11146}, {0x11173, 0x11173},
+        {0x11180, 0x11182}, {0x111B3, 0x111C0}, {0x111C9, 0x111CC}, {0x111CE, 0x111CF}, {0x1122C, 0x11237},
+        {0x1123E, 0x1123E}, {0x112DF, 0x112EA}, {0x11300, 0x11303}, {0x1133B, 0x1133C}, {0x1133E, 0x1134D},
+        {0x11357, 0x11357}, {0x11362, 0x11374}, {0x11435, 0x11446}, {0x1145E, 0x1145E}, {0x114B0, 0x114C3},
+        {0x115AF, 0x115C0}, {0x115DC, 0x115DD}, {0x11630, 0x11640}, {0x116AB, 0x116B7}, {0x1171D, 0x1172B},
+        {0x1182C, 0x1183A}, {0x11930, 0x1193E}, {0x11940, 0x11940}, {0x11942, 0x11943}, {0x119D1, 0x119E0},
+        {0x119E4, 0x119E4}, {0x11A01, 0x11A0A}, {0x11A33, 0x11A39}, {0x11A3B, 0x11A3E}, {0x11A47, 0x11A47},
+        {0x11A51, 0x11A5B}, {0x11A8A, 0x11A99}, {0x11C2F, 0x11C3F}, {0x11C92, 0x11CB6}, {0x11D31, 0x11D45},
+        {0x11D47, 0x11D47}, {0x11D8A, 0x11D97}, {0x11EF3, 0x11EF6}, {0x13430, 0x13438}, {0x16AF0, 0x16AF4},
+        {0x16B30, 0x16B36}, {0x16F4F, 0x16F4F}, {0x16F51, 0x16F92}, {0x16FE4, 0x16FF1}, {0x1BC9D, 0x1BC9E},
+        {0x1BCA0, 0x1BCA3}, {0x1CF00, 0x1CF46}, {0x1D165, 0x1D169}, {0x1D16D, 0x1D182}, {0x1D185, 0x1D18B},
+        {0x1D1AA, 0x1D1AD}, {0x1D242, 0x1D244}, {0x1DA00, 0x1DA36}, {0x1DA3B, 0x1DA6C}, {0x1DA75, 0x1DA75},
+        {0x1DA84, 0x1DA84}, {0x1DA9B, 0x1DAAF}, {0x1E000, 0x1E02A}, {0x1E130, 0x1E136}, {0x1E2AE, 0x1E2AE},
+        {0x1E2EC, 0x1E2EF}, {0x1E8D0, 0x1E8D6}, {0x1E944, 0x1E94A}, {0x1F3FB, 0x1F3FF}, {0xE0001, 0xE01EF},
+    };
+
+    // characters with an East Asian width of wide or fullwidth, which includes the emoji shown as emoji by default,
+    // and the code points reserved for emoji (unassigned Extended_Pictographic), as terminals show future emoji wide
+    constexpr Range wideRanges[] = {
+        {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0}, {0x23F3, 0x23F3},
+        {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+        {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA},
+        {0x26F2, 0x26F3}, {0x26F5, 0x26F5}, {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+        {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+        {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x3029},
+        {0x3030, 0x303E}, {0x3041, 0x3096}, {0x309B, 0x3247}, {0x3250, 0x4DBF}, {0x4E00, 0xA4C6}, {0xA960, 0xA97C},
+        {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6B}, {0xFF01, 0xFF60}, {0xFFE0, 0xFFE6},
+        {0x16FE0, 0x16FE3}, {0x17000, 0x1B2FB}, {0x1F004, 0x1F004}, {0x1F02C, 0x1F02F}, {0x1F094, 0x1F09F},
+        {0x1F0AF, 0x1F0B0}, {0x1F0C0, 0x1F0C0}, {0x1F0CF, 0x1F0D0}, {0x1F0F6, 0x1F0FF}, {0x1F18E, 0x1F18E},
+        {0x1F191, 0x1F19A}, {0x1F1AE, 0x1F1E5}, {0x1F200, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C},
+        {0x1F37E, 0x1F393}, {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4},
+        {0x1F3F8, 0x1F3FA}, {0x1F400, 0x1F43E}, {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D},
+        {0x1F54B, 0x1F54E}, {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596}, {0x1F5A4, 0x1F5A4},
+        {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5}, {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6DF},
+        {0x1F6EB, 0x1F6EF}, {0x1F6F4, 0x1F6FF}, {0x1F774, 0x1F77F}, {0x1F7D9, 0x1F7FF}, {0x1F80C, 0x1F80F},
+        {0x1F848, 0x1F84F}, {0x1F85A, 0x1F85F}, {0x1F888, 0x1F88F}, {0x1F8AE, 0x1F8AF}, {0x1F8B2, 0x1F8FF},
+        {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF}, {0x1FA54, 0x1FA5F}, {0x1FA6E, 0x1FAFF},
+        {0x1FC00, 0x3FFFD},
+    };
+
+    constexpr char32_t replacementCharacter = 0xFFFD;
+    constexpr char32_t zeroWidthJoiner = 0x200D;
+
+    bool isInRanges(const char32_t codePoint, const Range* begin, const Range* end) {
+        const Range* range = std::upper_bound(begin, end, codePoint, [](const char32_t value, const Range& r) {
+            return value < r.first;
+        });
+        return range != begin and codePoint <= (range - 1)->last;
+    }
+
+    bool isRegionalIndicator(const char32_t codePoint) {
+        return codePoint >= 0x1F1E6 and codePoint <= 0x1F1FF;
+    }
+}
+
+size_t DisplayWidth::asciiPrefixLength(const std::string_view text) {
+    const char* data = text.data();
+    const size_t size = text.size();
+    size_t i{};
+
+#if defined(__AVX2__)
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        // the mask has a bit set for every byte with its high bit set
+        if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(block)); mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(block)); mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (static_cast<unsigned char>(data[i]) >= 0x80) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t DisplayWidth::decode(const std::string_view text, const size_t position, char32_t& codePoint) {
+    const auto byte = static_cast<unsigned char>(text[position]);
+
+    if (byte < 0x80) {
+        codePoint = byte;
+        return 1;
+    }
+
+    // the number of continuation bytes and the minimum value, to reject overlong encodings
+    size_t length;
+    char32_t minimum;
+    if ((byte & 0xE0) == 0xC0) {
+        length = 2, minimum = 0x80, codePoint = byte & 0x1F;
+    } else if ((byte & 0xF0) == 0xE0) {
+        length = 3, minimum = 0x800, codePoint = byte & 0x0F;
+    } else if ((byte & 0xF8) == 0xF0) {
+        length = 4, minimum = 0x10000, codePoint = byte & 0x07;
+    } else {
+        codePoint = replacementCharacter;
+        return 1;
+    }
+
+    if (position + length > text.size()) {
+        codePoint = replacementCharacter;
+        return 1;
+    }
+
+    for (size_t i = 1; i < length; ++i) {
+        const auto continuation = static_cast<unsigned char>(text[position + i]);
+        if ((continuation & 0xC0) != 0x80) {
+            codePoint = replacementCharacter;
+            return 1;
+        }
+        codePoint = codePoint << 6 | (continuation & 0x3F);
+    }
+
+    if (codePoint < minimum or codePoint > 0x10FFFF or (codePoint >= 0xD800 and codePoint <= 0xDFFF)) {
+        codePoint = replacementCharacter;
+        return 1;
+    }
+
+    return length;
+}
+
+int DisplayWidth::codePointWidth(const char32_t codePoint) {
+    // every code point before the combining diacritical marks takes a column
+    if (codePoint < 0x300) {
+        return 1;
+    }
+
+    if (isInRanges(codePoint, std::begin(zeroWidthRanges), std::end(zeroWidthRanges))) {
+        return 0;
+    }
+
+    if (codePoint >= 0x1100 and isInRanges(codePoint, std::begin(wideRanges), std::end(wideRanges))) {
+        return 2;
+    }
+
+    return 1;
+}
+
+int DisplayWidth::width(const std::string_view text) {
+    int textWidth;
+    truncate(text, std::numeric_limits<int>::max(), textWidth);
+    return textWidth;
+}
+
+std::string_view DisplayWidth::truncate(const std::string_view text, const int maxWidth, int& width) {
+    width = 0;
+    if (maxWidth <= 0) {
+        return {};
+    }
+
+    // every ASCII byte takes a column, the last one is measured with the rest of the text
+    // since a combining mark after it belongs to its grapheme cluster
+    const size_t asciiLength = asciiPrefixLength(text);
+    if (asciiLength == text.size() or static_cast<size_t>(maxWidth) < asciiLength) {
+        const size_t length = std::min(text.size(), static_cast<size_t>(maxWidth));
+        width = static_cast<int>(length);
+        return text.substr(0, length);
+    }
+
+    size_t position = asciiLength > 0 ? asciiLength - 1 : 0;
+    width = static_cast<int>(position);
+
+    while (position < text.size()) {
+        const size_t clusterStart = position;
+
+        char32_t codePoint;
+        position += decode(text, position, codePoint);
+        int clusterWidth = codePointWidth(codePoint);
+        // a pair of regional indicators is shown as a single flag
+        bool isFlagStart = isRegionalIndicator(codePoint);
+        bool joinNext = false;
+
+        // extend the cluster with the zero width characters after the first code point,
+        // the code point after a zero width joiner, and the second half of a flag
+        while (position < text.size()) {
+            char32_t next;
+            const size_t length = decode(text, position, next);
+
+            if (joinNext or codePointWidth(next) == 0) {
+                joinNext = next == zeroWidthJoiner;
+            } else if (isFlagStart and isRegionalIndicator(next)) {
+                isFlagStart = false;
+                clusterWidth = 2;
+            } else {
+                break;
+            }
+            position += length;
+        }
+
+        if (width + clusterWidth > maxWidth) {
+            return text.substr(0, clusterStart);
+        }
+        width += clusterWidth;
+    }
+
+    return text;
+}
+
+std::string_view DisplayWidth::truncate(const std::string_view text, const int maxWidth) {
+    int textWidth;
+    return truncate(text, maxWidth, textWidth);
+}
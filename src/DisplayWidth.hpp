@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+// number of terminal columns text takes, used to truncate and pad entries and preview lines
+// ASCII text is detected 16 or 32 bytes at a time and measured by its size, the rest is decoded
+// as UTF-8 and measured with East Asian width and zero width tables, keeping grapheme clusters whole
+class DisplayWidth {
+    // decodes the code point at `position`, invalid bytes are decoded as U+FFFD one byte at a time
+    // returns the number of bytes decoded
+    static size_t decode(std::string_view text, size_t position, char32_t& codePoint);
+
+public:
+    // returns the number of leading bytes that are ASCII
+    static size_t asciiPrefixLength(std::string_view text);
+
+    // returns the number of columns a code point takes: 0 for combining marks, joiners and other
+    // zero width characters, 2 for wide East Asian characters and emoji, and 1 for the rest
+    static int codePointWidth(char32_t codePoint);
+
+    // returns the number of columns the text takes
+    static int width(std::string_view text);
+
+    // returns the longest prefix of the text that fits in `maxWidth` columns without splitting a grapheme cluster
+    // `width` is set to the number of columns the prefix takes
+    static std::string_view truncate(std::string_view text, int maxWidth, int& width);
+    static std::string_view truncate(std::string_view text, int maxWidth);
+};
@@ -0,0 +1,286 @@
+#include "DuplicateFinder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Blake3.hpp"
+#include "Checksum.hpp"
+
+namespace {
+    struct File {
+        std::string path;
+        uint64_t size{};
+        // the digest of the latest stage the file went through
+        std::string digest;
+        dev_t device{};
+        ino_t inode{};
+        timespec modificationTime{};
+    };
+
+    timespec getModificationTime(const struct stat& status) {
+#ifdef __APPLE__
+        return status.st_mtimespec;
+#else
+        return status.st_mtim;
+#endif
+    }
+
+    // state shared by the tasks listing a tree
+    struct WalkState {
+        ThreadPool& pool;
+        OperationProgress& progress;
+
+        std::mutex mutex;
+        std::vector<File> files;
+        // device and inode of every file found, hard links to a file are only listed once
+        std::unordered_set<std::string> inodes;
+    };
+
+    void walkDirectory(WalkState& state, const std::string& path) {
+        if (state.progress.cancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const int descriptor = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        DIR* stream = descriptor >= 0 ? fdopendir(descriptor) : nullptr;
+        if (stream == nullptr) {
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+            state.progress.addError("Failed to open " + path + ": " + std::strerror(errno));
+            return;
+        }
+
+        std::vector<std::pair<File, std::string>> files;
+        while (const dirent* child = readdir(stream)) {
+            const std::string_view name = child->d_name;
+            if (name == "." or name == "..") {
+                continue;
+            }
+
+            // symlinks aren't followed, the files they point to are found where they are
+            struct stat status{};
+            if (fstatat(descriptor, child->d_name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            std::string childPath = path + (path.back() == '/' ? "" : "/") + child->d_name;
+
+            if (S_ISDIR(status.st_mode)) {
+                state.pool.submit([&state, childPath = std::move(childPath)] {
+                    walkDirectory(state, childPath);
+                });
+            } else if (S_ISREG(status.st_mode) and status.st_size > 0) {
+                files.emplace_back(File{std::move(childPath), static_cast<uint64_t>(status.st_size), {},
+                                        status.st_dev, status.st_ino, getModificationTime(status)},
+                                   std::to_string(status.st_dev) + ":" + std::to_string(status.st_ino));
+            }
+        }
+        closedir(stream);
+
+        state.progress.items.fetch_add(files.size(), std::memory_order_relaxed);
+
+        std::lock_guard lock(state.mutex);
+        for (auto& [file, inode] : files) {
+            if (state.inodes.insert(std::move(inode)).second) {
+                state.files.push_back(std::move(file));
+            }
+        }
+    }
+
+    // hashes the first and last `sampleSize` bytes, which is the whole file for small files
+    std::string hashSamples(const File& file, OperationProgress& progress) {
+        const int descriptor = open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0) {
+            throw fs::filesystem_error("Failed to open", file.path, std::error_code(errno, std::generic_category()));
+        }
+
+        thread_local std::vector<unsigned char> buffer(2 * DuplicateFinder::sampleSize);
+
+        const uint64_t sampledSize = std::min(file.size, 2 * DuplicateFinder::sampleSize);
+        const uint64_t headSize = std::min(file.size, DuplicateFinder::sampleSize);
+        const ssize_t headRead = pread(descriptor, buffer.data(), headSize, 0);
+        const ssize_t tailRead = pread(descriptor, buffer.data() + headSize, sampledSize - headSize,
+                                       static_cast<off_t>(file.size - (sampledSize - headSize)));
+        const int error = errno;
+        close(descriptor);
+
+        if (headRead != static_cast<ssize_t>(headSize) or tailRead != static_cast<ssize_t>(sampledSize - headSize)) {
+            throw fs::filesystem_error("Failed to read", file.path, std::error_code(error, std::generic_category()));
+        }
+        progress.bytes.fetch_add(sampledSize, std::memory_order_relaxed);
+
+        const Blake3::Digest digest = Blake3::hash(buffer.data(), sampledSize);
+        return std::string(digest.begin(), digest.end());
+    }
+
+    // runs `stage` on every file in parallel, dropping the files it fails on
+    template <typename Stage>
+    void runStage(std::vector<File>& files, ThreadPool& pool, OperationProgress& progress, const Stage& stage) {
+        progress.items.store(0);
+        progress.totalItems.store(files.size());
+
+        std::vector<bool> failed(files.size());
+        std::mutex failedMutex;
+
+        for (size_t i = 0; i < files.size(); ++i) {
+            pool.submit([&, i] {
+                if (progress.cancelled.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                try {
+                    files[i].digest = stage(files[i]);
+                    progress.items.fetch_add(1, std::memory_order_relaxed);
+                } catch (const fs::filesystem_error& error) {
+                    progress.addError(error.what());
+                    std::lock_guard lock(failedMutex);
+                    failed[i] = true;
+                }
+            });
+        }
+        pool.wait();
+
+        // remove the failed files in place, keeping the order of the others
+        size_t kept = 0;
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (failed[i]) {
+                continue;
+            }
+            if (kept != i) {
+                files[kept] = std::move(files[i]);
+            }
+            ++kept;
+        }
+        files.resize(kept);
+    }
+
+    // keeps the files sharing their size and digest with another file, grouped together
+    std::vector<std::vector<File>> groupFiles(std::vector<File>& files) {
+        std::unordered_map<std::string, std::vector<File>> buckets;
+        for (File& file : files) {
+            buckets[std::to_string(file.size) + ":" + file.digest].push_back(std::move(file));
+        }
+        files.clear();
+
+        std::vector<std::vector<File>> groups;
+        for (auto& [key, bucket] : buckets) {
+            if (bucket.size() > 1) {
+                groups.push_back(std::move(bucket));
+            }
+        }
+        return groups;
+    }
+
+    void flatten(std::vector<std::vector<File>>& groups, std::vector<File>& files) {
+        for (std::vector<File>& group : groups) {
+            std::move(group.begin(), group.end(), std::back_inserter(files));
+        }
+        groups.clear();
+    }
+}
+
+std::vector<DuplicateGroup> DuplicateFinder::find(const fs::path& root, ThreadPool& pool,
+                                                  OperationProgress& progress) {
+    // list every file in parallel, a task per directory
+    WalkState state{pool, progress, {}, {}, {}};
+    walkDirectory(state, root.string());
+    pool.wait();
+
+    // only files sharing their size can be duplicates
+    std::vector<File> candidates;
+    std::vector<std::vector<File>> groups = groupFiles(state.files);
+    flatten(groups, candidates);
+
+    // tell files apart by their samples, small files are hashed completely by this stage
+    runStage(candidates, pool, progress, [&](const File& file) {
+        return hashSamples(file, progress);
+    });
+    groups = groupFiles(candidates);
+
+    std::vector<DuplicateGroup> duplicates;
+    for (std::vector<File>& group : groups) {
+        if (group.front().size <= 2 * sampleSize) {
+            DuplicateGroup duplicate{group.front().size, {}};
+            for (File& file : group) {
+                duplicate.files.push_back({std::move(file.path), file.device, file.inode, file.modificationTime});
+            }
+            duplicates.push_back(std::move(duplicate));
+        } else {
+            std::move(group.begin(), group.end(), std::back_inserter(candidates));
+        }
+    }
+
+    // hash the rest completely
+    uint64_t totalBytes = 0;
+    for (const File& file : candidates) {
+        totalBytes += file.size;
+    }
+    progress.bytes.store(0);
+    progress.totalBytes.store(totalBytes);
+
+    runStage(candidates, pool, progress, [&](const File& file) {
+        return Checksum::computeFile(file.path, ChecksumAlgorithm::Blake3, progress);
+    });
+
+    for (std::vector<File>& group : groupFiles(candidates)) {
+        DuplicateGroup duplicate{group.front().size, {}};
+        for (File& file : group) {
+            duplicate.files.push_back({std::move(file.path), file.device, file.inode, file.modificationTime});
+        }
+        duplicates.push_back(std::move(duplicate));
+    }
+
+    for (DuplicateGroup& duplicate : duplicates) {
+        std::sort(duplicate.files.begin(), duplicate.files.end(),
+                  [](const DuplicateFile& first, const DuplicateFile& second) {
+                      return first.path < second.path;
+                  });
+    }
+
+    // the groups wasting the most space first
+    std::sort(duplicates.begin(), duplicates.end(), [](const DuplicateGroup& first, const DuplicateGroup& second) {
+        const uint64_t firstWasted = first.size * (first.files.size() - 1);
+        const uint64_t secondWasted = second.size * (second.files.size() - 1);
+        return firstWasted != secondWasted ? firstWasted > secondWasted
+                                           : first.files.front().path < second.files.front().path;
+    });
+
+    return duplicates;
+}
+
+bool DuplicateFinder::isUnchanged(const DuplicateFile& file, const uint64_t size) {
+    struct stat status{};
+    if (lstat(file.path.c_str(), &status) != 0) {
+        return false;
+    }
+
+    const timespec modificationTime = getModificationTime(status);
+    return S_ISREG(status.st_mode) and static_cast<uint64_t>(status.st_size) == size and
+           status.st_dev == file.device and status.st_ino == file.inode and
+           modificationTime.tv_sec == file.modificationTime.tv_sec and
+           modificationTime.tv_nsec == file.modificationTime.tv_nsec;
+}
+
+void DuplicateFinder::replaceWithHardLink(const fs::path& source, const fs::path& target) {
+    // link next to the target first and rename it over the target, so the target is never missing
+    const fs::path temporaryPath = target.parent_path() / ("." + target.filename().string() + ".BFileX-link");
+
+    if (link(source.c_str(), temporaryPath.c_str()) != 0) {
+        throw fs::filesystem_error("Failed to link", source, temporaryPath,
+                                   std::error_code(errno, std::generic_category()));
+    }
+
+    if (rename(temporaryPath.c_str(), target.c_str()) != 0) {
+        const int error = errno;
+        unlink(temporaryPath.c_str());
+        throw fs::filesystem_error("Failed to replace", target, std::error_code(error, std::generic_category()));
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <ctime>
+#include <filesystem>
+#include <vector>
+#include <sys/types.h>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+// a file of a duplicate group, with what it was when it was found
+struct DuplicateFile {
+    fs::path path;
+    dev_t device{};
+    ino_t inode{};
+    timespec modificationTime{};
+};
+
+// files with the same contents
+struct DuplicateGroup {
+    uint64_t size{};
+    std::vector<DuplicateFile> files; // in path order
+};
+
+// finds duplicate files under a directory with a pipeline that reads as little as possible:
+// files are bucketed by size, files sharing a size are told apart by hashing their first and last
+// `sampleSize` bytes, and only the files whose samples still match are hashed completely
+// every stage runs in parallel on the pool, hard links to the same file only count once
+class DuplicateFinder {
+public:
+    // bytes hashed at each end of a file before hashing all of it
+    static constexpr uint64_t sampleSize = 64 * 1024;
+
+    // returns the groups of duplicates under `root`, the ones wasting the most space first
+    static std::vector<DuplicateGroup> find(const fs::path& root, ThreadPool& pool, OperationProgress& progress);
+
+    // whether the file is still the one found with the given size, with the same inode and modification time
+    // checked before a file is deleted or linked, a file changed since it was found may not be a duplicate
+    static bool isUnchanged(const DuplicateFile& file, uint64_t size);
+
+    // replaces `target` with a hard link to `source`, throws `fs::filesystem_error` on failure
+    static void replaceWithHardLink(const fs::path& source, const fs::path& target);
+};
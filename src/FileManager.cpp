@@ -1,7 +1,10 @@
 #include "FileManager.hpp"
 #include <algorithm>
 #include <filesystem>
+#include <numeric>
 #include "FileProperties.hpp"
+#include "ListingCache.hpp"
+#include "Trace.hpp"
 
 bool FileManager::applyReverse(const bool condition, const bool reverse) {
     if (reverse)
@@ -20,25 +23,24 @@ bool FileManager::lexicographicalCompare(const std::string& first, const std::st
     );
 }
 
+bool FileManager::matchesSearchQuery(const std::string& name, const std::string& searchQuery) {
+    return std::search(name.begin(), name.end(), searchQuery.begin(), searchQuery.end(),
+                       [](char a, char b) {
+                           return std::tolower(a) == std::tolower(b);
+                       }) != name.end();
+}
+
 std::vector<fs::directory_entry> FileManager::searchEntries(const std::string& searchQuery,
                                                             const std::vector<fs::directory_entry>& entries) {
-    std::vector<fs::directory_entry> results;
-
-    for (const auto& entry : entries) {
-        std::string name = entry.path().filename().string();
-
-        const bool found = std::search(name.begin(), name.end(), searchQuery.begin(), searchQuery.end(),
-                                       [](char a, char b) {
-                                           return std::tolower(a) == std::tolower(b);
-                                       }) != name.end();
+    // keep the previous directory `..` at the top
+    std::vector<fs::directory_entry> results{entries.front()};
 
-        if (found) {
-            results.emplace_back(entry);
+    for (auto entry = entries.begin() + 1; entry != entries.end(); ++entry) {
+        if (matchesSearchQuery(entry->path().filename().string(), searchQuery)) {
+            results.emplace_back(*entry);
         }
     }
 
-    results.emplace_back(fs::path(".."));
-
     return results;
 }
 
@@ -50,31 +52,117 @@ void FileManager::setEntries(
     const SortType sortType,
     const bool reverse
 ) {
-    entries.clear(); // clear previous entries
+    const Trace::Span span("setEntries");
 
     try {
-        entries.emplace_back(".."); // add the previous directory `..` at the top
+        // the listing is shared with every tab and column that shows the same directory,
+        // and only sorted again when it changed or they don't sort it the same way
+        const std::vector<fs::directory_entry>& sortedEntries =
+                ListingCache::getInstance().getSortedEntries(rootPath, showHidden, sortType, reverse);
 
-        for (const auto& item : fs::directory_iterator{rootPath}) {
-            // only add the item if it's not hidden or hidden files are allowed
-            if (showHidden or not FileProperties::Utilities::isHidden(item)) {
-                entries.push_back(item);
-            }
+        // filtering keeps the sort order
+        entries = searchQuery.empty() ? sortedEntries : searchEntries(searchQuery, sortedEntries);
+    } catch (const fs::filesystem_error&) {
+        entries.clear();
+        entries.emplace_back("Permission denied!");
+    }
+}
+
+EntryMetadata FileManager::readMetadata(const fs::directory_entry& entry) {
+    EntryMetadata metadata;
+    std::error_code error;
+
+    if (const fs::file_time_type time = entry.last_write_time(error); not error) {
+        metadata.modificationTime = time;
+    }
+    if (entry.is_regular_file(error)) {
+        metadata.size = entry.file_size(error);
+        if (error) {
+            metadata.size = 0;
         }
+    }
+    return metadata;
+}
+
+bool FileManager::compareEntries(
+    const fs::directory_entry& first,
+    const fs::directory_entry& second,
+    const SortType sortType,
+    const bool showHidden,
+    const bool reverse
+) {
+    if (sortType == SortType::Time or sortType == SortType::Size) {
+        return compareEntries(first, readMetadata(first), second, readMetadata(second), sortType, showHidden,
+                              reverse);
+    }
+    return compareEntries(first, {}, second, {}, sortType, showHidden, reverse);
+}
+
+bool FileManager::compareEntries(
+    const fs::directory_entry& first,
+    const EntryMetadata& firstMetadata,
+    const fs::directory_entry& second,
+    const EntryMetadata& secondMetadata,
+    const SortType sortType,
+    const bool showHidden,
+    const bool reverse
+) {
+    // rank the previous directory ".." at the top
+    if (first.path().filename() == "..") {
+        return true;
+    }
+    if (second.path().filename() == "..") {
+        return false;
+    }
 
-        // if there exists a search query
-        if (not searchQuery.empty()) {
-            // filter out entries based on search results
-            entries = searchEntries(searchQuery, entries);
+    if (sortType == SortType::Normal) {
+        // rank hidden files higher if shown
+        if (showHidden) {
+            const bool firstIsHidden = FileProperties::Utilities::isHidden(first);
+            const bool secondIsHidden = FileProperties::Utilities::isHidden(second);
+
+            if (firstIsHidden != secondIsHidden) {
+                return applyReverse(firstIsHidden, reverse);
+            }
         }
 
-        // sort the entries according to the sort type
-        if (sortType != SortType::None) {
-            sortEntries(entries, sortType, showHidden, reverse);
+        // rank directories higher
+        const bool firstIsDir = first.is_directory();
+        const bool secondIsDir = second.is_directory();
+
+        if (firstIsDir != secondIsDir) {
+            return applyReverse(firstIsDir, reverse);
         }
-    } catch (const fs::filesystem_error&) {
-        entries.clear();
-        entries.emplace_back("Permission denied!");
+
+        // rank based on the lexicogrphical file name comaparision
+        return applyReverse(lexicographicalCompare(first.path().string(), second.path().string()), reverse);
+    } else if (sortType == SortType::Time) {
+        // rank latest modified higher
+        return applyReverse(firstMetadata.modificationTime > secondMetadata.modificationTime, reverse);
+    } else if (sortType == SortType::Size) {
+        constexpr int directorySize = 4 * 1024; // used as a default size for directories
+        try {
+            const bool firstIsRegularFile = first.is_regular_file();
+            const bool secondIsRegularFile = second.is_regular_file();
+
+            // compare regurlar files' sizes directly
+            if (firstIsRegularFile and secondIsRegularFile) {
+                return applyReverse(firstMetadata.size > secondMetadata.size, reverse);
+            } // use `directorySize` as a size for all directories
+            else if (firstIsRegularFile and second.is_directory()) {
+                return applyReverse(firstMetadata.size > directorySize, reverse);
+            } else if (first.is_directory() and secondIsRegularFile) {
+                return applyReverse(directorySize > secondMetadata.size, reverse);
+            } else { // if they have the same size or are both directories sort lexicographically
+                return applyReverse(
+                    lexicographicalCompare(first.path().string(), second.path().string()),
+                    reverse
+                );
+            }
+        } catch (...) {} // fallback in case of exceptions
+        return applyReverse(first.is_regular_file(), reverse);
+    } else {
+        return lexicographicalCompare(first.path().string(), second.path().string());
     }
 }
 
@@ -84,70 +172,125 @@ void FileManager::sortEntries(
     const bool showHidden,
     const bool reverse
 ) {
+    const Trace::Span span("sortEntries");
+
+    if (sortType == SortType::Time or sortType == SortType::Size) {
+        // the sizes and times are read once per entry, or not at all if another tab sorted the directory
+        std::vector<EntryMetadata> metadata = ListingCache::getInstance().getMetadata(entries);
+        sortEntries(entries, metadata, sortType, showHidden, reverse);
+        return;
+    }
+
     std::sort(
         entries.begin(), entries.end(),
         [&](const fs::directory_entry& first, const fs::directory_entry& second) {
-            // rank the previous directory ".." at the top
-            if (first.path().filename() == "..") {
-                return true;
+            return compareEntries(first, second, sortType, showHidden, reverse);
+        });
+}
+
+void FileManager::sortEntries(
+    std::vector<fs::directory_entry>& entries,
+    std::vector<EntryMetadata>& metadata,
+    const SortType sortType,
+    const bool showHidden,
+    const bool reverse
+) {
+    // sort the indices and move the entries once
+    std::vector<size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const size_t first, const size_t second) {
+        return compareEntries(entries[first], metadata[first], entries[second], metadata[second], sortType,
+                              showHidden, reverse);
+    });
+
+    std::vector<fs::directory_entry> sortedEntries;
+    std::vector<EntryMetadata> sortedMetadata;
+    sortedEntries.reserve(entries.size());
+    sortedMetadata.reserve(entries.size());
+    for (const size_t index : order) {
+        sortedEntries.push_back(std::move(entries[index]));
+        sortedMetadata.push_back(metadata[index]);
+    }
+    entries = std::move(sortedEntries);
+    metadata = std::move(sortedMetadata);
+}
+
+DirectoryPage FileManager::getDirectoryPage(
+    const fs::path& rootPath,
+    const std::string& searchQuery,
+    const bool showHidden,
+    const SortType sortType,
+    const bool reverse,
+    const size_t maxEntries,
+    const size_t maxRead
+) {
+    DirectoryPage page;
+    std::vector<fs::directory_entry>& entries = page.entries;
+
+    try {
+        entries.emplace_back(rootPath / ".."); // add the previous directory `..` at the top
+
+        size_t read{};
+        for (const auto& item : fs::directory_iterator{rootPath}) {
+            // stop after a bounded batch, the rest of the directory isn't read
+            if (read++ == maxRead) {
+                page.complete = false;
+                break;
             }
-            if (second.path().filename() == "..") {
-                return false;
+
+            if ((showHidden or not FileProperties::Utilities::isHidden(item)) and
+                (searchQuery.empty() or matchesSearchQuery(item.path().filename().string(), searchQuery))) {
+                entries.push_back(item);
             }
+        }
 
-            if (sortType == SortType::Normal) {
-                // rank hidden files higher if shown
-                if (showHidden) {
-                    const bool firstIsHidden = FileProperties::Utilities::isHidden(first);
-                    const bool secondIsHidden = FileProperties::Utilities::isHidden(second);
+        // only order the entries that are kept, `..` stays at the top
+        const size_t kept = std::min(entries.size(), std::max<size_t>(maxEntries, 1));
 
-                    if (firstIsHidden != secondIsHidden) {
-                        return applyReverse(firstIsHidden, reverse);
-                    }
-                }
+        page.remaining = entries.size() - kept;
 
-                // rank directories higher
-                const bool firstIsDir = first.is_directory();
-                const bool secondIsDir = second.is_directory();
+        if (sortType == SortType::Time or sortType == SortType::Size) {
+            // read the sizes and times once per entry instead of on every comparison
+            std::vector<EntryMetadata> metadata;
+            metadata.reserve(entries.size());
+            for (const auto& entry : entries) {
+                metadata.push_back(readMetadata(entry));
+            }
 
-                if (firstIsDir != secondIsDir) {
-                    return applyReverse(firstIsDir, reverse);
-                }
+            std::vector<size_t> order(entries.size() - 1);
+            std::iota(order.begin(), order.end(), 1);
+            std::partial_sort(
+                order.begin(), order.begin() + static_cast<std::ptrdiff_t>(kept - 1), order.end(),
+                [&](const size_t first, const size_t second) {
+                    return compareEntries(entries[first], metadata[first], entries[second], metadata[second],
+                                          sortType, showHidden, reverse);
+                });
 
-                // rank based on the lexicogrphical file name comaparision
-                return applyReverse(lexicographicalCompare(first.path().string(), second.path().string()), reverse);
-            } else if (sortType == SortType::Time) {
-                // rank latest modified higher
-                return applyReverse(
-                    fs::last_write_time(first.path()) > fs::last_write_time(second.path()),
-                    reverse
-                );
-            } else if (sortType == SortType::Size) {
-                constexpr int directorySize = 4 * 1024; // used as a default size for directories
-                try {
-                    const bool firstIsRegularFile = first.is_regular_file();
-                    const bool secondIsRegularFile = second.is_regular_file();
-
-                    // compare regurlar files' sizes directly
-                    if (firstIsRegularFile and secondIsRegularFile) {
-                        return applyReverse(fs::file_size(first.path()) > fs::file_size(second.path()), reverse);
-                    } // use `directorySize` as a size for all directories
-                    else if (firstIsRegularFile and second.is_directory()) {
-                        return applyReverse(fs::file_size(first.path()) > directorySize, reverse);
-                    } else if (first.is_directory() and secondIsRegularFile) {
-                        return applyReverse(directorySize > fs::file_size(second.path()), reverse);
-                    } else { // if they have the same size or are both directories sort lexicographically
-                        return applyReverse(
-                            lexicographicalCompare(first.path().string(), second.path().string()),
-                            reverse
-                        );
-                    }
-                } catch (...) {} // fallback in case of exceptions
-                return applyReverse(first.is_regular_file(), reverse);
-            } else {
-                return lexicographicalCompare(first.path().string(), second.path().string());
+            std::vector<fs::directory_entry> keptEntries{std::move(entries.front())};
+            keptEntries.reserve(kept);
+            for (size_t i = 0; i + 1 < kept; ++i) {
+                keptEntries.push_back(std::move(entries[order[i]]));
             }
-        });
+            entries = std::move(keptEntries);
+        } else {
+            if (sortType != SortType::None) {
+                std::partial_sort(
+                    entries.begin() + 1, entries.begin() + static_cast<std::ptrdiff_t>(kept), entries.end(),
+                    [&](const fs::directory_entry& first, const fs::directory_entry& second) {
+                        return compareEntries(first, second, sortType, showHidden, reverse);
+                    });
+            }
+
+            entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(kept), entries.end());
+        }
+    } catch (const fs::filesystem_error&) {
+        entries.clear();
+        entries.emplace_back("Permission denied!");
+        page.remaining = 0;
+        page.complete = true;
+    }
+
+    return page;
 }
 
 void FileManager::openFile(const fs::path& filePath) {
@@ -171,16 +314,67 @@ void FileManager::openFileInEditor(const fs::path& filePath) {
     std::system((std::string{editor} + " \'" + filePath.string() + "\'").c_str());
 }
 
-int FileManager::getIndex(const fs::path& target, const std::vector<fs::directory_entry>& entries) {
-    int index{};
+bool FileManager::isListed(const fs::directory_entry& entry, const std::string& searchQuery, const bool showHidden) {
+    return (showHidden or not FileProperties::Utilities::isHidden(entry)) and
+           (searchQuery.empty() or matchesSearchQuery(entry.path().filename().string(), searchQuery));
+}
+
+size_t FileManager::getInsertionIndex(
+    const fs::directory_entry& entry,
+    const std::vector<fs::directory_entry>& entries,
+    const SortType sortType,
+    const bool showHidden,
+    const bool reverse
+) {
+    // unsorted entries keep the directory order, new entries go last
+    if (sortType == SortType::None) {
+        return entries.size();
+    }
+
+    // `..` is always ranked first so it doesn't need to be skipped
+    const auto position = std::upper_bound(
+        entries.begin(), entries.end(), entry,
+        [&](const fs::directory_entry& first, const fs::directory_entry& second) {
+            return compareEntries(first, second, sortType, showHidden, reverse);
+        });
 
-    // iterate over the entries and find the matching path
-    for (const auto& entry : entries) {
-        if (entry.path() == target)
-            return index; // return the index if found
-        ++index;
+    return static_cast<size_t>(position - entries.begin());
+}
+
+std::optional<size_t> FileManager::findSortedIndex(
+    const fs::directory_entry& target,
+    const std::vector<fs::directory_entry>& entries,
+    const SortType sortType,
+    const bool showHidden,
+    const bool reverse
+) {
+    if (sortType != SortType::None) {
+        try {
+            auto position = std::lower_bound(
+                entries.begin(), entries.end(), target,
+                [&](const fs::directory_entry& first, const fs::directory_entry& second) {
+                    return compareEntries(first, second, sortType, showHidden, reverse);
+                });
+
+            // entries ranked the same as the target, e.g. modified at the same time
+            for (; position != entries.end() and
+                   not compareEntries(target, *position, sortType, showHidden, reverse); ++position) {
+                if (position->path() == target.path()) {
+                    return static_cast<size_t>(position - entries.begin());
+                }
+            }
+
+            // not listed, like a new entry
+            return std::nullopt;
+        } catch (const fs::filesystem_error&) {} // an entry was removed since the entries were sorted
+    }
+
+    // the entries are unsorted, or an entry can't be compared anymore
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].path() == target.path()) {
+            return i;
+        }
     }
 
-    //  return 0 if not found
-    return 0;
+    return std::nullopt;
 }
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -12,6 +14,19 @@ enum class SortType {
     Size,   // sort entries by size on disk
 };
 
+// the first entries of a directory in sort order, read with a bounded budget
+struct DirectoryPage {
+    std::vector<fs::directory_entry> entries; // first entries in sort order, starting with `..`
+    size_t remaining{};                       // number of entries read but not included
+    bool complete{true};                      // false if reading stopped before the end of the directory
+};
+
+// what sorting by time and by size compares, read once per entry instead of on every comparison
+struct EntryMetadata {
+    fs::file_time_type modificationTime{fs::file_time_type::min()}; // the oldest time if it can't be read
+    uintmax_t size{};                                                // of regular files
+};
+
 class FileManager {
     // reverses the given boolean condition based on the reverse flag
     // returns the opposite of the condition if `reverse` is true
@@ -21,6 +36,39 @@ class FileManager {
     // case-insensitive lexicographical comparison
     static bool lexicographicalCompare(const std::string& first, const std::string& second);
 
+    // returns true if the name contains the search query, ignoring case
+    static bool matchesSearchQuery(const std::string& name, const std::string& searchQuery);
+
+    // returns true if `first` is ordered before `second` for the given sort options
+    // reads the metadata of both entries when sorting by time or size
+    static bool compareEntries(
+        const fs::directory_entry& first,
+        const fs::directory_entry& second,
+        SortType sortType,
+        bool showHidden,
+        bool reverse
+    );
+
+    // same as above with the metadata of both entries already read
+    static bool compareEntries(
+        const fs::directory_entry& first,
+        const EntryMetadata& firstMetadata,
+        const fs::directory_entry& second,
+        const EntryMetadata& secondMetadata,
+        SortType sortType,
+        bool showHidden,
+        bool reverse
+    );
+
+    // sorts the entries by the metadata given for each of them, keeping both vectors in step
+    static void sortEntries(
+        std::vector<fs::directory_entry>& entries,
+        std::vector<EntryMetadata>& metadata,
+        SortType sortType,
+        bool showHidden,
+        bool reverse
+    );
+
     // filters entries based on the search query and returns the new vector
     static std::vector<fs::directory_entry> searchEntries(const std::string& searchQuery,
                                                           const std::vector<fs::directory_entry>& entries);
@@ -28,6 +76,7 @@ class FileManager {
 public:
     // populates the entries vector with directory entries from the given path, with sorting options
     // including flags for showing hidden files and reversing the order
+    // the directory is read and sorted through the `ListingCache`, so only from the input thread
     static void setEntries(
         const fs::path& rootPath,
         std::vector<fs::directory_entry>& entries,
@@ -37,7 +86,20 @@ public:
         bool reverse
     );
 
+    // reads at most `maxRead` entries from the given path and keeps the first `maxEntries` in sort order
+    // used to preview directories, where only the first rows are shown no matter how large the directory is
+    static DirectoryPage getDirectoryPage(
+        const fs::path& rootPath,
+        const std::string& searchQuery,
+        bool showHidden,
+        SortType sortType,
+        bool reverse,
+        size_t maxEntries,
+        size_t maxRead
+    );
+
     // sorts the given entries vector according to the specified sort type
+    // the sizes and times are taken from the `ListingCache`, so only from the input thread
     static void sortEntries(
         std::vector<fs::directory_entry>& entries,
         SortType sortType,
@@ -53,6 +115,29 @@ public:
     // falls back to using `openFile()`
     // assumes the file is a text file
     static void openFileInEditor(const fs::path& filePath);
-    // returns the index of a path in a given vector of entries
-    static int getIndex(const fs::path& target, const std::vector<fs::directory_entry>& entries);
+    // reads the size and modification time of an entry, following symlinks
+    static EntryMetadata readMetadata(const fs::directory_entry& entry);
+    // returns true if the entry is listed with the given search query and hidden entries option
+    static bool isListed(const fs::directory_entry& entry, const std::string& searchQuery, bool showHidden);
+
+    // returns the index to insert an entry at to keep entries sorted with the given options,
+    // found with a binary search
+    static size_t getInsertionIndex(
+        const fs::directory_entry& entry,
+        const std::vector<fs::directory_entry>& entries,
+        SortType sortType,
+        bool showHidden,
+        bool reverse
+    );
+
+    // returns the index of an entry in entries sorted with the given options, found with a binary search
+    // falls back to a linear search if the entries are unsorted, or if an entry was removed since they were sorted.
+    // an entry whose time or size changed since the entries were sorted by it may not be found
+    static std::optional<size_t> findSortedIndex(
+        const fs::directory_entry& target,
+        const std::vector<fs::directory_entry>& entries,
+        SortType sortType,
+        bool showHidden,
+        bool reverse
+    );
 };
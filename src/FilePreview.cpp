@@ -1,24 +1,209 @@
 #include "FilePreview.hpp"
-#include <fstream>
+#include "DisplayWidth.hpp"
+#include "FileProperties.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+void FilePreview::addLine(const std::string_view line) {
+    int width;
+    lines.emplace_back(DisplayWidth::truncate(line, maxLineWidth, width));
+    lineWidths.push_back(width);
+}
 
 void FilePreview::readFile(const std::string& path) {
     lines.clear(); // clear previous file
+    lineWidths.clear();
+    lineTokens.clear();
 
-    std::ifstream file(path);
-    if (not file.is_open()) {
+    // read upto `maxLines` from the file within the reader's byte budget
+    if (not reader.read(path, topOffset, std::max(maxLines, 0))) {
         // display an error message on failure
-        lines.emplace_back(("Failed to open file: " + path).substr(0, maxLineWidth));
+        errorMessage = "Failed to open file: " + path;
+        addLine(errorMessage);
+        return;
+    }
+
+    // trimming lines that exceed `maxLineWidth`
+    for (const std::string_view line : reader.getLines()) {
+        addLine(line);
+    }
+
+    // lex the full lines so constructs past the trimmed part still carry over to the next lines
+    if (highlighter.setFile(path, FileProperties::Types::determineFileType(path))) {
+        highlighter.highlight(reader.getLines(), highlighter.getStateAt(reader.getStartOffset()), lineTokens);
+    }
+}
+
+void FilePreview::readBinaryFile(const std::string& path) {
+    lines.clear();
+    lineWidths.clear();
+    lineTokens.clear();
+
+    const auto rows = static_cast<size_t>(std::max(maxLines, 0));
+    if (not hexPreview.read(path, topOffset, rows * bytesPerRow)) {
+        errorMessage = "Failed to open file: " + path;
+        addLine(errorMessage);
+    }
+}
+
+void FilePreview::readArchive(const std::string& path) {
+    lines.clear();
+    lineWidths.clear();
+
+    // the listing doesn't change while the same archive is shown
+    if (archiveLines.empty() or archiveListedLines < maxLines) {
+        archiveLines.clear();
+        lineTokens.clear();
+        archiveListedLines = maxLines;
+
+        // one row for the summary and one for the members that don't fit
+        const auto maxMembers = static_cast<size_t>(std::max(maxLines - 2, 0));
+        const ArchiveListing listing = ArchivePreview::list(path, maxMembers);
+
+        // the format is unknown if the archive couldn't be recognized
+        if (not listing.format.empty()) {
+            std::string summary = listing.format + " archive";
+            if (listing.memberCount.has_value()) {
+                summary += ", " + std::to_string(*listing.memberCount) + " members";
+            }
+            archiveLines.push_back(std::move(summary));
+            lineTokens.push_back({{0, static_cast<uint32_t>(archiveLines.back().size()), TokenType::Heading}});
+        }
+
+        for (const auto& [name, size, isDirectory] : listing.members) {
+            // sizes are right aligned in a fixed width column before the name
+            std::string sizeText = isDirectory ? "-" : FileProperties::MetaData::formatSize(size);
+            constexpr size_t sizeWidth = 9;
+            if (sizeText.size() < sizeWidth) {
+                sizeText.insert(0, sizeWidth - sizeText.size(), ' ');
+            }
+
+            const auto nameBegin = static_cast<uint32_t>(sizeText.size() + 2);
+            archiveLines.push_back(sizeText + "  " + name);
+            lineTokens.push_back({
+                {0, static_cast<uint32_t>(sizeText.size()), TokenType::Number},
+                {nameBegin, static_cast<uint32_t>(name.size()), isDirectory ? TokenType::Heading : TokenType::Plain},
+            });
+        }
+
+        if (not listing.error.empty()) {
+            archiveLines.push_back(listing.error);
+            lineTokens.emplace_back();
+        } else if (listing.hasMore) {
+            archiveLines.push_back(
+                listing.memberCount.has_value()
+                    ? "... " + std::to_string(*listing.memberCount - listing.members.size()) + " more"
+                    : std::string{"... more members not shown"});
+            lineTokens.emplace_back();
+        }
+    }
+
+    for (const std::string& line : archiveLines) {
+        addLine(line);
+    }
+}
+
+void FilePreview::readImage(const std::string& path) {
+    lines.clear();
+    lineWidths.clear();
+    lineTokens.clear();
+
+    const auto [width, height] = getThumbnailSize();
+    if (not imagePreview.load(path, width, height)) {
+        errorMessage = "Failed to decode image: " + path;
+        addLine(errorMessage);
+    }
+}
+
+int FilePreview::printImageRow(const int row) {
+    const int width = ImagePreview::formatRow(imagePreview.getThumbnail(), row, imageRow);
+    Printer().print(imageRow);
+    return width;
+}
+
+int FilePreview::printHexRow(const size_t index) {
+    hexPreview.formatRow(index * bytesPerRow, bytesPerRow, offsetDigits, hexOffset, hexBytes, hexAscii);
+
+    Printer(Color::Yellow).print(hexOffset);
+    Printer().print("  ", hexBytes);
+    Printer(Color::Cyan).print(hexAscii);
+
+    return static_cast<int>(hexOffset.size() + 2 + hexBytes.size() + hexAscii.size());
+}
+
+void FilePreview::printLine(const size_t index) const {
+    const std::string_view line = lines[index];
+
+    if (index >= lineTokens.size()) {
+        Printer().print(line);
+        return;
+    }
+
+    size_t position{};
+    for (const auto& [begin, length, type] : lineTokens[index]) {
+        // the rest of the tokens are past the trimmed part of the line
+        if (begin >= line.size()) {
+            break;
+        }
+
+        // plain text between tokens
+        if (begin > position) {
+            Printer().print(line.substr(position, begin - position));
+        }
+
+        const auto color = tokenColorMap.find(type);
+        const std::string_view text = line.substr(begin, length);
+
+        if (color != tokenColorMap.end()) {
+            Printer(color->second).print(text);
+        } else {
+            Printer().print(text);
+        }
+
+        position = begin + text.size();
+    }
+
+    if (position < line.size()) {
+        Printer().print(line.substr(position));
+    }
+}
+
+void FilePreview::printScrollPosition() {
+    // resolve the line number once the index reaches the shown lines
+    if (not topLine.has_value() and lineIndex.getPath() == previewPath) {
+        topLine = lineIndex.getLineAt(topOffset);
+    }
+
+    // nothing to show until scrolling starts
+    if (topOffset == 0 and lineIndex.getPath() != previewPath) {
+        return;
+    }
+
+    if (isBinaryPreview) {
+        std::string offset, size;
+        HexPreview::toHex(topOffset, offsetDigits, offset);
+        HexPreview::toHex(hexPreview.getFileSize(), offsetDigits, size);
+
+        const std::string position = " " + offset + "/" + size + " ";
+        if (static_cast<int>(position.size()) < maxLineWidth) {
+            Cursor::moveTo(terminalWidth - static_cast<int>(position.size()) - 1, terminalHeight - 1);
+            Printer(Color::Yellow).print(position);
+        }
         return;
     }
 
-    std::string line;
-    // read upto `maxLines` from the file
-    for (int i = 0; getline(file, line) and i < maxLines; ++i) {
-        // trimming line if it exceeds `maxLineWidth`
-        if (line.size() > maxLineWidth)
-            line = line.substr(0, maxLineWidth);
+    std::string position = " " + (topLine.has_value() ? std::to_string(*topLine + 1) : std::string{"?"});
+    if (const auto lineCount = lineIndex.getLineCount(); lineCount.has_value() and lineIndex.getPath() == previewPath) {
+        position += "/" + std::to_string(*lineCount);
+    } else if (lineIndex.getPath() == previewPath) {
+        position += "/...";
+    }
+    position += " ";
 
-        lines.emplace_back(line); // store the extracted line
+    if (static_cast<int>(position.size()) < maxLineWidth) {
+        Cursor::moveTo(terminalWidth - static_cast<int>(position.size()) - 1, terminalHeight - 1);
+        Printer(Color::Yellow).print(position);
     }
 }
 
@@ -57,8 +242,36 @@ void FilePreview::resize(const int width, const int height) {
 void FilePreview::render(const std::string& filePath) {
     const int contentLength = terminalWidth - leftStartingPosition - 1;
 
-    // read the file content into the `lines` vector
-    readFile(filePath);
+    // start from the top when previewing a different file
+    if (filePath != previewPath) {
+        previewPath = filePath;
+        topOffset = 0;
+        topLine = 0;
+        pendingLine.reset();
+        archiveLines.clear();
+        const FileType fileType = FileProperties::Types::determineFileType(filePath);
+        isArchivePreview = fileType == FileType::Compressed;
+        isImagePreview = fileType == FileType::Image;
+        isBinaryPreview = not isArchivePreview and not isImagePreview and FileProperties::Utilities::isBinary(filePath);
+    }
+
+    // read the file content into the `lines` vector, or the bytes that fit in the preview for binary files
+    if (isArchivePreview) {
+        readArchive(filePath);
+    } else if (isImagePreview) {
+        readImage(filePath);
+    } else if (isBinaryPreview) {
+        struct stat status{};
+        offsetDigits = HexPreview::getOffsetDigits(stat(filePath.c_str(), &status) == 0 ? status.st_size : 0);
+        bytesPerRow = HexPreview::getBytesPerRow(maxLineWidth, offsetDigits);
+        readBinaryFile(filePath);
+    } else {
+        readFile(filePath);
+    }
+
+    const int binaryRows = static_cast<int>((hexPreview.getWindowSize() + bytesPerRow - 1) /
+                                            std::max<size_t>(bytesPerRow, 1));
+    const int imageRows = (imagePreview.getThumbnail().height + 1) / 2;
 
     Printer printer;
     // move to starting position of the preview
@@ -74,9 +287,22 @@ void FilePreview::render(const std::string& filePath) {
         // left vertical line
         printer.print(verticalLine);
 
-        // file content
-        if (i < lines.size())
-            printer.print(" ", lines[i]);
+        // file content, padded to overwrite what was previously shown
+        int contentWidth{};
+        if (isImagePreview and lines.empty() and i < imageRows) {
+            printer.print(" ");
+            contentWidth = 1 + printImageRow(i);
+        } else if (isBinaryPreview and lines.empty() and i < binaryRows) {
+            printer.print(" ");
+            contentWidth = 1 + printHexRow(i);
+        } else if (i < static_cast<int>(lines.size())) {
+            printer.print(" ");
+            printLine(i);
+            contentWidth = 1 + lineWidths[i];
+        }
+        if (contentWidth < contentLength) {
+            printer.print(std::string(contentLength - contentWidth, ' '));
+        }
 
         // right vertical line
         Cursor::moveTo(terminalWidth, topStartingPosition + i + 1);
@@ -88,6 +314,7 @@ void FilePreview::render(const std::string& filePath) {
 
     // bottom border
     printBorderLine(bottomLeftCorner, BottomRightCorner, contentLength);
+    printScrollPosition();
 }
 
 void FilePreview::clearPreview() const {
@@ -100,3 +327,175 @@ void FilePreview::clearPreview() const {
         printer.print(emptyString);
     }
 }
+
+void FilePreview::startScrolling() {
+    pendingLine.reset();
+
+    // archive listings and thumbnails only show what fits
+    if (isArchivePreview or isImagePreview) {
+        return;
+    }
+
+    // binary files are scrolled by byte offsets, they don't need the line index
+    if (not isBinaryPreview) {
+        lineIndex.build(previewPath);
+    }
+}
+
+void FilePreview::scrollBinary(const PreviewScroll command, const uint64_t offset) {
+    const uint64_t fileSize = hexPreview.getFileSize();
+    const uint64_t rowSize = std::max<size_t>(bytesPerRow, 1);
+    const uint64_t pageSize = rowSize * std::max(maxLines, 1);
+
+    // the furthest the preview scrolls is where the last row is at the bottom
+    const uint64_t lastRowOffset = fileSize > 0 ? (fileSize - 1) / rowSize * rowSize : 0;
+    const uint64_t lastPageOffset = lastRowOffset >= pageSize - rowSize ? lastRowOffset - (pageSize - rowSize) : 0;
+
+    switch (command) {
+        case PreviewScroll::LineDown:
+            topOffset = std::min(topOffset + rowSize, lastPageOffset);
+            break;
+        case PreviewScroll::PageDown:
+            topOffset = std::min(topOffset + pageSize, lastPageOffset);
+            break;
+        case PreviewScroll::LineUp:
+            topOffset -= std::min(topOffset, rowSize);
+            break;
+        case PreviewScroll::PageUp:
+            topOffset -= std::min(topOffset, pageSize);
+            break;
+        case PreviewScroll::Top:
+            topOffset = 0;
+            break;
+        case PreviewScroll::End:
+            topOffset = lastPageOffset;
+            break;
+        case PreviewScroll::GoToLine:
+            topOffset = std::min(offset * rowSize, lastPageOffset);
+            break;
+        case PreviewScroll::GoToOffset:
+            topOffset = std::min(offset / rowSize * rowSize, lastPageOffset);
+            break;
+    }
+}
+
+void FilePreview::scroll(const PreviewScroll command, const uint64_t target) {
+    // any other scroll replaces a line still waiting for the index
+    pendingLine.reset();
+
+    if (isArchivePreview or isImagePreview) {
+        return;
+    }
+
+    if (isBinaryPreview) {
+        scrollBinary(command, target);
+        return;
+    }
+
+    const int fd = open(previewPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat status{};
+    fstat(fd, &status);
+    const auto fileSize = static_cast<uint64_t>(status.st_size);
+    const auto pageSize = static_cast<uint64_t>(std::max(maxLines, 1));
+
+    // the furthest the preview scrolls is where the last line is at the bottom
+    const uint64_t lastPageOffset = LineIndex::findTailStart(fd, fileSize, pageSize);
+
+    uint64_t skipped{};
+
+    switch (command) {
+        case PreviewScroll::LineDown:
+        case PreviewScroll::PageDown: {
+            const uint64_t count = command == PreviewScroll::LineDown ? 1 : pageSize;
+            const uint64_t offset = LineIndex::skipLines(fd, topOffset, count, skipped);
+
+            if (offset < lastPageOffset) {
+                topOffset = offset;
+                topLine = topLine.has_value() ? std::optional(*topLine + skipped) : std::nullopt;
+            } else if (topOffset < lastPageOffset) {
+                topOffset = lastPageOffset;
+                topLine.reset();
+            }
+            break;
+        }
+        case PreviewScroll::LineUp:
+        case PreviewScroll::PageUp: {
+            const uint64_t count = command == PreviewScroll::LineUp ? 1 : pageSize;
+            topOffset = LineIndex::findPreviousLineStart(fd, topOffset, count);
+
+            if (topOffset == 0) {
+                topLine = 0;
+            } else if (topLine.has_value()) {
+                topLine = *topLine - std::min(*topLine, count);
+            }
+            break;
+        }
+        case PreviewScroll::Top:
+            topOffset = 0;
+            topLine = 0;
+            break;
+        case PreviewScroll::End:
+            topOffset = lastPageOffset;
+            topLine.reset();
+            break;
+        case PreviewScroll::GoToLine: {
+            // one lookup in the index and a scan over less than `LineIndex::interval` lines
+            const bool isIndexed = lineIndex.getPath() == previewPath;
+            const auto [checkpointLine, checkpointOffset] = isIndexed
+                                                                ? lineIndex.getCheckpoint(target)
+                                                                : std::pair<uint64_t, uint64_t>{0, 0};
+
+            // the index didn't reach the line yet, scanning to it here would block the input on a large file
+            if (target - checkpointLine >= LineIndex::interval and not (isIndexed and lineIndex.isComplete())) {
+                lineIndex.build(previewPath);
+                pendingLine = target;
+                break;
+            }
+
+            const uint64_t offset = LineIndex::skipLines(fd, checkpointOffset, target - checkpointLine, skipped);
+
+            if (offset < lastPageOffset) {
+                topOffset = offset;
+                topLine = target;
+            } else {
+                topOffset = lastPageOffset;
+                topLine.reset();
+            }
+            break;
+        }
+        case PreviewScroll::GoToOffset: {
+            // start at the line containing the offset
+            const uint64_t offset = std::min(target, fileSize);
+            topOffset = std::min(offset < fileSize ? LineIndex::findPreviousLineStart(fd, offset, 0) : fileSize,
+                                 lastPageOffset);
+            topLine.reset();
+            break;
+        }
+    }
+
+    close(fd);
+}
+
+bool FilePreview::isScrollPending() const {
+    return pendingLine.has_value();
+}
+
+void FilePreview::resolvePendingScroll() {
+    if (pendingLine.has_value()) {
+        // waits again if the index still didn't reach it
+        scroll(PreviewScroll::GoToLine, *pendingLine);
+    }
+}
+
+uint64_t FilePreview::getScrollOffset() const {
+    return topOffset;
+}
+
+std::pair<int, int> FilePreview::getThumbnailSize() const {
+    // every cell shows two pixels stacked vertically
+    return {maxLineWidth, std::max(maxLines, 0) * 2};
+}
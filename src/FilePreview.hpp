@@ -1,7 +1,26 @@
 #pragma once
 
+#include <optional>
+#include "ArchivePreview.hpp"
+#include "HexPreview.hpp"
+#include "ImagePreview.hpp"
+#include "LineIndex.hpp"
+#include "PreviewReader.hpp"
+#include "SyntaxHighlighter.hpp"
 #include "../include/Terminal++/src/Terminal++.hpp"
 
+// commands for scrolling through the previewed file
+enum class PreviewScroll {
+    LineDown,
+    LineUp,
+    PageDown,
+    PageUp,
+    Top,
+    End,
+    GoToLine,
+    GoToOffset,
+};
+
 class FilePreview {
     // terminal dimensions
     int terminalWidth{};
@@ -25,12 +44,91 @@ class FilePreview {
             verticalLine{"│"},
             horizontalLine{"─"};
 
-    // lines read from the file
-    std::vector<std::string> lines;
+    // bounded reader for the file's content
+    PreviewReader reader;
+    // lines read from the file, trimmed to `maxLineWidth` columns
+    std::vector<std::string_view> lines;
+    // number of columns each line in `lines` takes
+    std::vector<int> lineWidths;
+    // message shown instead of the content when the file can't be read
+    std::string errorMessage;
+
+    // file currently shown in the preview
+    std::string previewPath;
+    // true if the previewed file is shown as hex
+    bool isBinaryPreview{};
+    // offset of the first line shown in the preview, or of the first byte for binary files
+    uint64_t topOffset{};
+    // number of the first line shown, unknown after jumping to the end until the index covers it
+    std::optional<uint64_t> topLine{0};
+    // sparse line offsets of the previewed file, only built once scrolling starts
+    LineIndex lineIndex;
+    // a line jumped to before the index reached it, gone to once the index does
+    std::optional<uint64_t> pendingLine;
+
+    // window of the previewed binary file
+    HexPreview hexPreview;
+    // number of bytes on each row and hex digits of the offsets of the binary preview
+    size_t bytesPerRow{};
+    int offsetDigits{};
+    // reused buffers for formatting a row of the binary preview
+    std::string hexOffset, hexBytes, hexAscii;
+
+    // true if the previewed file is an archive shown as a list of its members
+    bool isArchivePreview{};
+    // formatted rows of the archive listing, `lines` points into them
+    std::vector<std::string> archiveLines;
+    // number of rows the archive listing was read for, listed again if the preview grows
+    int archiveListedLines{};
 
+    // true if the previewed file is an image shown as a thumbnail
+    bool isImagePreview{};
+    // decoded thumbnail of the previewed image
+    ImagePreview imagePreview;
+    // reused buffer for formatting a row of the thumbnail
+    std::string imageRow;
+
+    // highlighter for the file types that have a tokenizer
+    SyntaxHighlighter highlighter;
+    // tokens of each line in `lines`, empty if the file isn't highlighted
+    std::vector<std::vector<Token>> lineTokens;
+
+    static inline std::unordered_map<TokenType, Color::Code> tokenColorMap{
+        {TokenType::Keyword, Color::Red},
+        {TokenType::Type, Color::Cyan},
+        {TokenType::String, Color::Green},
+        {TokenType::Number, Color::Yellow},
+        {TokenType::Comment, Color::Blue},
+        {TokenType::Preprocessor, Color::Yellow},
+        {TokenType::Heading, Color::Blue},
+        {TokenType::Emphasis, Color::Yellow},
+        {TokenType::Code, Color::Green},
+        {TokenType::Link, Color::Cyan},
+        {TokenType::ListMarker, Color::Yellow},
+        {TokenType::Quote, Color::Blue},
+    };
+
+    // adds a line trimmed to `maxLineWidth` columns to `lines`
+    void addLine(std::string_view line);
     // reads a given file's content into `lines`
     // following the maxLines and maxLineWidth constraints
     void readFile(const std::string& path);
+    // reads the window of the binary file that fits in the preview
+    void readBinaryFile(const std::string& path);
+    // lists the archive members that fit in the preview
+    void readArchive(const std::string& path);
+    // loads the thumbnail of the image that fits in the preview
+    void readImage(const std::string& path);
+    // prints a row of the thumbnail and returns its width
+    int printImageRow(int row);
+    // prints a line of the content, colored by its tokens if highlighted
+    void printLine(size_t index) const;
+    // prints a row of the binary file and returns its width
+    int printHexRow(size_t index);
+    // scrolls the binary preview by rows of bytes
+    void scrollBinary(PreviewScroll command, uint64_t offset);
+    // prints the position of the first shown line in the bottom border
+    void printScrollPosition();
     // prints a horizontal line border with the given corner strings
     void printBorderLine(const std::string& leftCorner, const std::string& rightCorner, int length) const;
 
@@ -39,4 +137,19 @@ public:
     void resize(int width, int height);       // resizes the preview
     void render(const std::string& filePath); // renders the preview of the given file
     void clearPreview() const;                // clears the preview area
+
+    // starts building the line index of the previewed file so lines can be jumped to
+    void startScrolling();
+    // scrolls the previewed file, `target` is the 0-based line for `PreviewScroll::GoToLine`
+    // or the byte offset for `PreviewScroll::GoToOffset`
+    // a line far past what the line index covers is only gone to once the index reaches it
+    void scroll(PreviewScroll command, uint64_t target = 0);
+    // returns true while a line jumped to waits for the line index to reach it
+    [[nodiscard]] bool isScrollPending() const;
+    // goes to the line jumped to if the line index reached it
+    void resolvePendingScroll();
+    // returns the size in pixels image thumbnails are scaled to fit
+    [[nodiscard]] std::pair<int, int> getThumbnailSize() const;
+    // returns the offset of the first line shown in the preview
+    [[nodiscard]] uint64_t getScrollOffset() const;
 };
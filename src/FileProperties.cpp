@@ -83,38 +83,42 @@ std::time_t FileProperties::MetaData::getLastWriteTime(const fs::path& path) {
     }
 }
 
-std::string FileProperties::MetaData::getSizeAsString(const fs::directory_entry& entry) {
-    // return a fixed size string for directories (default on Linux)
-    if (entry.is_directory())
-        return "4 KB";
+std::string FileProperties::MetaData::formatSize(const uintmax_t size) {
+    auto fileSize = static_cast<double>(size);
 
-    try {
-        // get the file size of the entry in bytes (may throw an exception)
-        auto fileSize = static_cast<double>(fs::file_size(entry.path()));
+    int power{}; // represents the exponent for 1024 (e.g., 1 for KB, 2 for MB, etc.).
+    // determine the appropriate size suffix and round the size down?
+    for (; fileSize >= 1024.0; ++power) {
+        fileSize /= 1024.0;
+    }
 
-        int power{}; // represents the exponent for 1024 (e.g., 1 for KB, 2 for MB, etc.).
-        // determine the appropriate size suffix and round the size down?
-        for (; fileSize >= 1024.0; ++power) {
-            fileSize /= 1024.0;
-        }
+    std::stringstream ss;
 
-        std::stringstream ss;
+    // don't print the decimal point if the size is an integer
+    // else format the size with a precision of 1 digit after the decimal point
+    ss << std::fixed << std::setprecision(static_cast<int>(fileSize) == fileSize ? 0 : 1);
 
-        // don't print the decimal point if the size is an integer
-        // else format the size with a precision of 1 digit after the decimal point
-        ss << std::fixed << std::setprecision(static_cast<int>(fileSize) == fileSize ? 0 : 1);
+    // suffixes for size units (B, KB, MB, etc.)
+    constexpr char suffixes[] = "BKMGTPE";
 
-        // suffixes for size units (B, KB, MB, etc.)
-        constexpr char suffixes[] = "BKMGTPE";
+    // adding the size with it's suffix
+    ss << fileSize << " " << suffixes[power];
 
-        // adding the size with it's suffix
-        ss << fileSize << " " << suffixes[power];
+    // append 'B' if the size is larger than bytes
+    if (power > 0)
+        ss << "B";
 
-        // append 'B' if the size is larger than bytes
-        if (power > 0)
-            ss << "B";
+    return ss.str();
+}
+
+std::string FileProperties::MetaData::getSizeAsString(const fs::directory_entry& entry) {
+    // return a fixed size string for directories (default on Linux)
+    if (entry.is_directory())
+        return "4 KB";
 
-        return ss.str();
+    try {
+        // get the file size of the entry in bytes (may throw an exception)
+        return formatSize(fs::file_size(entry.path()));
     } catch (...) {
         // return an empty string if an exception occurs
         return "";
@@ -49,6 +49,7 @@ namespace FileProperties {
             {".zip", FileType::Compressed},
             {".tar", FileType::Compressed},
             {".gz", FileType::Compressed},
+            {".tgz", FileType::Compressed},
             {".rar", FileType::Compressed},
             {".md", FileType::Markdown},
         };
@@ -94,6 +95,7 @@ namespace FileProperties {
     namespace MetaData {
         std::string getPermissionsAsString(const fs::directory_entry& entry);
         std::string getSizeAsString(const fs::directory_entry& entry);
+        std::string formatSize(uintmax_t size); // formats a size in bytes with a unit suffix (e.g. "1.5 KB")
         fs::path getName(const fs::directory_entry& entry);
         std::time_t getLastWriteTime(const fs::path& path);
     }
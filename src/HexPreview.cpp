@@ -0,0 +1,105 @@
+#include "HexPreview.hpp"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+    constexpr char hexDigits[] = "0123456789abcdef";
+}
+
+const std::array<std::array<char, 2>, 256> HexPreview::hexTable = [] {
+    std::array<std::array<char, 2>, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = {hexDigits[i >> 4], hexDigits[i & 0xF]};
+    }
+    return table;
+}();
+
+const std::array<char, 256> HexPreview::asciiTable = [] {
+    std::array<char, 256> table{};
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = i >= 0x20 and i < 0x7F ? static_cast<char>(i) : '.';
+    }
+    return table;
+}();
+
+size_t HexPreview::getBytesPerRow(const int width, const int offsetDigits) {
+    // a row takes the offset, a separator, 3 columns per hex byte, a separator and 1 column per ASCII byte
+    const int rowOverhead = offsetDigits + 2 + 1;
+    const int bytes = (width - rowOverhead) / 4;
+
+    // keep rows at a multiple of 4 bytes so columns line up with common field sizes
+    return std::clamp(bytes - bytes % 4, 4, 32);
+}
+
+int HexPreview::getOffsetDigits(const uint64_t size) {
+    int digits = 8;
+    while (digits < 16 and (size >> (digits * 4)) != 0) {
+        ++digits;
+    }
+    return digits;
+}
+
+void HexPreview::toHex(uint64_t value, const int digits, std::string& out) {
+    out.assign(digits, '0');
+    for (int i = digits; i > 0 and value != 0; value >>= 4) {
+        out[--i] = hexDigits[value & 0xF];
+    }
+}
+
+bool HexPreview::read(const std::string& path, const uint64_t offset, const size_t size) {
+    window.clear();
+    windowOffset = offset;
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status{};
+    fileSize = fstat(fd, &status) == 0 ? status.st_size : 0;
+
+    window.resize(size);
+    size_t bytesRead{};
+    while (bytesRead < size) {
+        const ssize_t result = pread(fd, window.data() + bytesRead, size - bytesRead,
+                                     static_cast<off_t>(offset + bytesRead));
+        if (result <= 0) {
+            break;
+        }
+        bytesRead += result;
+    }
+    window.resize(bytesRead);
+
+    close(fd);
+    return true;
+}
+
+uint64_t HexPreview::getFileSize() const {
+    return fileSize;
+}
+
+size_t HexPreview::getWindowSize() const {
+    return window.size();
+}
+
+void HexPreview::formatRow(const size_t index, const size_t bytesPerRow, const int offsetDigits,
+                           std::string& offset, std::string& hex, std::string& ascii) const {
+    const size_t count = std::min(bytesPerRow, window.size() - std::min(index, window.size()));
+
+    toHex(windowOffset + index, offsetDigits, offset);
+
+    // every byte is two table lookups and a space, padded so the ASCII column stays aligned
+    hex.assign(bytesPerRow * 3, ' ');
+    ascii.assign(count, ' ');
+
+    const unsigned char* data = window.data() + index;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& digits = hexTable[data[i]];
+        hex[i * 3] = digits[0];
+        hex[i * 3 + 1] = digits[1];
+        ascii[i] = asciiTable[data[i]];
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// reads and formats a window of a binary file as rows of hex bytes and their ASCII representation
+// only the bytes that fit in the preview are read, so scrolling through any file size uses constant memory
+class HexPreview {
+    // bytes of the window
+    std::vector<unsigned char> window;
+    // offset of the first byte of the window
+    uint64_t windowOffset{};
+    // size of the file the window was read from
+    uint64_t fileSize{};
+
+    // two hex digits for every byte value, indexed by the byte
+    static const std::array<std::array<char, 2>, 256> hexTable;
+    // printable character for every byte value, `.` for the rest
+    static const std::array<char, 256> asciiTable;
+
+public:
+    // number of bytes shown on a row that fits in the given width
+    static size_t getBytesPerRow(int width, int offsetDigits);
+    // number of hex digits used to show offsets in a file of the given size
+    static int getOffsetDigits(uint64_t size);
+    // formats the value as hex, zero-padded to `digits`
+    static void toHex(uint64_t value, int digits, std::string& out);
+
+    // reads `size` bytes of the file starting at `offset`
+    // returns false if the file couldn't be opened or read
+    bool read(const std::string& path, uint64_t offset, size_t size);
+
+    [[nodiscard]] uint64_t getFileSize() const;
+    [[nodiscard]] size_t getWindowSize() const;
+
+    // formats the row of the window starting at `index` into `offset`, `hex` and `ascii` columns
+    void formatRow(size_t index, size_t bytesPerRow, int offsetDigits,
+                   std::string& offset, std::string& hex, std::string& ascii) const;
+};
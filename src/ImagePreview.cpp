@@ -0,0 +1,469 @@
+#include "ImagePreview.hpp"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef BFILEX_HAS_PNG
+#include <png.h>
+#endif
+
+#ifdef BFILEX_HAS_JPEG
+#include <jpeglib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    // magic bytes at the start of cached thumbnails
+    constexpr char cacheMagic[4] = {'B', 'F', 'X', 'T'};
+    // largest interlaced png decoded, they can't be downscaled a row at a time
+    constexpr uint64_t maxInterlacedPixels = 32 * 1024 * 1024;
+
+    // adds a row of bytes to the running column sums
+    void accumulate(const uint8_t* row, uint32_t* sums, const size_t size) {
+        size_t i{};
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= size; i += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+            auto* sum = reinterpret_cast<__m128i*>(sums + i);
+            _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), _mm_unpacklo_epi16(low, zero)));
+            _mm_storeu_si128(sum + 1, _mm_add_epi32(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi16(low, zero)));
+            _mm_storeu_si128(sum + 2, _mm_add_epi32(_mm_loadu_si128(sum + 2), _mm_unpacklo_epi16(high, zero)));
+            _mm_storeu_si128(sum + 3, _mm_add_epi32(_mm_loadu_si128(sum + 3), _mm_unpackhi_epi16(high, zero)));
+        }
+#endif
+        for (; i < size; ++i) {
+            sums[i] += row[i];
+        }
+    }
+
+    // returns the largest size with the image's aspect ratio that fits in `maxWidth` x `maxHeight`
+    // images are never scaled up
+    std::pair<int, int> fitSize(const int width, const int height, const int maxWidth, const int maxHeight) {
+        if (width <= maxWidth and height <= maxHeight) {
+            return {width, height};
+        }
+
+        const double scale = std::min(static_cast<double>(maxWidth) / width, static_cast<double>(maxHeight) / height);
+        return {
+            std::clamp(static_cast<int>(width * scale + 0.5), 1, maxWidth),
+            std::clamp(static_cast<int>(height * scale + 0.5), 1, maxHeight),
+        };
+    }
+
+    // downscales an RGB image fed a row at a time by averaging the source pixels covered by each target pixel
+    class Downscaler {
+        int sourceWidth{}, sourceHeight{};
+        int sourceRow{}, targetRow{};
+        // sum of every byte of the source rows covered by the current target row
+        std::vector<uint32_t> sums;
+        // first source column covered by each target column, followed by the source width
+        std::vector<int> columnStarts;
+        Thumbnail* thumbnail{};
+
+        // averages the sums into the current target row
+        void emitRow() {
+            const int rowCount = (targetRow + 1) * sourceHeight / thumbnail->height
+                                 - targetRow * sourceHeight / thumbnail->height;
+            uint8_t* out = thumbnail->pixels.data() + static_cast<size_t>(targetRow) * thumbnail->width * 3;
+
+            for (int x = 0; x < thumbnail->width; ++x) {
+                const int begin = columnStarts[x], end = columnStarts[x + 1];
+                const uint32_t count = static_cast<uint32_t>(rowCount * (end - begin));
+
+                uint32_t red{}, green{}, blue{};
+                for (int column = begin; column < end; ++column) {
+                    red += sums[column * 3];
+                    green += sums[column * 3 + 1];
+                    blue += sums[column * 3 + 2];
+                }
+
+                out[x * 3] = static_cast<uint8_t>((red + count / 2) / count);
+                out[x * 3 + 1] = static_cast<uint8_t>((green + count / 2) / count);
+                out[x * 3 + 2] = static_cast<uint8_t>((blue + count / 2) / count);
+            }
+
+            std::fill(sums.begin(), sums.end(), 0);
+            ++targetRow;
+        }
+
+    public:
+        void reset(const int width, const int height, const int targetWidth, const int targetHeight,
+                   Thumbnail& out) {
+            sourceWidth = width, sourceHeight = height;
+            sourceRow = targetRow = 0;
+            sums.assign(static_cast<size_t>(width) * 3, 0);
+
+            columnStarts.resize(targetWidth + 1);
+            for (int x = 0; x <= targetWidth; ++x) {
+                columnStarts[x] = x * width / targetWidth;
+            }
+
+            thumbnail = &out;
+            thumbnail->width = targetWidth;
+            thumbnail->height = targetHeight;
+            thumbnail->pixels.assign(static_cast<size_t>(targetWidth) * targetHeight * 3, 0);
+        }
+
+        void addRow(const uint8_t* row) {
+            accumulate(row, sums.data(), sums.size());
+            ++sourceRow;
+
+            // the target row is complete once all the source rows it covers are added
+            if (targetRow < thumbnail->height and sourceRow == (targetRow + 1) * sourceHeight / thumbnail->height) {
+                emitRow();
+            }
+        }
+    };
+
+#ifdef BFILEX_HAS_PNG
+    // reports errors through the jump buffer instead of printing to the terminal
+    void onPngError(png_structp png, png_const_charp) {
+        png_longjmp(png, 1);
+    }
+
+    void onPngWarning(png_structp, png_const_charp) {}
+
+    bool decodePng(FILE* file, const int maxWidth, const int maxHeight, Thumbnail& thumbnail) {
+        // objects with destructors are created before `setjmp` so jumping back doesn't skip them
+        Downscaler downscaler;
+        std::vector<uint8_t> row;
+        std::vector<uint8_t> image;
+        std::vector<png_bytep> rows;
+
+        png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, onPngError, onPngWarning);
+        if (png == nullptr) {
+            return false;
+        }
+
+        png_infop info = png_create_info_struct(png);
+        if (info == nullptr or setjmp(png_jmpbuf(png))) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return false;
+        }
+
+        png_init_io(png, file);
+        png_read_info(png, info);
+
+        // convert every color type to 8-bit RGB, blending transparent pixels with black
+        png_set_expand(png);
+        png_set_strip_16(png);
+        png_set_gray_to_rgb(png);
+
+        png_color_16 background{};
+        png_set_background(png, &background, PNG_BACKGROUND_GAMMA_SCREEN, 0, 1.0);
+
+        const int passes = png_set_interlace_handling(png);
+        png_read_update_info(png, info);
+
+        const auto width = static_cast<int>(png_get_image_width(png, info));
+        const auto height = static_cast<int>(png_get_image_height(png, info));
+
+        if (png_get_channels(png, info) != 3 or width <= 0 or height <= 0) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return false;
+        }
+
+        const auto [targetWidth, targetHeight] = fitSize(width, height, maxWidth, maxHeight);
+        downscaler.reset(width, height, targetWidth, targetHeight, thumbnail);
+
+        if (passes == 1) {
+            row.resize(png_get_rowbytes(png, info));
+            for (int y = 0; y < height; ++y) {
+                png_read_row(png, row.data(), nullptr);
+                downscaler.addRow(row.data());
+            }
+        } else {
+            // interlaced images are only complete after the last pass
+            if (static_cast<uint64_t>(width) * height > maxInterlacedPixels) {
+                png_destroy_read_struct(&png, &info, nullptr);
+                return false;
+            }
+
+            const size_t rowSize = png_get_rowbytes(png, info);
+            image.resize(rowSize * height);
+            rows.resize(height);
+            for (int y = 0; y < height; ++y) {
+                rows[y] = image.data() + rowSize * y;
+            }
+
+            png_read_image(png, rows.data());
+            for (int y = 0; y < height; ++y) {
+                downscaler.addRow(rows[y]);
+            }
+        }
+
+        png_destroy_read_struct(&png, &info, nullptr);
+        return true;
+    }
+#endif
+
+#ifdef BFILEX_HAS_JPEG
+    struct JpegError {
+        jpeg_error_mgr manager;
+        jmp_buf jump;
+    };
+
+    // reports errors through the jump buffer instead of printing to the terminal and exiting
+    void onJpegError(const j_common_ptr info) {
+        longjmp(reinterpret_cast<JpegError*>(info->err)->jump, 1);
+    }
+
+    void onJpegMessage(j_common_ptr) {}
+
+    bool decodeJpeg(FILE* file, const int maxWidth, const int maxHeight, Thumbnail& thumbnail) {
+        // objects with destructors are created before `setjmp` so jumping back doesn't skip them
+        Downscaler downscaler;
+        std::vector<uint8_t> row;
+
+        jpeg_decompress_struct jpeg{};
+        JpegError error{};
+        jpeg.err = jpeg_std_error(&error.manager);
+        error.manager.error_exit = onJpegError;
+        error.manager.output_message = onJpegMessage;
+
+        if (setjmp(error.jump)) {
+            jpeg_destroy_decompress(&jpeg);
+            return false;
+        }
+
+        jpeg_create_decompress(&jpeg);
+        jpeg_stdio_src(&jpeg, file);
+        jpeg_read_header(&jpeg, TRUE);
+
+        // let the decoder skip most of the work by decoding at the smallest scale that is still
+        // at least as large as the thumbnail
+        const auto [targetWidth, targetHeight] = fitSize(static_cast<int>(jpeg.image_width),
+                                                         static_cast<int>(jpeg.image_height), maxWidth, maxHeight);
+        unsigned int denominator = 8;
+        while (denominator > 1 and (jpeg.image_width / denominator < static_cast<unsigned>(targetWidth) or
+                                    jpeg.image_height / denominator < static_cast<unsigned>(targetHeight))) {
+            denominator /= 2;
+        }
+
+        jpeg.scale_num = 1;
+        jpeg.scale_denom = denominator;
+        jpeg.out_color_space = JCS_RGB;
+        jpeg_start_decompress(&jpeg);
+
+        const auto width = static_cast<int>(jpeg.output_width);
+        const auto height = static_cast<int>(jpeg.output_height);
+        downscaler.reset(width, height, std::min(targetWidth, width), std::min(targetHeight, height), thumbnail);
+
+        row.resize(static_cast<size_t>(width) * jpeg.output_components);
+        while (jpeg.output_scanline < jpeg.output_height) {
+            JSAMPROW rowPointer = row.data();
+            jpeg_read_scanlines(&jpeg, &rowPointer, 1);
+            downscaler.addRow(row.data());
+        }
+
+        jpeg_finish_decompress(&jpeg);
+        jpeg_destroy_decompress(&jpeg);
+        return true;
+    }
+#endif
+
+    // FNV-1a hash of the bytes
+    uint64_t hashBytes(const void* data, const size_t size, uint64_t hash = 0xcbf29ce484222325) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3;
+        }
+        return hash;
+    }
+}
+
+std::string ImagePreview::getCacheDirectory() {
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome != nullptr and *cacheHome != '\0') {
+        return std::string(cacheHome) + "/BFileX/thumbnails";
+    }
+    if (const char* home = std::getenv("HOME"); home != nullptr and *home != '\0') {
+        return std::string(home) + "/.cache/BFileX/thumbnails";
+    }
+    return {};
+}
+
+std::string ImagePreview::getCachePath(const std::string& path, const int64_t modificationTime, const uint64_t size,
+                                       const int maxWidth, const int maxHeight) {
+    const std::string directory = getCacheDirectory();
+    if (directory.empty()) {
+        return {};
+    }
+
+    // the image is identified by its path and metadata, and the size it was scaled to
+    uint64_t hash = hashBytes(path.data(), path.size());
+    hash = hashBytes(&modificationTime, sizeof(modificationTime), hash);
+    hash = hashBytes(&size, sizeof(size), hash);
+    hash = hashBytes(&maxWidth, sizeof(maxWidth), hash);
+    hash = hashBytes(&maxHeight, sizeof(maxHeight), hash);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.thumb", static_cast<unsigned long long>(hash));
+    return directory + "/" + name;
+}
+
+bool ImagePreview::readCache(const std::string& cachePath, Thumbnail& thumbnail) {
+    std::ifstream file(cachePath, std::ios::binary);
+
+    char magic[sizeof(cacheMagic)];
+    uint16_t size[2];
+    if (not file.read(magic, sizeof(magic)) or std::memcmp(magic, cacheMagic, sizeof(magic)) != 0 or
+        not file.read(reinterpret_cast<char*>(size), sizeof(size)) or size[0] == 0 or size[1] == 0) {
+        return false;
+    }
+
+    thumbnail.width = size[0];
+    thumbnail.height = size[1];
+    thumbnail.pixels.resize(static_cast<size_t>(size[0]) * size[1] * 3);
+
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(thumbnail.pixels.data()),
+                                       static_cast<std::streamsize>(thumbnail.pixels.size())));
+}
+
+void ImagePreview::writeCache(const std::string& cachePath, const Thumbnail& thumbnail) {
+    if (cachePath.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    fs::create_directories(fs::path(cachePath).parent_path(), error);
+    if (error) {
+        return;
+    }
+
+    // write to a temporary file first so a partially written thumbnail is never read,
+    // named after the thread since thumbnails are also made ahead of time in the background
+    const std::string temporaryPath = cachePath + "." + std::to_string(getpid()) + "." +
+                                      std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        const uint16_t size[2] = {static_cast<uint16_t>(thumbnail.width), static_cast<uint16_t>(thumbnail.height)};
+
+        file.write(cacheMagic, sizeof(cacheMagic));
+        file.write(reinterpret_cast<const char*>(size), sizeof(size));
+        file.write(reinterpret_cast<const char*>(thumbnail.pixels.data()),
+                   static_cast<std::streamsize>(thumbnail.pixels.size()));
+
+        if (not file) {
+            file.close();
+            fs::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    fs::rename(temporaryPath, cachePath, error);
+    if (error) {
+        fs::remove(temporaryPath, error);
+    }
+}
+
+bool ImagePreview::load(const std::string& path, const int width, const int height) {
+    // the thumbnail is already loaded
+    if (loaded and path == imagePath and width == maxWidth and height == maxHeight) {
+        return true;
+    }
+
+    imagePath = path, maxWidth = width, maxHeight = height;
+    loaded = false;
+
+    struct stat status{};
+    if (width <= 0 or height <= 0 or stat(path.c_str(), &status) != 0) {
+        return false;
+    }
+
+    const int64_t modificationTime = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+    const std::string cachePath = getCachePath(path, modificationTime, status.st_size, width, height);
+
+    if (not cachePath.empty() and readCache(cachePath, thumbnail)) {
+        loaded = true;
+        return true;
+    }
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // detect the format from the content rather than the extension
+    unsigned char magic[8]{};
+    const size_t magicSize = std::fread(magic, 1, sizeof(magic), file);
+    std::rewind(file);
+
+#ifdef BFILEX_HAS_PNG
+    if (magicSize == sizeof(magic) and png_sig_cmp(magic, 0, sizeof(magic)) == 0) {
+        loaded = decodePng(file, width, height, thumbnail);
+    }
+#endif
+
+#ifdef BFILEX_HAS_JPEG
+    if (magicSize >= 3 and magic[0] == 0xFF and magic[1] == 0xD8 and magic[2] == 0xFF) {
+        loaded = decodeJpeg(file, width, height, thumbnail);
+    }
+#endif
+
+    std::fclose(file);
+
+    if (loaded) {
+        writeCache(cachePath, thumbnail);
+    }
+
+    return loaded;
+}
+
+const Thumbnail& ImagePreview::getThumbnail() const {
+    return thumbnail;
+}
+
+int ImagePreview::formatRow(const Thumbnail& thumbnail, const int row, std::string& out) {
+    out.clear();
+
+    const uint8_t* top = thumbnail.pixels.data() + static_cast<size_t>(row) * 2 * thumbnail.width * 3;
+    const bool hasBottom = row * 2 + 1 < thumbnail.height;
+    const uint8_t* bottom = hasBottom ? top + static_cast<size_t>(thumbnail.width) * 3 : nullptr;
+
+    // colors are only emitted when they change from the previous cell
+    int32_t previousTop = -1, previousBottom = -1;
+    char escape[24];
+
+    for (int x = 0; x < thumbnail.width; ++x) {
+        const uint8_t* pixel = top + x * 3;
+        const int32_t topColor = pixel[0] << 16 | pixel[1] << 8 | pixel[2];
+        if (topColor != previousTop) {
+            out.append(escape, std::snprintf(escape, sizeof(escape), "\x1b[38;2;%d;%d;%dm",
+                                             pixel[0], pixel[1], pixel[2]));
+            previousTop = topColor;
+        }
+
+        // the last row of an image with an odd height only has the upper half
+        if (bottom != nullptr) {
+            const uint8_t* lower = bottom + x * 3;
+            const int32_t bottomColor = lower[0] << 16 | lower[1] << 8 | lower[2];
+            if (bottomColor != previousBottom) {
+                out.append(escape, std::snprintf(escape, sizeof(escape), "\x1b[48;2;%d;%d;%dm",
+                                                 lower[0], lower[1], lower[2]));
+                previousBottom = bottomColor;
+            }
+        }
+
+        out += "▀";
+    }
+
+    out += "\x1b[0m";
+    return thumbnail.width;
+}
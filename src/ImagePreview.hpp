@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// a downscaled image as rows of 8-bit RGB pixels
+struct Thumbnail {
+    int width{};
+    int height{};
+    std::vector<uint8_t> pixels;
+};
+
+// decodes png and jpeg images into thumbnails that fit the preview
+// images are downscaled a row at a time while decoding, so memory use depends on the image width
+// rather than its size, and thumbnails are cached on disk keyed by the path, modification time and size
+// of the image, so previewing an image again doesn't decode it
+class ImagePreview {
+    // image the thumbnail was made for and the size it was made to fit
+    std::string imagePath;
+    int maxWidth{};
+    int maxHeight{};
+    // true if the image was decoded or read from the cache
+    bool loaded{};
+
+    Thumbnail thumbnail;
+
+    // returns the path of the cached thumbnail for an image with the given metadata
+    static std::string getCachePath(const std::string& path, int64_t modificationTime, uint64_t size,
+                                    int maxWidth, int maxHeight);
+    static bool readCache(const std::string& cachePath, Thumbnail& thumbnail);
+    static void writeCache(const std::string& cachePath, const Thumbnail& thumbnail);
+
+public:
+    // returns the directory thumbnails are cached in, under `$XDG_CACHE_HOME` or `~/.cache`
+    static std::string getCacheDirectory();
+
+    // loads the thumbnail of the image at `path`, scaled down to fit in `maxWidth` x `maxHeight` pixels
+    // returns false if the image couldn't be decoded
+    bool load(const std::string& path, int maxWidth, int maxHeight);
+
+    [[nodiscard]] const Thumbnail& getThumbnail() const;
+
+    // formats a row of terminal cells, each showing two rows of pixels with the upper half block
+    // character colored with truecolor escape sequences, and returns the number of cells
+    static int formatRow(const Thumbnail& thumbnail, int row, std::string& out);
+};
@@ -1,154 +1,1511 @@
 #include "InputHandler.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
+#include <fnmatch.h>
 #include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <unistd.h>
+#include "Checksum.hpp"
+#include "CopyEngine.hpp"
+#include "DeleteEngine.hpp"
+#include "JobQueue.hpp"
+#include "JumpDatabase.hpp"
+#include "Trace.hpp"
+#include "Trash.hpp"
+#include "UI.hpp"
+
+namespace {
+    // returns the paths that don't exist anymore
+    std::vector<fs::path> getDeletedPaths(const std::vector<fs::path>& paths) {
+        std::vector<fs::path> deletedPaths;
+        for (const fs::path& path : paths) {
+            std::error_code error;
+            if (not fs::exists(fs::symlink_status(path, error))) {
+                deletedPaths.push_back(path);
+            }
+        }
+        return deletedPaths;
+    }
+}
+
+InputHandler::InputHandler()
+    : app(App::getInstance()) {}
+
+void InputHandler::handleUp() const {
+    app.decrementCurrentEntryIndex();
+}
+
+void InputHandler::handleDown() const {
+    app.incrementCurrentEntryIndex();
+}
+
+void InputHandler::handleEnter() const {
+    const fs::directory_entry currentEntry = app.getCurrentEntry();
+
+    if (currentEntry.is_directory()) {
+        app.changeDirectory(currentEntry.path());
+    } else if (currentEntry.is_regular_file() and not FileProperties::Utilities::isExecutable(currentEntry.path())) {
+        if (FileProperties::Utilities::isBinary(currentEntry.path().string())) {
+            FileManager::openFile(currentEntry.path());
+            return;
+        }
+
+        // open the file in the user's editor
+        FileManager::openFileInEditor(currentEntry.path());
+
+        // revert the editor's changes to the terminal
+        app.initializeTerminal();
+    }
+}
+
+void InputHandler::handleBack() const {
+    app.changeDirectory(app.getCurrentPath() / "..");
+}
+
+void InputHandler::handleRename() const {
+    // initializing the input buffer to the current file name
+    std::string inputBuffer = FileProperties::MetaData::getName(app.getCurrentEntry()).string();
+
+    // return directly if the user tries to rename the `..` directory (do nothing)
+    if (inputBuffer == "..") {
+        return;
+    }
+
+    // return if user cancelled
+    if (not readInputString("New name: ", inputBuffer,
+                            FileProperties::Types::determineEntryType(app.getCurrentEntry()))) {
+        return;
+    }
+
+    try {
+        // file entry before renaming
+        const fs::directory_entry oldEntry = app.getCurrentEntry();
+        const fs::path newPath = app.getCurrentPath() / fs::path(inputBuffer);
+
+        // return if the name was not changed
+        if (oldEntry.path() == newPath) {
+            app.resetFooter();
+            return;
+        }
+
+        // if entry already exists prompt the user about overriding it
+        const bool overridden = fs::exists(newPath);
+        if (overridden) {
+            // return if the answer is not yes
+            if (not confirmAction("Entry already exists override it? (y/n) ")) {
+                app.resetFooter();
+                return;
+            }
+        }
+
+        // rename the entry to the specified name
+        fs::rename(oldEntry.path(), newPath);
+
+        app.setCustomFooter([=] {
+            Printer(Color::Green)
+                    .setTextStyle(TextStyle::Bold)
+                    .print("Renamed ", FileProperties::MetaData::getName(oldEntry), " to: ", newPath.filename());
+        }, false);
+
+        // move the entry to its sorted position under the new name
+        app.eraseEntry(app.getCurrentEntryIndex());
+        // the replaced entry may be sorted by the time or size it had, where it's not searched for
+        if (overridden) {
+            app.removeEntries({newPath});
+        }
+
+        // set the cursor to point at the same entry after renaming
+        app.setCurrentEntryIndex(app.insertEntry(newPath).value_or(0));
+    } catch (const fs::filesystem_error&) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Failed to rename entry!");
+        }, true);
+    }
+}
+
+void InputHandler::handleDelete() const {
+    if (not app.getSelection().empty()) {
+        return handleDeleteMarked();
+    }
+
+    const fs::path targetEntry = FileProperties::MetaData::getName(app.getCurrentEntry());
+
+    // return when trying to delete `..`
+    if (targetEntry.string() == "..") {
+        return;
+    }
+
+    // return if the answer is not yes
+    if (not confirmAction(app.shouldUseTrash()
+                              ? "Move \"" + targetEntry.string() + "\" to the trash? (y/n) "
+                              : "Are you sure you want to delete \"" + targetEntry.string() + "\"? (y/n) ")) {
+        app.resetFooter();
+        return;
+    }
+
+    // moving to the trash is a single rename whatever the size of the entry
+    if (app.shouldUseTrash()) {
+        try {
+            const fs::path path = app.getCurrentEntry().path();
+            Trash::getInstance().moveToTrash(path);
+
+            app.setCustomFooter([=] {
+                Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                        .print("Moved to trash: ", targetEntry, "  press u to restore");
+            }, false);
+
+            app.removeEntries({path});
+            return;
+        } catch (const fs::filesystem_error&) {
+            // e.g. the top of the entry's filesystem isn't writable
+            if (not confirmAction("Can't move \"" + targetEntry.string() +
+                                  "\" to the trash, delete it permanently? (y/n) ")) {
+                app.resetFooter();
+                return;
+            }
+        }
+    }
+
+    try {
+        // if entry is a non empty directory prompt the user about recursively deleting it
+        if (FileProperties::Types::determineEntryType(app.getCurrentEntry()) == EntryType::Directory and
+            not is_empty(app.getCurrentEntry())) {
+            // return if the answer is not yes
+            if (not confirmAction("Directory is not empty, delete it recursively? (y/n) ")) {
+                app.resetFooter();
+                return;
+            }
+
+            // deleting a large tree takes a while, it runs in the background
+            const fs::path path = app.getCurrentEntry().path();
+
+            const auto deleteTree = [=](ThreadPool& pool, OperationProgress& progress) {
+                DeleteEngine::remove(path, pool, progress);
+            };
+
+            const auto showDeletedEntries = [=](const Job& job) {
+                const uint64_t deletedEntriess = job.progress.items.load();
+
+                App& app = App::getInstance();
+                app.removeEntries(getDeletedPaths({path}));
+
+                app.setCustomFooter([=] {
+                    Printer printer(Color::Green);
+
+                    printer.setTextStyle(TextStyle::Bold)
+                            .print("Deleted entry: ", targetEntry);
+
+                    if (deletedEntriess > 1) {
+                        printer.print(" and ", deletedEntriess - 1, " other ",
+                                      (deletedEntriess > 2 ? "entries" : "entry"));
+                    }
+                }, false);
+            };
+
+            JobQueue::getInstance().submit("Deleting " + targetEntry.string(), deleteTree, showDeletedEntries);
+
+            app.resetFooter();
+            return;
+        } else {
+            fs::remove(app.getCurrentEntry().path());
+            app.setCustomFooter([=] {
+                Printer(Color::Green).setTextStyle(TextStyle::Bold).print("Deleted entry: ", targetEntry);
+            }, false);
+        }
+
+        // refresh entries
+        app.updateEntries(true);
+    } catch (const fs::filesystem_error&) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Failed to delete entry!");
+        }, true);
+    }
+}
+
+void InputHandler::handleDeleteMarked() const {
+    const std::vector<fs::path> markedPaths = app.getSelectedPaths();
+    const std::string markedCount = std::to_string(markedPaths.size());
+
+    if (not confirmAction(app.shouldUseTrash()
+                              ? "Move the " + markedCount + " marked entries to the trash? (y/n) "
+                              : "Delete the " + markedCount + " marked entries permanently? (y/n) ")) {
+        app.resetFooter();
+        return;
+    }
+
+    std::vector<fs::path> paths = markedPaths;
+
+    if (app.shouldUseTrash()) {
+        Trash& trash = Trash::getInstance();
+        std::vector<fs::path> trashedPaths;
+        paths.clear();
+
+        for (const fs::path& path : markedPaths) {
+            try {
+                trash.moveToTrash(path);
+                trashedPaths.push_back(path);
+            } catch (const fs::filesystem_error&) {
+                paths.push_back(path);
+            }
+        }
+
+        // a single update of the listing for the whole batch
+        app.removeEntries(trashedPaths);
+
+        if (paths.empty()) {
+            app.setCustomFooter([=] {
+                Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                        .print("Moved ", markedCount, " entries to trash  press u to restore");
+            }, true);
+            return;
+        }
+
+        if (not confirmAction("Can't move " + std::to_string(paths.size()) +
+                              " entries to the trash, delete them permanently? (y/n) ")) {
+            app.resetFooter();
+            return;
+        }
+    }
+
+    // every entry is deleted by one background job
+    const auto deleteEntries = [=](ThreadPool& pool, OperationProgress& progress) {
+        for (const fs::path& path : paths) {
+            if (progress.cancelled.load()) {
+                break;
+            }
+            DeleteEngine::remove(path, pool, progress);
+        }
+    };
+
+    const auto showDeletedEntries = [=](const Job&) {
+        App& app = App::getInstance();
+
+        const std::vector<fs::path> deletedPaths = getDeletedPaths(paths);
+        app.removeEntries(deletedPaths);
+
+        app.setCustomFooter([deletedCount = deletedPaths.size()] {
+            Printer(Color::Green).setTextStyle(TextStyle::Bold).print("Deleted ", deletedCount, " entries");
+        }, false);
+    };
+
+    JobQueue::getInstance().submit("Deleting " + std::to_string(paths.size()) + " entries", deleteEntries,
+                                   showDeletedEntries);
+    app.resetFooter();
+}
+
+void InputHandler::handleToggleMark() const {
+    // the `..` directory can't be marked
+    if (not FileProperties::Utilities::isDotDot(app.getCurrentEntry())) {
+        app.getSelection().toggle(app.getCurrentEntryIndex());
+    }
+
+    // move to the next entry to mark entries one after the other
+    app.incrementCurrentEntryIndex();
+}
+
+void InputHandler::handleMarkPattern() const {
+    std::string inputBuffer;
+
+    // return if user cancelled
+    if (not readInputString("Mark pattern: ", inputBuffer, EntryType::RegularFile) or inputBuffer.empty()) {
+        app.resetFooter();
+        return;
+    }
+
+    Selection& selection = app.getSelection();
+    const std::vector<fs::directory_entry>& entries = app.getEntries();
+    const size_t previousCount = selection.count();
+
+    // mark the entries whose name matches the shell pattern, e.g. `*.log`
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const std::string name = entries[i].path().filename().string();
+        if (not FileProperties::Utilities::isDotDot(entries[i]) and
+            fnmatch(inputBuffer.c_str(), name.c_str(), FNM_PERIOD) == 0) {
+            selection.select(i);
+        }
+    }
+
+    app.setCustomFooter([markedCount = selection.count() - previousCount, inputBuffer] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("Marked ", markedCount, " entries matching ", inputBuffer);
+    }, true);
+}
+
+void InputHandler::handleChangePermissions() const {
+    std::vector<fs::path> paths = app.getSelectedPaths();
+    if (paths.empty()) {
+        if (FileProperties::Utilities::isDotDot(app.getCurrentEntry())) {
+            return;
+        }
+        paths.push_back(app.getCurrentEntry().path());
+    }
+
+    // start from the permissions of the current entry in octal, e.g. "644"
+    std::error_code error;
+    const auto currentPermissions = fs::status(app.getCurrentEntry().path(), error).permissions();
+    std::stringstream stream;
+    stream << std::oct << (static_cast<unsigned>(currentPermissions) & 07777);
+    std::string inputBuffer = error ? "" : stream.str();
+
+    // return if user cancelled
+    if (not readInputString("Permissions for " + std::to_string(paths.size()) +
+                            (paths.size() == 1 ? " entry: " : " entries: "), inputBuffer, EntryType::Executable)) {
+        return;
+    }
+
+    // octal modes only, e.g. 644 or 0755
+    if (inputBuffer.empty() or inputBuffer.size() > 4 or
+        inputBuffer.find_first_not_of("01234567") != std::string::npos) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Invalid permissions!");
+        }, true);
+        return;
+    }
+
+    const auto permissions = static_cast<fs::perms>(std::stoul(inputBuffer, nullptr, 8));
+
+    size_t failedCount = 0;
+    for (const fs::path& path : paths) {
+        fs::permissions(path, permissions, fs::perm_options::replace, error);
+        failedCount += error ? 1 : 0;
+    }
+
+    // only the changed entries' cached status is refreshed, the listing isn't read again
+    std::vector<fs::directory_entry>& entries = app.getEntries();
+    const std::vector<size_t> markedIndices = app.getSelection().getIndices();
+    for (const size_t index : markedIndices.empty() ? std::vector{app.getCurrentEntryIndex()} : markedIndices) {
+        entries[index].refresh(error);
+    }
+    app.getSelection().clear();
+
+    if (failedCount > 0) {
+        app.setCustomFooter([=] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold)
+                    .print("Failed to change the permissions of ", failedCount, " of ", paths.size(), " entries");
+        }, true);
+    } else {
+        app.setCustomFooter([=] {
+            Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                    .print("Changed the permissions of ", paths.size(), (paths.size() == 1 ? " entry" : " entries"),
+                           " to ", inputBuffer);
+        }, true);
+    }
+}
+
+void InputHandler::handleChecksum() const {
+    std::vector<fs::path> paths = app.getSelectedPaths();
+    if (paths.empty()) {
+        if (FileProperties::Utilities::isDotDot(app.getCurrentEntry())) {
+            return;
+        }
+        paths.push_back(app.getCurrentEntry().path());
+    }
+
+    // only offer the algorithms that were built in
+    std::string prompt = "Checksum with (x)xh3, (b)lake3";
+    prompt += Checksum::isAvailable(ChecksumAlgorithm::Sha256) ? " or (s)ha256? " : "? ";
+
+    Cursor::show();
+    app.setCustomFooter([&] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print(prompt);
+    }, true);
+    const char answer = Input::getChar();
+    Cursor::hide();
+
+    ChecksumAlgorithm algorithm;
+    if (answer == 'x') {
+        algorithm = ChecksumAlgorithm::Xxh3;
+    } else if (answer == 'b') {
+        algorithm = ChecksumAlgorithm::Blake3;
+    } else if (answer == 's' and Checksum::isAvailable(ChecksumAlgorithm::Sha256)) {
+        algorithm = ChecksumAlgorithm::Sha256;
+    } else {
+        app.resetFooter();
+        return;
+    }
+
+    const fs::path directory = app.getCurrentPath();
+    // a single file's checksum is shown in the footer, anything else is written to a report
+    const bool singleFile = paths.size() == 1 and fs::is_regular_file(paths.front());
+
+    // filled by the job, read once it's finished
+    const auto results = std::make_shared<std::vector<ChecksumResult>>();
+    const auto reportPath = std::make_shared<fs::path>();
+
+    const std::string description = "Checksumming " + (paths.size() == 1
+                                                           ? paths.front().filename().string()
+                                                           : std::to_string(paths.size()) + " entries");
+
+    JobQueue::getInstance().submit(description, [=](ThreadPool& pool, OperationProgress& progress) {
+        *results = Checksum::computeAll(Checksum::collectFiles(paths, progress), algorithm, pool, progress);
+
+        if (not singleFile and not progress.cancelled.load()) {
+            try {
+                *reportPath = CopyEngine::getAvailablePath(directory, Checksum::getReportName(algorithm));
+                Checksum::writeReport(*reportPath, *results, directory);
+            } catch (const fs::filesystem_error& error) {
+                progress.addError(error.what());
+            }
+        }
+    }, [=](const Job& job) {
+        App& app = App::getInstance();
+
+        const uint64_t items = job.progress.items.load();
+        const double seconds = std::chrono::duration<double>(job.endTime - job.startTime).count();
+        const std::string rate = FileProperties::MetaData::formatSize(
+            static_cast<uintmax_t>(static_cast<double>(job.progress.bytes.load()) / std::max(seconds, 1e-3))) + "/s";
+
+        if (singleFile) {
+            const std::string digest = results->empty() ? "" : results->front().digest;
+            app.setCustomFooter([=] {
+                Printer(Color::Green).setTextStyle(TextStyle::Bold).print(Checksum::getName(algorithm), " ");
+                Printer().print(digest, "  ");
+                Printer(Color::Yellow).print(rate);
+            }, false);
+            return;
+        }
+
+        // the report shows up in the listing if it was written to the current directory
+        if (reportPath->empty()) {
+            return;
+        }
+        if (App::getInstance().getCurrentPath() == directory) {
+            app.insertEntry(*reportPath);
+        }
+
+        const std::string reportName = reportPath->filename().string();
+        app.setCustomFooter([=] {
+            Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                    .print("Wrote ", reportName, ": ", items, (items == 1 ? " file  " : " files  "));
+            Printer(Color::Yellow).print(rate);
+        }, false);
+    });
+
+    app.resetFooter();
+}
+
+void InputHandler::handleFindDuplicates() const {
+    const fs::path directory = app.getCurrentPath();
+
+    // filled by the job, read once it's finished
+    const auto groups = std::make_shared<std::vector<DuplicateGroup>>();
+
+    const auto findDuplicates = [=](ThreadPool& pool, OperationProgress& progress) {
+        *groups = DuplicateFinder::find(directory, pool, progress);
+    };
+
+    // the scan may finish while typing, the duplicates are only shown once opened from the job list
+    const auto reportDuplicates = [=](const Job& job) {
+        if (job.state.load() == JobState::Cancelled) {
+            return;
+        }
+
+        if (groups->empty()) {
+            App::getInstance().setCustomFooter([] {
+                Printer(Color::Green).setTextStyle(TextStyle::Bold).print("No duplicates found");
+            }, false);
+            return;
+        }
+
+        const size_t groupCount = groups->size();
+        App::getInstance().setCustomFooter([=] {
+            Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                    .print("Found ", groupCount, (groupCount == 1 ? " group" : " groups"), " of duplicates");
+            Printer(Color::Yellow).print("  J then l to view");
+        }, false);
+    };
+
+    const auto showDuplicates = [=] {
+        handleDuplicates(*groups, directory);
+    };
+
+    JobQueue::getInstance().submit("Finding duplicates in " + directory.filename().string(), findDuplicates,
+                                   reportDuplicates, showDuplicates);
+    app.resetFooter();
+}
+
+void InputHandler::handleDuplicates(std::vector<DuplicateGroup>& groups, const fs::path& directory) const {
+    UI& ui = UI::getInstance();
+
+    const auto duplicatesFooter = [] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("DUPLICATES  j/k: select  Space: mark  a: mark copies  d: delete  L: hard link  q: back");
+    };
+    app.setCustomFooter(duplicatesFooter, true);
+
+    const auto countFiles = [&] {
+        size_t count = 0;
+        for (const DuplicateGroup& group : groups) {
+            count += group.files.size();
+        }
+        return count;
+    };
+
+    // files are numbered across groups
+    Selection marks;
+    marks.reset(countFiles());
+    size_t selectedIndex = 0;
+
+    // deletes or links the marked files, keeping at least one unmarked file of every group
+    const auto processMarked = [&](const bool link) {
+        std::vector<fs::path> processedPaths;
+        size_t failedCount = 0;
+        size_t fileIndex = 0;
+
+        for (DuplicateGroup& group : groups) {
+            // the copy kept, and linked to
+            const DuplicateFile* source = nullptr;
+            for (size_t i = 0; i < group.files.size() and source == nullptr; ++i) {
+                if (not marks.isSelected(fileIndex + i)) {
+                    source = &group.files[i];
+                }
+            }
+
+            std::vector<DuplicateFile> remainingFiles;
+            for (const DuplicateFile& file : group.files) {
+                // every copy is marked, none of them is touched
+                if (not marks.isSelected(fileIndex++) or source == nullptr) {
+                    remainingFiles.push_back(file);
+                    continue;
+                }
+
+                // a file changed since the scan may not be a copy of the kept one anymore, and the kept one
+                // may not hold the contents anymore, neither is touched then
+                if (not DuplicateFinder::isUnchanged(file, group.size) or
+                    not DuplicateFinder::isUnchanged(*source, group.size)) {
+                    ++failedCount;
+                    remainingFiles.push_back(file);
+                    continue;
+                }
+
+                try {
+                    if (link) {
+                        DuplicateFinder::replaceWithHardLink(source->path, file.path);
+                    } else if (app.shouldUseTrash()) {
+                        Trash::getInstance().moveToTrash(file.path);
+                    } else {
+                        fs::remove(file.path);
+                    }
+                    processedPaths.push_back(file.path);
+                } catch (const fs::filesystem_error&) {
+                    ++failedCount;
+                    remainingFiles.push_back(file);
+                }
+            }
+
+            group.files = std::move(remainingFiles);
+        }
+
+        // the deleted files leave the listing, the linked ones are still there
+        if (not link) {
+            app.removeEntries(processedPaths);
+        }
+
+        groups.erase(std::remove_if(groups.begin(), groups.end(), [](const DuplicateGroup& group) {
+            return group.files.size() < 2;
+        }), groups.end());
+        marks.reset(countFiles());
+
+        const size_t processedCount = processedPaths.size();
+        app.setCustomFooter([=] {
+            Printer(failedCount > 0 ? Color::Red : Color::Green).setTextStyle(TextStyle::Bold)
+                    .print(link ? "Linked " : "Deleted ", processedCount, (processedCount == 1 ? " file" : " files"),
+                           failedCount > 0 ? ", failed on " + std::to_string(failedCount) : "");
+        }, true);
+    };
+
+    bool isViewing = true;
+    while (isViewing and app.isRunning()) {
+        const size_t fileCount = marks.size();
+        selectedIndex = std::min(selectedIndex, fileCount == 0 ? 0 : fileCount - 1);
+        ui.renderDuplicates(groups, directory, selectedIndex, marks);
+        Printer::flush();
+
+        switch (Input::getChar()) {
+            case 'j':
+            case keyCode::ArrowDown:
+                if (selectedIndex + 1 < fileCount) {
+                    ++selectedIndex;
+                }
+                break;
+            case 'k':
+            case keyCode::ArrowUp:
+                if (selectedIndex > 0) {
+                    --selectedIndex;
+                }
+                break;
+            case ' ':
+                marks.toggle(selectedIndex);
+                if (selectedIndex + 1 < fileCount) {
+                    ++selectedIndex;
+                }
+                break;
+            case 'a': {
+                // every copy but the first of each group
+                marks.clear();
+                size_t fileIndex = 0;
+                for (const DuplicateGroup& group : groups) {
+                    for (size_t i = 1; i < group.files.size(); ++i) {
+                        marks.select(fileIndex + i);
+                    }
+                    fileIndex += group.files.size();
+                }
+                break;
+            }
+            case 'd': {
+                const std::string markedCount = std::to_string(marks.count());
+                if (not marks.empty() and
+                    confirmAction(app.shouldUseTrash()
+                                      ? "Move the " + markedCount + " marked files to the trash? (y/n) "
+                                      : "Delete the " + markedCount + " marked files permanently? (y/n) ")) {
+                    processMarked(false);
+                } else {
+                    app.setCustomFooter(duplicatesFooter, true);
+                }
+                break;
+            }
+            case 'L':
+                if (not marks.empty() and
+                    confirmAction("Replace the " + std::to_string(marks.count()) +
+                                  " marked files with hard links to their first unmarked copy? (y/n) ")) {
+                    processMarked(true);
+                } else {
+                    app.setCustomFooter(duplicatesFooter, true);
+                }
+                break;
+            case 'q':
+            case 'D':
+            case keyCode::Esc:
+                isViewing = false;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // the duplicates were drawn over the preview
+    ui.clearPreview();
+    if (app.shouldShowPreview()) {
+        ui.renderPreview(app.getCurrentEntry());
+    }
+
+    app.resetFooter();
+}
+
+void InputHandler::handleCompare() const {
+    // suggest the selected directory
+    const fs::directory_entry currentEntry = app.getCurrentEntry();
+    std::string inputBuffer = currentEntry.is_directory() and not FileProperties::Utilities::isDotDot(currentEntry)
+                                  ? currentEntry.path().string()
+                                  : "";
+
+    if (not readInputString("Compare with: ", inputBuffer, EntryType::Directory) or inputBuffer.empty()) {
+        app.resetFooter();
+        return;
+    }
+
+    const fs::path left = app.getCurrentPath();
+    const fs::path right = app.getAbsolutePath(inputBuffer);
+
+    std::error_code error;
+    if (not fs::is_directory(right, error) or fs::equivalent(left, right, error)) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Not another directory!");
+        }, true);
+        return;
+    }
+
+    // filled by the job, read once it's finished
+    const auto entries = std::make_shared<std::vector<ComparedEntry>>();
+
+    const auto compare = [=](ThreadPool& pool, OperationProgress& progress) {
+        *entries = DirectoryComparer::compare(left, right, pool, progress);
+    };
+
+    // the comparison may finish while typing, the differences are only shown once opened from the job list
+    const auto reportComparison = [=](const Job& job) {
+        if (job.state.load() == JobState::Cancelled) {
+            return;
+        }
+
+        const auto differentCount = static_cast<size_t>(std::count_if(
+            entries->begin(), entries->end(), [](const ComparedEntry& entry) {
+                return entry.status != ComparisonStatus::Same;
+            }));
+        App::getInstance().setCustomFooter([=] {
+            Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                    .print("Compared with ", right.string(), ": ", differentCount,
+                           (differentCount == 1 ? " difference" : " differences"));
+            Printer(Color::Yellow).print("  J then l to view");
+        }, false);
+    };
+
+    const auto showComparison = [=] {
+        handleComparison(*entries, left, right);
+    };
+
+    JobQueue::getInstance().submit("Comparing " + left.filename().string() + " with " + right.string(), compare,
+                                   reportComparison, showComparison);
+    app.resetFooter();
+}
+
+void InputHandler::handleComparison(const std::vector<ComparedEntry>& entries, const fs::path& left,
+                                    const fs::path& right) const {
+    UI& ui = UI::getInstance();
+
+    const auto comparisonFooter = [] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("COMPARE  j/k: select  s: show same  >: sync left to right  q: back");
+    };
+    app.setCustomFooter(comparisonFooter, true);
+
+    size_t counts[4]{};
+    size_t copiedCount = 0;
+    for (const ComparedEntry& entry : entries) {
+        ++counts[static_cast<size_t>(entry.status)];
+        copiedCount += entry.status == ComparisonStatus::OnlyLeft or entry.status == ComparisonStatus::Different;
+    }
+    const std::string summary = std::to_string(counts[static_cast<size_t>(ComparisonStatus::OnlyLeft)]) +
+                                " only left  " +
+                                std::to_string(counts[static_cast<size_t>(ComparisonStatus::OnlyRight)]) +
+                                " only right  " +
+                                std::to_string(counts[static_cast<size_t>(ComparisonStatus::Different)]) +
+                                " different  " + std::to_string(counts[static_cast<size_t>(ComparisonStatus::Same)]) +
+                                " same";
+
+    // the entries that are the same on both sides are hidden at first
+    bool showSame = false;
+    std::vector<ComparedEntry> shownEntries;
+    const auto filterEntries = [&] {
+        shownEntries.clear();
+        for (const ComparedEntry& entry : entries) {
+            if (showSame or entry.status != ComparisonStatus::Same) {
+                shownEntries.push_back(entry);
+            }
+        }
+    };
+    filterEntries();
+
+    size_t selectedIndex = 0;
+    bool isViewing = true;
+    while (isViewing and app.isRunning()) {
+        selectedIndex = std::min(selectedIndex, shownEntries.empty() ? 0 : shownEntries.size() - 1);
+        ui.renderComparison(shownEntries, left, right, selectedIndex, summary);
+        Printer::flush();
+
+        switch (Input::getChar()) {
+            case 'j':
+            case keyCode::ArrowDown:
+                if (selectedIndex + 1 < shownEntries.size()) {
+                    ++selectedIndex;
+                }
+                break;
+            case 'k':
+            case keyCode::ArrowUp:
+                if (selectedIndex > 0) {
+                    --selectedIndex;
+                }
+                break;
+            case 's':
+                showSame = not showSame;
+                filterEntries();
+                selectedIndex = 0;
+                break;
+            case '>': {
+                if (copiedCount == 0 or
+                    not confirmAction("Copy the " + std::to_string(copiedCount) + " new and changed entries to " +
+                                      right.string() + "? (y/n) ")) {
+                    app.setCustomFooter(comparisonFooter, true);
+                    break;
+                }
+
+                // the view closes while the sync runs, it's out of date once it's done
+                const auto sharedEntries = std::make_shared<std::vector<ComparedEntry>>(entries);
+                JobQueue::getInstance().submit("Syncing " + right.string(), [=](ThreadPool& pool,
+                                                                                OperationProgress& progress) {
+                    DirectoryComparer::sync(left, right, *sharedEntries, pool, progress);
+                }, [=](const Job&) {
+                    App& app = App::getInstance();
+
+                    // the listing shows the synced entries if it's inside the synced directory
+                    const fs::path& currentPath = app.getCurrentPath();
+                    const auto [rightEnd, currentEnd] = std::mismatch(right.begin(), right.end(),
+                                                                      currentPath.begin(), currentPath.end());
+                    if (rightEnd == right.end()) {
+                        app.updateEntries(true);
+                    }
+
+                    app.setCustomFooter([=] {
+                        Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                                .print("Synced ", copiedCount, (copiedCount == 1 ? " entry" : " entries"), " to ",
+                                       right.string());
+                    }, false);
+                });
+
+                isViewing = false;
+                break;
+            }
+            case 'q':
+            case 'C':
+            case keyCode::Esc:
+                isViewing = false;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // the comparison was drawn over everything
+    app.resetFooter(false);
+    app.initializeTerminal();
+}
+
+void InputHandler::handleJump() const {
+    UI& ui = UI::getInstance();
+    JumpDatabase& database = JumpDatabase::getInstance();
+
+    std::string query;
+    size_t selectedIndex = 0;
+    std::vector<fs::path> directories;
+
+    Cursor::show();
+    app.setCustomFooter([&] {
+        Printer(Color::Blue).setTextStyle(TextStyle::Bold).print("Jump to: ", query);
+    }, false);
+
+    // the directories are ranked again after every key
+    bool isTakingInput = true;
+    bool jumping = false;
+    while (isTakingInput) {
+        directories = database.query(query, ui.getPageSize(), app.getCurrentPath());
+        selectedIndex = std::min(selectedIndex, directories.empty() ? 0 : directories.size() - 1);
+
+        ui.renderJumpResults(directories, selectedIndex);
+        ui.renderFooter(app);
+        Printer::flush();
+
+        switch (const char c = Input::getChar()) {
+            case keyCode::Enter:
+                jumping = not directories.empty();
+                isTakingInput = false;
+                break;
+            case keyCode::Esc:
+                isTakingInput = false;
+                break;
+            case keyCode::ArrowDown:
+            case keyCode::Tab:
+                if (selectedIndex + 1 < directories.size()) {
+                    ++selectedIndex;
+                }
+                break;
+            case keyCode::ArrowUp:
+                if (selectedIndex > 0) {
+                    --selectedIndex;
+                }
+                break;
+            case keyCode::Backspace:
+                if (not query.empty()) {
+                    query.pop_back();
+                    selectedIndex = 0;
+                }
+                break;
+            default:
+                if (isprint(c)) {
+                    query.push_back(c);
+                    selectedIndex = 0;
+                }
+        }
+    }
+
+    Cursor::hide();
+    app.resetFooter(false);
+
+    // the results were drawn over the preview
+    ui.clearPreview();
+    if (app.shouldShowPreview()) {
+        ui.renderPreview(app.getCurrentEntry());
+    }
+
+    if (not jumping) {
+        app.updateUI();
+        return;
+    }
+
+    const fs::path directory = directories[selectedIndex];
+    std::error_code error;
+    if (not fs::is_directory(directory, error)) {
+        // don't offer it again
+        database.remove(directory);
+        app.setCustomFooter([=] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print(directory.string(), " doesn't exist anymore");
+        }, true);
+        return;
+    }
+
+    app.changeDirectory(directory);
+}
+
+void InputHandler::handleTree() const {
+    UI& ui = UI::getInstance();
+
+    DirectoryTree tree(app.getCurrentPath(), app.shouldShowHiddenEntries());
+    uint32_t selectedNode = tree.getFirst();
+    if (selectedNode == DirectoryTree::noNode) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Nothing to show in a tree!");
+        }, true);
+        return;
+    }
+
+    const auto treeFooter = [] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("TREE  j/k: select  l: expand  h: collapse  Enter: go to  q: back");
+    };
+    app.setCustomFooter(treeFooter, false);
+
+    // the window starts at `topNode` and the selected node is on its `selectedRow`th row
+    uint32_t topNode = selectedNode;
+    size_t selectedRow = 0;
+
+    // brings the selected node back into the window, only walking the window's rows
+    const auto scrollToSelected = [&] {
+        topNode = tree.getVisibleAncestor(topNode);
+
+        size_t row = 0;
+        for (uint32_t node = topNode; node != DirectoryTree::noNode and row < ui.getPageSize();
+             node = tree.getNext(node), ++row) {
+            if (node == selectedNode) {
+                selectedRow = row;
+                return;
+            }
+        }
+
+        topNode = selectedNode;
+        selectedRow = 0;
+    };
+
+    const auto selectNext = [&] {
+        if (const uint32_t next = tree.getNext(selectedNode); next != DirectoryTree::noNode) {
+            selectedNode = next;
+            if (++selectedRow >= ui.getPageSize()) {
+                topNode = tree.getNext(topNode);
+                --selectedRow;
+            }
+        }
+    };
+
+    bool isViewing = true;
+    bool goingToNode = false;
+    while (isViewing and app.isRunning()) {
+        // the terminal may have been resized
+        if (selectedRow >= ui.getPageSize()) {
+            scrollToSelected();
+        }
+
+        const fs::path selectedPath = tree.getPath(selectedNode);
+        ui.renderTree(tree, topNode, selectedNode);
+        if (app.shouldShowPreview()) {
+            // directories are previewed from the listing, only files are previewed here
+            std::error_code error;
+            const fs::directory_entry selectedEntry(selectedPath, error);
+            if (selectedEntry.is_regular_file(error)) {
+                ui.renderPreview(selectedEntry);
+            } else {
+                ui.clearPreview();
+            }
+        }
+        ui.renderFooter(app);
+        Printer::flush();
+
+        const TreeNode& node = tree.getNode(selectedNode);
+
+        switch (Input::getChar()) {
+            case 'j':
+            case keyCode::ArrowDown:
+                selectNext();
+                break;
+            case 'k':
+            case keyCode::ArrowUp:
+                if (const uint32_t previous = tree.getPrevious(selectedNode); previous != DirectoryTree::noNode) {
+                    selectedNode = previous;
+                    if (selectedRow == 0) {
+                        topNode = selectedNode;
+                    } else {
+                        --selectedRow;
+                    }
+                }
+                break;
+            case 'l':
+            case keyCode::ArrowRight:
+                // an expanded directory is entered
+                if (node.isExpanded) {
+                    selectNext();
+                } else if (node.isDirectory and not tree.expand(selectedNode)) {
+                    app.setCustomFooter([] {
+                        Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Cannot open directory!");
+                    }, false);
+                } else {
+                    app.setCustomFooter(treeFooter, false);
+                }
+                break;
+            case 'h':
+            case keyCode::ArrowLeft:
+                // a collapsed directory or a file selects its parent
+                if (node.isExpanded) {
+                    tree.collapse(selectedNode);
+                } else if (node.depth > 1) {
+                    selectedNode = node.parent;
+                    scrollToSelected();
+                }
+                app.setCustomFooter(treeFooter, false);
+                break;
+            case keyCode::Enter:
+                goingToNode = true;
+                isViewing = false;
+                break;
+            case 'q':
+            case 'T':
+            case keyCode::Esc:
+                isViewing = false;
+                break;
+            default:
+                break;
+        }
+    }
+
+    app.resetFooter(false);
+
+    // go to the selected directory, or select the file in its directory
+    if (goingToNode) {
+        const fs::path selectedPath = tree.getPath(selectedNode);
+        if (tree.getNode(selectedNode).isDirectory) {
+            app.changeDirectory(selectedPath);
+        } else {
+            if (selectedPath.parent_path() != app.getCurrentPath()) {
+                app.changeDirectory(selectedPath.parent_path());
+            }
+            app.setCurrentEntryIndex(app.findEntry(selectedPath).value_or(0));
+        }
+    }
+
+    // the tree was drawn over the entries
+    app.initializeTerminal();
+}
 
-InputHandler::InputHandler()
-    : app(App::getInstance()) {}
+void InputHandler::handleNewTab() const {
+    app.openTab();
+}
 
-void InputHandler::handleUp() const {
-    app.decrementCurrentEntryIndex();
+void InputHandler::handleCloseTab() const {
+    if (app.getTabCount() == 1) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Can't close the last tab");
+        }, true);
+        return;
+    }
+
+    app.closeTab();
 }
 
-void InputHandler::handleDown() const {
-    app.incrementCurrentEntryIndex();
+void InputHandler::handleSelectTab(const size_t index) const {
+    app.setTabIndex(index % app.getTabCount());
 }
 
-void InputHandler::handleEnter() const {
-    const fs::directory_entry currentEntry = app.getCurrentEntry();
+void InputHandler::handleYank(const bool cut) const {
+    std::vector<fs::path> paths = app.getSelectedPaths();
 
-    if (currentEntry.is_directory()) {
-        app.changeDirectory(fs::absolute(currentEntry));
-    } else if (currentEntry.is_regular_file() and not FileProperties::Utilities::isExecutable(currentEntry.path())) {
-        if (FileProperties::Utilities::isBinary(currentEntry.path().string())) {
-            FileManager::openFile(fs::absolute(currentEntry));
+    if (paths.empty()) {
+        // the `..` directory can't be copied or moved
+        if (FileProperties::Utilities::isDotDot(app.getCurrentEntry())) {
             return;
         }
+        paths.push_back(app.getCurrentEntry().path());
+    }
 
-        // open the file in the user's editor
-        FileManager::openFileInEditor(fs::absolute(currentEntry));
+    // the marked entries are now in the clipboard
+    app.getSelection().clear();
 
-        // revert the editor's changes to the terminal
-        app.initializeTerminal();
-    }
-}
+    const std::string description = paths.size() == 1
+                                        ? FileProperties::MetaData::getName(fs::directory_entry(paths.front())).string()
+                                        : std::to_string(paths.size()) + " entries";
+    app.setClipboard(std::move(paths), cut);
 
-void InputHandler::handleBack() const {
-    app.changeDirectory(fs::current_path() / "..");
+    app.setCustomFooter([=] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print(cut ? "Cut: " : "Yanked: ", description, "  press P to paste");
+    }, true);
 }
 
-void InputHandler::handleRename() const {
-    // initializing the input buffer to the current file name
-    std::string inputBuffer = FileProperties::MetaData::getName(app.getCurrentEntry()).string();
-
-    // return directly if the user tries to rename the `..` directory (do nothing)
-    if (inputBuffer == "..") {
+void InputHandler::handlePaste() const {
+    if (app.getClipboard().empty()) {
+        app.setCustomFooter([] {
+            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Nothing to paste!");
+        }, true);
         return;
     }
 
-    // return if user cancelled
-    if (not readInputString("New name: ", inputBuffer,
-                            FileProperties::Types::determineEntryType(app.getCurrentEntry()))) {
-        return;
-    }
+    const std::vector<fs::path> sources = app.getClipboard();
+    const bool cut = app.isClipboardCut();
+    const fs::path directory = app.getCurrentPath();
 
-    try {
-        // file entry before renaming
-        const fs::directory_entry oldEntry = app.getCurrentEntry();
-        const fs::path newPath = fs::current_path() / fs::path(inputBuffer);
+    // filled by the job, read once it's finished
+    const auto pastedPaths = std::make_shared<std::vector<fs::path>>();
+    const auto movedSources = std::make_shared<std::vector<fs::path>>();
 
-        // return if the name was not changed
-        if (oldEntry.path() == newPath) {
-            app.resetFooter();
-            return;
+    const std::string description = std::string(cut ? "Moving " : "Copying ") +
+                                    (sources.size() == 1
+                                         ? sources.front().filename().string()
+                                         : std::to_string(sources.size()) + " entries");
+
+    JobQueue::getInstance().submit(description, [=](ThreadPool& pool, OperationProgress& progress) {
+        // the totals give copies an ETA, moves are usually a rename
+        if (not cut) {
+            for (const fs::path& source : sources) {
+                CopyEngine::measure(source, progress);
+            }
         }
 
-        // if entry already exists prompt the user about overriding it
-        if (fs::exists(newPath)) {
-            // return if the answer is not yes
-            if (not confirmAction("Entry already exists override it? (y/n) ")) {
-                app.resetFooter();
-                return;
+        for (const fs::path& source : sources) {
+            // moving an entry to the directory it's already in does nothing
+            if ((cut and source.parent_path() == directory) or progress.cancelled.load()) {
+                continue;
+            }
+
+            const fs::path destination = CopyEngine::getAvailablePath(directory, source.filename());
+
+            if (cut) {
+                CopyEngine::move(source, destination, pool, progress);
+            } else {
+                CopyEngine::copy(source, destination, pool, progress);
+            }
+
+            std::error_code error;
+            if (fs::exists(fs::symlink_status(destination, error))) {
+                pastedPaths->push_back(destination);
+            }
+            if (cut and not fs::exists(fs::symlink_status(source, error))) {
+                movedSources->push_back(source);
             }
         }
+    }, [=](const Job& job) {
+        App& app = App::getInstance();
+        app.updateEntries(true);
 
-        // rename the entry to the specified name
-        fs::rename(oldEntry.path(), newPath);
+        // the moved entries aren't where they were anymore, they can't be pasted again. the ones a cancelled
+        // or failed move left in place stay cut, so pasting again retries them
+        if (cut and app.isClipboardCut()) {
+            std::vector<fs::path> remaining;
+            for (const fs::path& path : app.getClipboard()) {
+                if (std::find(movedSources->begin(), movedSources->end(), path) == movedSources->end()) {
+                    remaining.push_back(path);
+                }
+            }
+
+            if (remaining.empty()) {
+                app.clearClipboard();
+            } else {
+                app.setClipboard(std::move(remaining), true);
+            }
+        }
+
+        const uint64_t items = job.progress.items.load();
+        const uint64_t bytes = job.progress.bytes.load();
 
         app.setCustomFooter([=] {
-            Printer(Color::Green)
-                    .setTextStyle(TextStyle::Bold)
-                    .print("Renamed ", FileProperties::MetaData::getName(oldEntry), " to: ", newPath.filename());
+            Printer(Color::Green).setTextStyle(TextStyle::Bold)
+                    .print(cut ? "Moved " : "Copied ", items, (items == 1 ? " entry" : " entries"),
+                           cut ? "" : " (" + FileProperties::MetaData::formatSize(bytes) + ")");
         }, false);
 
-        // refresh the entries stored
-        app.updateEntries(false);
+        // place the cursor on the first pasted entry if it's still shown
+        if (not pastedPaths->empty() and App::getInstance().getCurrentPath() == directory) {
+            app.setCurrentEntryIndex(app.findEntry(pastedPaths->front()).value_or(0));
+        }
+    });
 
-        // set the cursor to point at the same entry after renaming
-        const int newIndex = FileManager::getIndex(newPath, app.getEntries());
-        app.setCurrentEntryIndex(newIndex);
-    } catch (const fs::filesystem_error&) {
-        app.setCustomFooter([] {
-            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Failed to rename entry!");
-        }, true);
-    }
+    app.resetFooter();
 }
 
-void InputHandler::handleDelete() const {
-    const fs::path targetEntry = FileProperties::MetaData::getName(app.getCurrentEntry());
+void InputHandler::handleJobs() const {
+    JobQueue& jobQueue = JobQueue::getInstance();
+    UI& ui = UI::getInstance();
 
-    // return when trying to delete `..`
-    if (targetEntry.string() == "..") {
-        return;
-    }
+    app.setCustomFooter([] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("JOBS  j/k: select  l: open result  x: cancel  X: cancel all  c: clear finished  q: back");
+    }, true);
 
-    // return if the answer is not yes
-    if (not confirmAction("Are you sure you want to delete \"" + targetEntry.string() + "\"? (y/n) ")) {
-        app.resetFooter();
-        return;
+    size_t selectedIndex = 0;
+    // the finished job whose result is opened once the job list is closed
+    std::shared_ptr<Job> openedJob;
+
+    bool isViewing = true;
+    while (isViewing and app.isRunning()) {
+        const std::vector<std::shared_ptr<Job>> jobs = jobQueue.getJobs();
+        selectedIndex = std::min(selectedIndex, jobs.empty() ? 0 : jobs.size() - 1);
+
+        ui.renderJobs(jobs, selectedIndex);
+        Printer::flush();
+
+        // redraw the progress until a key arrives
+        if (not isInputAvailable(refreshInterval)) {
+            continue;
+        }
+
+        switch (Input::getChar()) {
+            case 'j':
+            case keyCode::ArrowDown:
+                if (selectedIndex + 1 < jobs.size()) {
+                    ++selectedIndex;
+                }
+                break;
+            case 'k':
+            case keyCode::ArrowUp:
+                if (selectedIndex > 0) {
+                    --selectedIndex;
+                }
+                break;
+            case 'x':
+            case 'd':
+                if (not jobs.empty()) {
+                    jobQueue.cancel(jobs[selectedIndex]->id);
+                }
+                break;
+            case 'X':
+                jobQueue.cancelAll();
+                break;
+            case 'c':
+                jobQueue.clearFinished();
+                break;
+            case 'l':
+            case keyCode::ArrowRight:
+            case keyCode::Enter:
+                if (not jobs.empty() and jobs[selectedIndex]->state.load() == JobState::Done and
+                    jobs[selectedIndex]->onOpen != nullptr) {
+                    openedJob = jobs[selectedIndex];
+                    isViewing = false;
+                }
+                break;
+            case 'q':
+            case 'J':
+            case keyCode::Esc:
+                isViewing = false;
+                break;
+            default:
+                break;
+        }
     }
 
-    try {
-        // if entry is a non empty directory prompt the user about recursively deleting it
-        if (FileProperties::Types::determineEntryType(app.getCurrentEntry()) == EntryType::Directory and
-            not is_empty(app.getCurrentEntry())) {
-            // return if the answer is not yes
-            if (not confirmAction("Directory is not empty, delete it recursively? (y/n) ")) {
-                app.resetFooter();
-                return;
-            }
+    // the job list was drawn over the preview
+    ui.clearPreview();
+    if (app.shouldShowPreview()) {
+        ui.renderPreview(app.getCurrentEntry());
+    }
 
-            const auto deletedEntriess = fs::remove_all(app.getCurrentEntry().path());
+    app.resetFooter();
 
-            app.setCustomFooter([=] {
-                Printer printer(Color::Green);
+    if (openedJob != nullptr) {
+        openedJob->onOpen();
+    }
+}
 
-                printer.setTextStyle(TextStyle::Bold)
-                        .print("Deleted entry: ", targetEntry);
+void InputHandler::handleTrash() const {
+    Trash& trash = Trash::getInstance();
+    UI& ui = UI::getInstance();
+
+    const auto trashFooter = [] {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("TRASH  j/k: select  r: restore  D: delete permanently  E: empty  q: back");
+    };
+    app.setCustomFooter(trashFooter, true);
+
+    std::vector<TrashEntry> entries = trash.list(app.getCurrentPath());
+    size_t selectedIndex = 0;
+
+    bool isViewing = true;
+    while (isViewing and app.isRunning()) {
+        selectedIndex = std::min(selectedIndex, entries.empty() ? 0 : entries.size() - 1);
+        ui.renderTrash(entries, selectedIndex);
+        Printer::flush();
+
+        switch (Input::getChar()) {
+            case 'j':
+            case keyCode::ArrowDown:
+                if (selectedIndex + 1 < entries.size()) {
+                    ++selectedIndex;
+                }
+                break;
+            case 'k':
+            case keyCode::ArrowUp:
+                if (selectedIndex > 0) {
+                    --selectedIndex;
+                }
+                break;
+            case 'r':
+                if (entries.empty()) {
+                    break;
+                }
 
-                if (deletedEntriess > 1) {
-                    printer.print(" and ", deletedEntriess - 1, " other ", (deletedEntriess > 2 ? "entries" : "entry"));
+                try {
+                    const TrashEntry entry = entries[selectedIndex];
+                    trash.restore(entry);
+                    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(selectedIndex));
+
+                    // place the cursor on the restored entry if it's in the current directory
+                    if (const auto index = app.insertEntry(entry.originalPath)) {
+                        app.setCurrentEntryIndex(*index);
+                    }
+
+                    app.setCustomFooter([=] {
+                        Printer(Color::Green).setTextStyle(TextStyle::Bold).print("Restored: ", entry.originalPath);
+                    }, true);
+                } catch (const fs::filesystem_error& error) {
+                    app.setCustomFooter([message = std::string(error.what())] {
+                        Printer(Color::Red).setTextStyle(TextStyle::Bold).print(message);
+                    }, true);
                 }
-            }, false);
-        } else {
-            fs::remove(app.getCurrentEntry().path());
-            app.setCustomFooter([=] {
-                Printer(Color::Green).setTextStyle(TextStyle::Bold).print("Deleted entry: ", targetEntry);
-            }, false);
+                break;
+            case 'D':
+                if (not entries.empty() and
+                    confirmAction("Delete \"" + entries[selectedIndex].originalPath.filename().string() +
+                                  "\" permanently? (y/n) ")) {
+                    trash.purge({entries[selectedIndex]});
+                    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(selectedIndex));
+                }
+                app.setCustomFooter(trashFooter, true);
+                break;
+            case 'E':
+                if (not entries.empty() and
+                    confirmAction("Delete the " + std::to_string(entries.size()) +
+                                  " entries in the trash permanently? (y/n) ")) {
+                    trash.purge(std::move(entries));
+                    entries.clear();
+                }
+                app.setCustomFooter(trashFooter, true);
+                break;
+            case 'q':
+            case 'u':
+            case keyCode::Esc:
+                isViewing = false;
+                break;
+            default:
+                break;
         }
+    }
 
-        // refresh entries
-        app.updateEntries(true);
-    } catch (const fs::filesystem_error&) {
-        app.setCustomFooter([] {
-            Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Failed to delete entry!");
-        }, true);
+    // the trash was drawn over the preview
+    ui.clearPreview();
+    if (app.shouldShowPreview()) {
+        ui.renderPreview(app.getCurrentEntry());
     }
+
+    app.resetFooter();
 }
 
 void InputHandler::handleTogglePreview() const {
     app.setShowPreview(not app.shouldShowPreview());
 }
 
+void InputHandler::handleToggleColumns() const {
+    app.setShowColumns(not app.shouldShowColumns());
+}
+
+void InputHandler::handleScrollPreview() const {
+    const EntryType entryType = FileProperties::Types::determineEntryType(app.getCurrentEntry());
+
+    // only files shown in the preview can be scrolled
+    if (not app.shouldShowPreview() or (entryType != EntryType::RegularFile and entryType != EntryType::Executable)) {
+        return;
+    }
+
+    // binary files are shown as hex and are scrolled by byte offsets
+    const bool isBinary = FileProperties::Utilities::isBinary(app.getCurrentEntry().path().string());
+
+    UI& ui = UI::getInstance();
+    ui.startPreviewScroll();
+
+    const auto scrollFooter = [] {
+        if (UI::getInstance().isPreviewScrollPending()) {
+            Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                    .print("PREVIEW  indexing the file up to the line...  j/k: scroll instead  q: back");
+            return;
+        }
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold)
+                .print("PREVIEW  j/k: scroll  Space/b: page  g/G: top/end  :: go to line  q: back");
+    };
+    app.setCustomFooter(scrollFooter, true);
+
+    bool isScrolling = true;
+    while (isScrolling and app.isRunning()) {
+        // a line jumped to is gone to once the file is indexed up to it, without holding up the keys
+        if (ui.isPreviewScrollPending() and not isInputAvailable(refreshInterval)) {
+            ui.resolvePendingPreviewScroll();
+            app.updateUI();
+            continue;
+        }
+
+        switch (Input::getChar()) {
+            case 'j':
+            case keyCode::ArrowDown:
+                ui.scrollPreview(PreviewScroll::LineDown);
+                break;
+            case 'k':
+            case keyCode::ArrowUp:
+                ui.scrollPreview(PreviewScroll::LineUp);
+                break;
+            case ' ':
+            case 'f':
+                ui.scrollPreview(PreviewScroll::PageDown);
+                break;
+            case 'b':
+                ui.scrollPreview(PreviewScroll::PageUp);
+                break;
+            case 'g':
+                ui.scrollPreview(PreviewScroll::Top);
+                break;
+            case 'G':
+                ui.scrollPreview(PreviewScroll::End);
+                break;
+            case ':': {
+                std::string inputBuffer;
+
+                if (not readInputString(isBinary ? "Go to offset: " : "Go to line: ", inputBuffer,
+                                        EntryType::RegularFile)) {
+                    app.setCustomFooter(scrollFooter, false);
+                    break;
+                }
+
+                try {
+                    if (isBinary) {
+                        // offsets are decimal or `0x` prefixed hex
+                        ui.scrollPreview(PreviewScroll::GoToOffset, std::stoull(inputBuffer, nullptr, 0));
+                    } else if (std::all_of(inputBuffer.begin(), inputBuffer.end(), ::isdigit)) {
+                        // lines are shown 1-based
+                        const uint64_t line = std::stoull(inputBuffer);
+                        ui.scrollPreview(PreviewScroll::GoToLine, line > 0 ? line - 1 : 0);
+                    }
+                } catch (const std::logic_error&) {} // ignore invalid or out of range numbers
+
+                app.setCustomFooter(scrollFooter, false);
+                break;
+            }
+            case 'q':
+            case 'v':
+            case keyCode::Esc:
+                isScrolling = false;
+                break;
+            default:
+                break;
+        }
+
+        app.updateUI();
+    }
+
+    app.resetFooter();
+}
+
 void InputHandler::handleToggleSearch() const {
     std::string inputBuffer = app.getSearchQuery();
 
@@ -190,17 +1547,19 @@ void InputHandler::handleMakeDirectory() const {
         return;
     }
 
+    // the name is relative to the tab's directory and not to the working directory
+    const fs::path path = app.getAbsolutePath(inputBuffer);
     bool directoryCreated;
 
     try {
-        if (fs::exists(inputBuffer)) {
+        if (fs::exists(path)) {
             app.setCustomFooter([] {
                 Printer(Color::Red).setTextStyle(TextStyle::Bold).print("File already exists!");
             }, true);
             return;
         }
 
-        directoryCreated = fs::create_directory(fs::path(inputBuffer));
+        directoryCreated = fs::create_directory(path);
     } catch (const fs::filesystem_error&) {
         directoryCreated = false;
     }
@@ -210,11 +1569,8 @@ void InputHandler::handleMakeDirectory() const {
             Printer(Color::Green).setTextStyle(TextStyle::Bold).print("Created directory: ", inputBuffer);
         }, false);
 
-        app.updateEntries(false);
-
         // place cursor on the newly created directory
-        const int newIndex = FileManager::getIndex(fs::absolute(inputBuffer), app.getEntries());
-        app.setCurrentEntryIndex(newIndex);
+        app.setCurrentEntryIndex(app.insertEntry(path).value_or(0));
     } else {
         app.setCustomFooter([] {
             Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Failed to create directory!");
@@ -229,23 +1585,23 @@ void InputHandler::handleCreateFile() const {
         return;
     }
 
-    if (fs::exists(inputBuffer)) {
+    // the name is relative to the tab's directory and not to the working directory
+    const fs::path path = app.getAbsolutePath(inputBuffer);
+
+    if (fs::exists(path)) {
         app.setCustomFooter([] {
             Printer(Color::Red).setTextStyle(TextStyle::Bold).print("File already exists!");
         }, true);
         return;
     }
 
-    if (std::ofstream(inputBuffer).is_open()) {
+    if (std::ofstream(path).is_open()) {
         app.setCustomFooter([=] {
             Printer(Color::Green).setTextStyle(TextStyle::Bold).print("Created file: ", inputBuffer);
         }, false);
 
-        app.updateEntries(false);
-
         // place cursor on the newly created file
-        const int fileIndex = FileManager::getIndex(fs::absolute(inputBuffer), app.getEntries());
-        app.setCurrentEntryIndex(fileIndex);
+        app.setCurrentEntryIndex(app.insertEntry(path).value_or(0));
     } else {
         app.setCustomFooter([] {
             Printer(Color::Red).setTextStyle(TextStyle::Bold).print("Failed to create file!");
@@ -259,9 +1615,109 @@ void InputHandler::handleToggleHideEntries() const {
 }
 
 void InputHandler::handleQuit() const {
+    // quitting stops the running jobs halfway
+    if (JobQueue::getInstance().hasActiveJobs()) {
+        if (not confirmAction("Jobs are still running, cancel them and quit? (y/n) ")) {
+            app.resetFooter();
+            return;
+        }
+        JobQueue::getInstance().cancelAll();
+    }
+
     app.quit();
 }
 
+void InputHandler::waitForInput() const {
+    const JobQueue& jobQueue = JobQueue::getInstance();
+
+    while (app.isRunning()) {
+        handleFinishedJobs();
+        app.handlePendingResize();
+
+        if (isInputAvailable(refreshInterval)) {
+            return;
+        }
+
+        // redraw the progress of the running job
+        if (jobQueue.hasActiveJobs()) {
+            app.updateUI();
+        }
+    }
+}
+
+void InputHandler::handleFinishedJobs() const {
+    for (const std::shared_ptr<Job>& job : JobQueue::getInstance().takeFinishedJobs()) {
+        // updates the listing for what the job changed
+        if (job->onFinished != nullptr) {
+            job->onFinished(*job);
+        }
+
+        // show what went wrong instead of the job's result
+        if (job->state.load() == JobState::Cancelled) {
+            app.setCustomFooter([description = job->description] {
+                Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print("Cancelled: ", description);
+            }, false);
+        } else if (const uint64_t errors = job->progress.errors.load(); errors > 0) {
+            app.setCustomFooter([firstError = job->progress.getFirstError(), errors] {
+                Printer printer(Color::Red);
+                printer.setTextStyle(TextStyle::Bold).print(firstError);
+
+                if (errors > 1) {
+                    printer.print(" and ", errors - 1, " other ", (errors > 2 ? "errors" : "error"));
+                }
+            }, false);
+        }
+
+        app.updateUI();
+    }
+}
+
+void InputHandler::schedulePrefetch() const {
+    const std::vector<fs::directory_entry>& entries = app.getEntries();
+    const size_t index = app.getCurrentEntryIndex();
+
+    if (index >= entries.size()) {
+        return;
+    }
+
+    const UI& ui = UI::getInstance();
+
+    PrefetchRequest request;
+    request.listingOptions = app.getListingOptions(UI::maxPreviewReadEntries);
+    std::tie(request.thumbnailWidth, request.thumbnailHeight) = ui.getThumbnailSize();
+
+    // the previews of the entries the cursor moves to next, wrapping around like moving up and down does
+    if (app.shouldShowPreview() and entries.size() > 1) {
+        for (const size_t neighbor : {(index + 1) % entries.size(), (index + entries.size() - 1) % entries.size()}) {
+            const fs::directory_entry& entry = entries[neighbor];
+            if (FileProperties::Utilities::isDotDot(entry)) {
+                continue;
+            }
+
+            std::error_code error;
+            const bool isDirectory = entry.is_directory(error);
+            request.neighbors.push_back({
+                entry.path(), isDirectory, isDirectory ? ui.getPreviewEntryCount(app.getCachedIndex(entry.path())) : 0
+            });
+        }
+    }
+
+    // the entries shown when scrolling past the bottom of the list
+    const size_t pageEnd = std::min(index + 1 + ui.getPageSize(), entries.size());
+    for (size_t i = index + 1; i < pageEnd; ++i) {
+        request.nextPage.push_back(entries[i].path());
+    }
+
+    Prefetcher::getInstance().schedule(std::move(request));
+}
+
+bool InputHandler::isInputAvailable(const int timeout) {
+    pollfd input{STDIN_FILENO, POLLIN, 0};
+    const int ready = poll(&input, 1, timeout);
+    // interrupted by a signal, like a resize, which the caller handles before waiting again
+    return ready > 0 or (ready < 0 and errno != EINTR);
+}
+
 [[nodiscard]] Action InputHandler::getAction(const char input) {
     if (const auto it = keyMap.find(input); it != keyMap.end())
         return it->second;
@@ -333,64 +1789,152 @@ void InputHandler::inputLoop() const {
             iterations = 0;
         }
 
-        switch (getAction(Input::getChar())) {
-            case Action::Up:
-                handleUp();
-                break;
-            case Action::Down:
-                handleDown();
-                break;
-            case Action::Enter:
-                handleEnter();
-                break;
-            case Action::Back:
-                handleBack();
-                break;
-            case Action::Rename:
-                handleRename();
-                iterations = 1;
-                break;
-            case Action::Delete:
-                handleDelete();
-                iterations = 1;
-                break;
-            case Action::MakeDirectory:
-                handleMakeDirectory();
-                iterations = 1;
-                break;
-            case Action::CreateFile:
-                handleCreateFile();
-                iterations = 1;
-                break;
-            case Action::ToggleSortByTime:
-                handleToggleSortByTime();
-                break;
-            case Action::ToggleSortBySize:
-                handleToggleSortBySize();
-                break;
-            case Action::ToggleReverseEntries:
-                handleToggleReverseEntries();
-                break;
-            case Action::ToggleHideEntries:
-                handleToggleHideEntries();
-                break;
-            case Action::TogglePreview:
-                handleTogglePreview();
-                break;
-            case Action::ToggleSearch:
-                handleToggleSearch();
-                break;
-            case Action::Quit:
-                handleQuit();
-                break;
-            case Action::ESC:
-                if (app.resetSearchQuery()) {
-                    app.updateEntries(true);
-                }
-                break;
-            default:
-                break;
-        }
+        schedulePrefetch();
+        waitForInput();
+        const char input = Input::getChar();
+
+        // stop prefetching as soon as a key arrives
+        Prefetcher::getInstance().cancel();
+
+        handleAction(input, iterations);
+    }
+}
+
+void InputHandler::handleAction(const char input, int& iterations) const {
+    const Trace::Span span("handleKey");
+
+    switch (getAction(input)) {
+        case Action::Up:
+            handleUp();
+            break;
+        case Action::Down:
+            handleDown();
+            break;
+        case Action::Enter:
+            handleEnter();
+            break;
+        case Action::Back:
+            handleBack();
+            break;
+        case Action::Rename:
+            handleRename();
+            iterations = 1;
+            break;
+        case Action::Delete:
+            handleDelete();
+            iterations = 1;
+            break;
+        case Action::Yank:
+            handleYank(false);
+            iterations = 1;
+            break;
+        case Action::ToggleMark:
+            handleToggleMark();
+            break;
+        case Action::MarkPattern:
+            handleMarkPattern();
+            iterations = 1;
+            break;
+        case Action::ChangePermissions:
+            handleChangePermissions();
+            iterations = 1;
+            break;
+        case Action::Checksum:
+            handleChecksum();
+            iterations = 1;
+            break;
+        case Action::FindDuplicates:
+            handleFindDuplicates();
+            iterations = 1;
+            break;
+        case Action::Compare:
+            handleCompare();
+            iterations = 1;
+            break;
+        case Action::Jump:
+            handleJump();
+            iterations = 1;
+            break;
+        case Action::Tree:
+            handleTree();
+            break;
+        case Action::NewTab:
+            handleNewTab();
+            break;
+        case Action::CloseTab:
+            handleCloseTab();
+            break;
+        case Action::NextTab:
+            handleSelectTab(app.getTabIndex() + 1);
+            break;
+        case Action::PreviousTab:
+            handleSelectTab(app.getTabIndex() + app.getTabCount() - 1);
+            break;
+        case Action::SelectTab:
+            if (const size_t index = input - '1'; index < app.getTabCount()) {
+                handleSelectTab(index);
+            }
+            break;
+        case Action::Cut:
+            handleYank(true);
+            iterations = 1;
+            break;
+        case Action::Paste:
+            handlePaste();
+            iterations = 1;
+            break;
+        case Action::Jobs:
+            handleJobs();
+            break;
+        case Action::Trash:
+            handleTrash();
+            break;
+        case Action::MakeDirectory:
+            handleMakeDirectory();
+            iterations = 1;
+            break;
+        case Action::CreateFile:
+            handleCreateFile();
+            iterations = 1;
+            break;
+        case Action::ToggleSortByTime:
+            handleToggleSortByTime();
+            break;
+        case Action::ToggleSortBySize:
+            handleToggleSortBySize();
+            break;
+        case Action::ToggleReverseEntries:
+            handleToggleReverseEntries();
+            break;
+        case Action::ToggleHideEntries:
+            handleToggleHideEntries();
+            break;
+        case Action::TogglePreview:
+            handleTogglePreview();
+            break;
+        case Action::ToggleColumns:
+            handleToggleColumns();
+            break;
+        case Action::ScrollPreview:
+            handleScrollPreview();
+            break;
+        case Action::ToggleSearch:
+            handleToggleSearch();
+            break;
+        case Action::Quit:
+            handleQuit();
+            break;
+        case Action::ESC:
+            // unmark the entries first, then reset the search
+            if (not app.getSelection().empty()) {
+                app.getSelection().clear();
+                app.updateUI();
+            } else if (app.resetSearchQuery()) {
+                app.updateEntries(true);
+            }
+            break;
+        default:
+            break;
     }
 }
 
@@ -398,3 +1942,9 @@ void InputHandler::handleInput() {
     const InputHandler inputHandler;
     inputHandler.inputLoop();
 }
+
+void InputHandler::handleKey(const char input) {
+    const InputHandler inputHandler;
+    int iterations = 0;
+    inputHandler.handleAction(input, iterations);
+}
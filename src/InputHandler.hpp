@@ -1,6 +1,8 @@
 #pragma once
 
 #include "App.hpp"
+#include "DirectoryComparer.hpp"
+#include "DuplicateFinder.hpp"
 #include "FileProperties.hpp"
 #include "../include/Terminal++/src/Terminal++.hpp"
 
@@ -12,7 +14,28 @@ enum class Action {
     Back,
     Rename,
     Delete,
+    Yank,
+    ToggleMark,
+    MarkPattern,
+    ChangePermissions,
+    Checksum,
+    FindDuplicates,
+    Compare,
+    Jump,
+    Tree,
+    NewTab,
+    CloseTab,
+    NextTab,
+    PreviousTab,
+    SelectTab,
+    Cut,
+    Paste,
+    Jobs,
+    Trash,
+    ToggleTrash,
     TogglePreview,
+    ToggleColumns,
+    ScrollPreview,
     ToggleSortByTime,
     ToggleSortBySize,
     ToggleReverseEntries,
@@ -39,11 +62,33 @@ class InputHandler {
         {'c', Action::CreateFile},
         {'r', Action::Rename},
         {'d', Action::Delete},
+        {'y', Action::Yank},
+        {' ', Action::ToggleMark},
+        {'*', Action::MarkPattern},
+        {'M', Action::ChangePermissions},
+        {'#', Action::Checksum},
+        {'D', Action::FindDuplicates},
+        {'C', Action::Compare},
+        {'z', Action::Jump},
+        {'T', Action::Tree},
+        {'n', Action::NewTab},
+        {'w', Action::CloseTab},
+        {']', Action::NextTab},
+        {'[', Action::PreviousTab},
+        {'1', Action::SelectTab}, {'2', Action::SelectTab}, {'3', Action::SelectTab},
+        {'4', Action::SelectTab}, {'5', Action::SelectTab}, {'6', Action::SelectTab},
+        {'7', Action::SelectTab}, {'8', Action::SelectTab}, {'9', Action::SelectTab},
+        {'x', Action::Cut},
+        {'P', Action::Paste},
+        {'J', Action::Jobs},
+        {'u', Action::Trash},
         {'t', Action::ToggleSortByTime},
         {'s', Action::ToggleSortBySize},
         {'R', Action::ToggleReverseEntries},
         {'H', Action::ToggleHideEntries},
         {'p', Action::TogglePreview},
+        {'L', Action::ToggleColumns},
+        {'v', Action::ScrollPreview},
         {'/', Action::ToggleSearch},
         {keyCode::Esc, Action::ESC},
         {'q', Action::Quit},
@@ -59,19 +104,69 @@ class InputHandler {
     void handleCreateFile() const;
     void handleRename() const;
     void handleDelete() const;
+    // deletes the marked entries as one batch
+    void handleDeleteMarked() const;
+    void handleToggleMark() const;
+    void handleMarkPattern() const;
+    void handleChangePermissions() const;
+    // checksums the marked entries or the current one in the background
+    void handleChecksum() const;
+    // finds the duplicate files under the current directory in the background
+    void handleFindDuplicates() const;
+    // shows the duplicates found under `directory` until closed, the marked copies can be deleted or linked
+    void handleDuplicates(std::vector<DuplicateGroup>& groups, const fs::path& directory) const;
+    // compares the current directory with another one in the background
+    void handleCompare() const;
+    // shows the differences of `left` and `right` side by side until closed, `right` can be synced to `left`
+    void handleComparison(const std::vector<ComparedEntry>& entries, const fs::path& left,
+                          const fs::path& right) const;
+    // jumps to a visited directory matching a query, ranked by how often and how recently it was visited
+    void handleJump() const;
+    // shows the current directory as a tree whose directories expand in place until closed
+    void handleTree() const;
+    // opens a tab on the current directory, or closes the current tab
+    void handleNewTab() const;
+    void handleCloseTab() const;
+    // switches to the tab at `index`, wrapping around past the last one
+    void handleSelectTab(size_t index) const;
+    void handleYank(bool cut) const;
+    void handlePaste() const;
+    void handleJobs() const;
+    void handleTrash() const;
     void handleToggleSortByTime() const;
     void handleToggleSortBySize() const;
     void handleToggleReverseEntries() const;
     void handleToggleHideEntries() const;
     void handleTogglePreview() const;
+    // shows or hides the parent directory's column
+    void handleToggleColumns() const;
+    void handleScrollPreview() const;
     void handleToggleSearch() const;
     void handleQuit() const;
 
+    // waits for a key, refreshing the footer while jobs run, handling the jobs that finish and terminal resizes
+    void waitForInput() const;
+    // refreshes the entries for the finished jobs and shows their results in the footer
+    void handleFinishedJobs() const;
+
+    // snapshots the entries next to the selected one for the prefetcher to warm while input is idle
+    void schedulePrefetch() const;
+
+    // how often the progress of running jobs is redrawn
+    static constexpr int refreshInterval = 250; // milliseconds
+
+    // returns true once a key can be read, or false after `timeout` milliseconds or when a signal interrupts it
+    [[nodiscard]] static bool isInputAvailable(int timeout);
     [[nodiscard]] static Action getAction(char input);
     [[nodiscard]] bool confirmAction(std::string_view, const Color::Code& color = Color::Red) const;
     bool readInputString(std::string_view prompt, std::string& inputBuffer, EntryType entryType) const;
+    // runs the action bound to a key, `iterations` counts the keys since the footer was last reset
+    void handleAction(char input, int& iterations) const;
     void inputLoop() const;
 
 public:
     static void handleInput();
+    // handles a key as if it was typed, without waiting for it, to replay input without a TTY
+    // keys that prompt for more input still read it from the terminal
+    static void handleKey(char input);
 };
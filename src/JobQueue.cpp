@@ -0,0 +1,228 @@
+#include "JobQueue.hpp"
+
+#include <algorithm>
+#include <utility>
+#include "FileProperties.hpp"
+
+namespace {
+    // formats a duration as e.g. "45s", "3m 05s" or "1h 02m"
+    std::string formatDuration(const uint64_t seconds) {
+        const auto twoDigits = [](const uint64_t value) {
+            return (value < 10 ? "0" : "") + std::to_string(value);
+        };
+
+        if (seconds < 60) {
+            return std::to_string(seconds) + "s";
+        }
+        if (seconds < 3600) {
+            return std::to_string(seconds / 60) + "m " + twoDigits(seconds % 60) + "s";
+        }
+        return std::to_string(seconds / 3600) + "h " + twoDigits(seconds / 60 % 60) + "m";
+    }
+}
+
+bool Job::isFinished() const {
+    const JobState currentState = state.load();
+    return currentState == JobState::Done or currentState == JobState::Cancelled;
+}
+
+JobQueue::JobQueue() {
+    // started once every member is initialized
+    runner = std::thread(&JobQueue::run, this);
+}
+
+JobQueue::~JobQueue() {
+    cancelAll();
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_one();
+
+    if (runner.joinable()) {
+        runner.join();
+    }
+}
+
+JobQueue& JobQueue::getInstance() {
+    static JobQueue jobQueue;
+    return jobQueue;
+}
+
+std::shared_ptr<Job> JobQueue::submit(std::string description,
+                                      std::function<void(ThreadPool&, OperationProgress&)> work,
+                                      std::function<void(const Job&)> onFinished,
+                                      std::function<void()> onOpen) {
+    auto job = std::make_shared<Job>();
+    job->description = std::move(description);
+    job->work = std::move(work);
+    job->onFinished = std::move(onFinished);
+    job->onOpen = std::move(onOpen);
+
+    {
+        std::lock_guard lock(mutex);
+        job->id = nextId++;
+        queue.push_back(job);
+        jobs.push_back(job);
+    }
+    jobAvailable.notify_one();
+
+    return job;
+}
+
+void JobQueue::run() {
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        jobAvailable.wait(lock, [this] { return stopping or not queue.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        const std::shared_ptr<Job> job = queue.front();
+        queue.pop_front();
+        lock.unlock();
+
+        job->startTime = Job::Clock::now();
+
+        // jobs cancelled while queued are skipped
+        if (not job->progress.cancelled.load()) {
+            job->state.store(JobState::Running);
+            job->work(pool, job->progress);
+        }
+
+        job->endTime = Job::Clock::now();
+        job->state.store(job->progress.cancelled.load() ? JobState::Cancelled : JobState::Done);
+
+        lock.lock();
+        finishedJobs.push_back(job);
+
+        // drop the oldest finished jobs from the job list
+        size_t finishedCount = std::count_if(jobs.begin(), jobs.end(), [](const auto& listedJob) {
+            return listedJob->isFinished();
+        });
+        for (auto it = jobs.begin(); it != jobs.end() and finishedCount > maxFinishedJobs;) {
+            if ((*it)->isFinished()) {
+                it = jobs.erase(it);
+                --finishedCount;
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool JobQueue::hasActiveJobs() const {
+    std::lock_guard lock(mutex);
+    return std::any_of(jobs.begin(), jobs.end(), [](const auto& job) { return not job->isFinished(); });
+}
+
+std::shared_ptr<Job> JobQueue::getRunningJob() const {
+    std::lock_guard lock(mutex);
+    for (const std::shared_ptr<Job>& job : jobs) {
+        if (job->state.load() == JobState::Running) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+size_t JobQueue::getQueuedCount() const {
+    std::lock_guard lock(mutex);
+    return queue.size();
+}
+
+std::vector<std::shared_ptr<Job>> JobQueue::getJobs() const {
+    std::lock_guard lock(mutex);
+    return jobs;
+}
+
+std::vector<std::shared_ptr<Job>> JobQueue::takeFinishedJobs() {
+    std::lock_guard lock(mutex);
+    return std::exchange(finishedJobs, {});
+}
+
+void JobQueue::cancel(const size_t id) {
+    std::lock_guard lock(mutex);
+    for (const std::shared_ptr<Job>& job : jobs) {
+        if (job->id == id and not job->isFinished()) {
+            job->progress.cancelled.store(true);
+        }
+    }
+}
+
+void JobQueue::cancelAll() {
+    std::lock_guard lock(mutex);
+    for (const std::shared_ptr<Job>& job : jobs) {
+        job->progress.cancelled.store(true);
+    }
+}
+
+void JobQueue::clearFinished() {
+    std::lock_guard lock(mutex);
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const auto& job) { return job->isFinished(); }),
+               jobs.end());
+}
+
+std::string JobQueue::formatProgress(const Job& job) {
+    const JobState state = job.state.load();
+    if (state == JobState::Queued) {
+        return "queued";
+    }
+
+    const OperationProgress& progress = job.progress;
+    const uint64_t items = progress.items.load();
+    const uint64_t bytes = progress.bytes.load();
+    const uint64_t totalItems = progress.totalItems.load();
+    const uint64_t totalBytes = progress.totalBytes.load();
+
+    std::string text = std::to_string(items);
+    if (totalItems > 0) {
+        text += "/" + std::to_string(totalItems);
+    }
+    text += items == 1 and totalItems <= 1 ? " entry" : " entries";
+
+    if (bytes > 0 or totalBytes > 0) {
+        text += "  " + FileProperties::MetaData::formatSize(bytes);
+        if (totalBytes > 0) {
+            text += "/" + FileProperties::MetaData::formatSize(totalBytes);
+        }
+    }
+
+    const Job::Clock::time_point end = state == JobState::Running ? Job::Clock::now() : job.endTime;
+    const double seconds = std::chrono::duration<double>(end - job.startTime).count();
+
+    if (state == JobState::Running) {
+        // the rate isn't meaningful right after starting
+        if (seconds >= 0.5) {
+            const double byteRate = static_cast<double>(bytes) / seconds;
+            const double itemRate = static_cast<double>(items) / seconds;
+
+            if (bytes > 0) {
+                text += "  " + FileProperties::MetaData::formatSize(static_cast<uintmax_t>(byteRate)) + "/s";
+            } else {
+                text += "  " + std::to_string(static_cast<uint64_t>(itemRate)) + " entries/s";
+            }
+
+            // estimate from the bytes when they're known, they dominate the time of copies
+            if (totalBytes > 0 and byteRate > 0) {
+                text += "  ETA " + formatDuration(static_cast<uint64_t>(
+                    static_cast<double>(totalBytes - std::min(bytes, totalBytes)) / byteRate));
+            } else if (totalItems > 0 and itemRate > 0) {
+                text += "  ETA " + formatDuration(static_cast<uint64_t>(
+                    static_cast<double>(totalItems - std::min(items, totalItems)) / itemRate));
+            }
+        }
+    } else {
+        text += state == JobState::Cancelled
+                    ? "  cancelled"
+                    : "  done in " + formatDuration(static_cast<uint64_t>(seconds));
+    }
+
+    if (const uint64_t errors = progress.errors.load(); errors > 0) {
+        text += "  " + std::to_string(errors) + (errors == 1 ? " error" : " errors");
+    }
+
+    return text;
+}
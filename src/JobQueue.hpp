@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+enum class JobState {
+    Queued,
+    Running,
+    Done,
+    Cancelled,
+};
+
+// a file operation running in the background
+struct Job {
+    using Clock = std::chrono::steady_clock;
+
+    size_t id{};
+    std::string description; // e.g. "Deleting build"
+
+    OperationProgress progress;
+    std::atomic<JobState> state{JobState::Queued};
+    // set before the state changes, read once the job is running or finished
+    Clock::time_point startTime;
+    Clock::time_point endTime;
+
+    // does the work on the queue's thread, using the pool for parallel work
+    std::function<void(ThreadPool&, OperationProgress&)> work;
+    // runs on the input thread once the job is finished, e.g. to show the result and refresh the entries
+    std::function<void(const Job&)> onFinished;
+    // opens the result of the finished job from the job list, e.g. the duplicates it found
+    std::function<void()> onOpen;
+
+    [[nodiscard]] bool isFinished() const;
+};
+
+// runs file operations one after the other on a background thread, so long deletes and copies
+// don't block input; every job shares the same worker pool for its parallel work
+class JobQueue {
+    ThreadPool pool;
+
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+
+    // jobs waiting to run, in submission order
+    std::deque<std::shared_ptr<Job>> queue;
+    // every job shown in the job list, the oldest finished ones are dropped
+    std::vector<std::shared_ptr<Job>> jobs;
+    // finished jobs whose `onFinished` wasn't run yet
+    std::vector<std::shared_ptr<Job>> finishedJobs;
+
+    size_t nextId = 1;
+    bool stopping{};
+
+    std::thread runner;
+
+    JobQueue();
+    ~JobQueue();
+
+    // runs the queued jobs, runs on `runner`
+    void run();
+
+public:
+    // number of finished jobs kept in the job list
+    static constexpr size_t maxFinishedJobs = 16;
+
+    JobQueue(const JobQueue&) = delete;
+
+    // queues a job, it starts once the jobs before it are finished
+    std::shared_ptr<Job> submit(std::string description, std::function<void(ThreadPool&, OperationProgress&)> work,
+                                std::function<void(const Job&)> onFinished = nullptr,
+                                std::function<void()> onOpen = nullptr);
+
+    // whether a job is running or waiting to run
+    [[nodiscard]] bool hasActiveJobs() const;
+    // the running job, or nullptr
+    [[nodiscard]] std::shared_ptr<Job> getRunningJob() const;
+    [[nodiscard]] size_t getQueuedCount() const;
+    // every job in the job list, oldest first
+    [[nodiscard]] std::vector<std::shared_ptr<Job>> getJobs() const;
+    // returns the jobs finished since the last call
+    std::vector<std::shared_ptr<Job>> takeFinishedJobs();
+
+    // stops a running job as soon as possible, or skips a queued one
+    void cancel(size_t id);
+    void cancelAll();
+    // removes the finished jobs from the job list
+    void clearFinished();
+
+    // formats the progress of a job, e.g. "120/4000 entries  1.2 GB/3 GB  85 MB/s  ETA 12s"
+    static std::string formatProgress(const Job& job);
+
+    static JobQueue& getInstance();
+};
@@ -0,0 +1,329 @@
+#include "JumpDatabase.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+    std::string toLowercase(std::string_view text) {
+        std::string lowercase(text);
+        std::transform(lowercase.begin(), lowercase.end(), lowercase.begin(), [](const unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return lowercase;
+    }
+
+    // index of the last component of a path
+    size_t getNameStart(const std::string_view path) {
+        return path.find_last_of('/') + 1;
+    }
+
+    // whether the path contains the words in order, with the last one in its last component
+    bool isMatch(const std::string_view path, const std::vector<std::string>& words) {
+        if (words.empty()) {
+            return true;
+        }
+
+        size_t position = 0;
+        for (size_t i = 0; i + 1 < words.size(); ++i) {
+            position = path.find(words[i], position);
+            if (position == std::string_view::npos) {
+                return false;
+            }
+            position += words[i].size();
+        }
+
+        return path.find(words.back(), std::max(position, getNameStart(path))) != std::string_view::npos;
+    }
+}
+
+JumpDatabase::JumpDatabase() {
+    if (const char* dataHome = std::getenv("XDG_DATA_HOME"); dataHome != nullptr and *dataHome != '\0') {
+        databasePath = fs::path(dataHome) / "BFileX" / "directories";
+    } else if (const char* home = std::getenv("HOME"); home != nullptr and *home != '\0') {
+        databasePath = fs::path(home) / ".local" / "share" / "BFileX" / "directories";
+    }
+}
+
+JumpDatabase& JumpDatabase::getInstance() {
+    static JumpDatabase database;
+    return database;
+}
+
+void JumpDatabase::load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    std::ifstream file(databasePath);
+
+    std::string line;
+    while (std::getline(file, line)) {
+        ++lineCount;
+
+        // `<time>\t<rank>\t<path>`, lines that don't parse are dropped by the next compaction
+        char* timeEnd = nullptr;
+        const long long time = std::strtoll(line.c_str(), &timeEnd, 10);
+        if (*timeEnd != '\t') {
+            continue;
+        }
+
+        char* rankEnd = nullptr;
+        const double rank = std::strtod(timeEnd + 1, &rankEnd);
+        if (*rankEnd != '\t' or rankEnd[1] == '\0') {
+            continue;
+        }
+
+        apply(std::string(rankEnd + 1), rank, static_cast<time_t>(time));
+    }
+
+    if (lineCount > indices.size() + compactionSlack) {
+        compact();
+    }
+}
+
+void JumpDatabase::apply(const std::string& path, const double rank, const time_t time) {
+    const auto it = indices.find(path);
+
+    if (rank <= 0) {
+        if (it == indices.end()) {
+            return;
+        }
+
+        // blank its name so queries don't find it, it's removed when the log is compacted
+        Directory& directory = directories[it->second];
+        directory.rank = 0;
+        std::fill_n(lowercaseNames.begin() + static_cast<ptrdiff_t>(directory.nameOffset),
+                    directory.path.size() - getNameStart(directory.path), '\n');
+        indices.erase(it);
+        return;
+    }
+
+    if (it == indices.end()) {
+        indices.emplace(path, directories.size());
+        directories.push_back({path, lowercaseNames.size(), rank, time});
+        lowercaseNames += toLowercase(std::string_view(path).substr(getNameStart(path)));
+        lowercaseNames += '\n';
+        return;
+    }
+
+    Directory& directory = directories[it->second];
+    directory.rank += rank;
+    directory.lastVisit = std::max(directory.lastVisit, time);
+}
+
+void JumpDatabase::append(const std::string& path, const double rank, const time_t time) {
+    if (databasePath.empty()) {
+        return;
+    }
+
+    int descriptor = open(databasePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (descriptor < 0 and errno == ENOENT) {
+        std::error_code error;
+        fs::create_directories(databasePath.parent_path(), error);
+        descriptor = open(databasePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    }
+    if (descriptor < 0) {
+        return;
+    }
+
+    // a single write, so the lines of several instances appending at once don't interleave
+    char prefix[64];
+    const int prefixLength = std::snprintf(prefix, sizeof(prefix), "%lld\t%g\t", static_cast<long long>(time), rank);
+    const std::string line = std::string(prefix, prefixLength) + path + '\n';
+
+    if (write(descriptor, line.data(), line.size()) == static_cast<ssize_t>(line.size())) {
+        ++lineCount;
+    }
+    close(descriptor);
+}
+
+void JumpDatabase::compact() {
+    double totalRank = 0;
+    for (const Directory& directory : directories) {
+        totalRank += directory.rank;
+    }
+
+    // age the ranks
+    if (totalRank > maxTotalRank) {
+        const double factor = 0.9 * maxTotalRank / totalRank;
+        for (Directory& directory : directories) {
+            directory.rank *= factor;
+        }
+    }
+
+    // drop the forgotten directories and the ones that fell below a single visit
+    std::vector<Directory> remainingDirectories;
+    for (Directory& directory : directories) {
+        if (directory.rank >= 1) {
+            remainingDirectories.push_back(std::move(directory));
+        }
+    }
+
+    directories.clear();
+    lowercaseNames.clear();
+    indices.clear();
+    for (const Directory& directory : remainingDirectories) {
+        apply(directory.path, directory.rank, directory.lastVisit);
+    }
+
+    if (databasePath.empty()) {
+        return;
+    }
+
+    // write the compacted log next to the old one and rename it over it
+    const fs::path temporaryPath = databasePath.string() + "." + std::to_string(getpid());
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        for (const Directory& directory : directories) {
+            file << static_cast<long long>(directory.lastVisit) << '\t' << directory.rank << '\t' << directory.path
+                    << '\n';
+        }
+
+        if (file.flush() and std::rename(temporaryPath.c_str(), databasePath.c_str()) == 0) {
+            lineCount = indices.size();
+            return;
+        }
+    }
+
+    std::error_code error;
+    fs::remove(temporaryPath, error);
+}
+
+double JumpDatabase::score(const Directory& directory, const time_t now) {
+    const time_t age = now - directory.lastVisit;
+
+    if (age < 60 * 60) {
+        return directory.rank * 4;
+    }
+    if (age < 24 * 60 * 60) {
+        return directory.rank * 2;
+    }
+    if (age < 7 * 24 * 60 * 60) {
+        return directory.rank / 2;
+    }
+    return directory.rank / 4;
+}
+
+void JumpDatabase::addVisit(const fs::path& path) {
+    load();
+
+    // a line per visit, paths with line breaks can't be stored
+    const std::string pathString = path.string();
+    if (pathString.find('\n') != std::string::npos) {
+        return;
+    }
+
+    const time_t now = std::time(nullptr);
+    apply(pathString, 1, now);
+    append(pathString, 1, now);
+
+    if (lineCount > indices.size() + compactionSlack) {
+        compact();
+    }
+}
+
+void JumpDatabase::remove(const fs::path& path) {
+    load();
+
+    const std::string pathString = path.string();
+    if (indices.count(pathString) == 0) {
+        return;
+    }
+
+    // a rank of 0 forgets the directory when the log is read again
+    apply(pathString, 0, 0);
+    append(pathString, 0, std::time(nullptr));
+}
+
+std::vector<fs::path> JumpDatabase::query(const std::string_view query, const size_t count, const fs::path& exclude) {
+    load();
+
+    // the words of the query, matched ignoring case
+    std::vector<std::string> words;
+    const std::string lowercaseQuery = toLowercase(query);
+    for (size_t start = 0; start < lowercaseQuery.size();) {
+        const size_t end = std::min(lowercaseQuery.find(' ', start), lowercaseQuery.size());
+        if (end > start) {
+            words.push_back(lowercaseQuery.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+
+    const time_t now = std::time(nullptr);
+    const std::string excludedPath = exclude.string();
+
+    // the best matches found so far in a heap, the worst of them first
+    using Match = std::pair<double, const Directory*>;
+    const auto isBetter = [](const Match& first, const Match& second) {
+        return first.first != second.first ? first.first > second.first : first.second->path < second.second->path;
+    };
+    std::vector<Match> matches;
+    matches.reserve(count + 1);
+
+    const auto addMatch = [&](const Directory& directory) {
+        if (count == 0 or directory.rank <= 0 or directory.path == excludedPath) {
+            return;
+        }
+
+        const Match match{score(directory, now), &directory};
+        if (matches.size() < count) {
+            matches.push_back(match);
+            std::push_heap(matches.begin(), matches.end(), isBetter);
+        } else if (isBetter(match, matches.front())) {
+            std::pop_heap(matches.begin(), matches.end(), isBetter);
+            matches.back() = match;
+            std::push_heap(matches.begin(), matches.end(), isBetter);
+        }
+    };
+
+    if (words.empty()) {
+        for (const Directory& directory : directories) {
+            addMatch(directory);
+        }
+    } else {
+        // the last word is in the name of every directory matching, so the names are searched for it
+        // and only the directories it's found in are checked for the other words
+        const std::string& lastWord = words.back();
+        const char* const begin = lowercaseNames.data();
+        const char* const end = begin + lowercaseNames.size();
+
+        size_t index = 0;
+        const char* position = begin;
+        while (const void* found = memmem(position, end - position, lastWord.data(), lastWord.size())) {
+            const size_t offset = static_cast<const char*>(found) - begin;
+
+            // the directories are in the order of their names
+            while (index + 1 < directories.size() and directories[index + 1].nameOffset <= offset) {
+                ++index;
+            }
+
+            const Directory& directory = directories[index];
+            if (words.size() == 1 or isMatch(toLowercase(directory.path), words)) {
+                addMatch(directory);
+            }
+
+            // continue with the next name
+            if (index + 1 == directories.size()) {
+                break;
+            }
+            position = begin + directories[index + 1].nameOffset;
+        }
+    }
+
+    std::sort_heap(matches.begin(), matches.end(), isBetter);
+
+    std::vector<fs::path> results;
+    results.reserve(matches.size());
+    for (const auto& [score, directory] : matches) {
+        results.emplace_back(directory->path);
+    }
+    return results;
+}
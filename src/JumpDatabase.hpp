@@ -0,0 +1,70 @@
+#pragma once
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// remembers the visited directories to jump back to them by a part of their path, ranked by frecency:
+// how often and how recently they were visited, like `zoxide`
+// visits are appended to a log in `$XDG_DATA_HOME/BFileX/directories`, one `<time>\t<rank>\t<path>` line per
+// visit, tab-separated so paths can hold spaces, which is rewritten with one line per directory once it grows
+// too long. the ranks of all the directories are scaled down when their sum passes `maxTotalRank`, forgetting
+// the ones rarely visited
+// only used from the input thread
+class JumpDatabase {
+    struct Directory {
+        std::string path;
+        size_t nameOffset{}; // of the lowercase name in `lowercaseNames`
+        double rank{};       // 0 once forgotten
+        time_t lastVisit{};
+    };
+
+    fs::path databasePath;
+    bool loaded{};
+
+    // in the order they were first visited, the forgotten ones stay until the log is compacted
+    std::vector<Directory> directories;
+    // the lowercase names of `directories` one after the other, each followed by a line break; the last
+    // word of a query is searched in all of them at once, only the directories it's found in are looked at
+    std::string lowercaseNames;
+    // index of every directory that isn't forgotten in `directories`
+    std::unordered_map<std::string, size_t> indices;
+    // lines in the log, compared to the number of directories to know when to compact it
+    size_t lineCount{};
+
+    JumpDatabase();
+
+    // reads the log on first use, compacting it if it's too long
+    void load();
+    // adds `rank` to a directory, a rank of 0 forgets it
+    void apply(const std::string& path, double rank, time_t time);
+    void append(const std::string& path, double rank, time_t time);
+    // rewrites the log with a line per directory, scaling the ranks down if needed
+    void compact();
+
+    // the rank weighted by the time since the last visit
+    static double score(const Directory& directory, time_t now);
+
+public:
+    // sum of the ranks above which they're scaled down
+    static constexpr double maxTotalRank = 10000;
+    // lines the log can have beyond one per directory before it's compacted
+    static constexpr size_t compactionSlack = 1024;
+
+    JumpDatabase(const JumpDatabase&) = delete;
+
+    // records a visit to a directory
+    void addVisit(const fs::path& path);
+    // forgets a directory, e.g. once it doesn't exist anymore
+    void remove(const fs::path& path);
+
+    // returns at most `count` directories, the best first, whose path contains the words of `query` in order
+    // with the last one in the directory's name, matched ignoring case; `exclude` is never returned
+    [[nodiscard]] std::vector<fs::path> query(std::string_view query, size_t count, const fs::path& exclude);
+
+    static JumpDatabase& getInstance();
+};
@@ -0,0 +1,324 @@
+#include "LineIndex.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__AVX2__) or defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr size_t blockSize = 64;
+
+    // returns a mask with a bit set for every newline in the 64 bytes at `data`
+    uint64_t newLineMask(const char* data) {
+#if defined(__AVX2__)
+        const __m256i newLine = _mm256_set1_epi8('\n');
+        const auto low = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), newLine)));
+        const auto high = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32)), newLine)));
+        return low | static_cast<uint64_t>(high) << 32;
+#elif defined(__SSE2__)
+        const __m128i newLine = _mm_set1_epi8('\n');
+        uint64_t mask{};
+        for (int i = 0; i < 4; ++i) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+            mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newLine))))
+                    << (i * 16);
+        }
+        return mask;
+#else
+        uint64_t mask{};
+        for (size_t i = 0; i < blockSize; ++i) {
+            mask |= static_cast<uint64_t>(data[i] == '\n') << i;
+        }
+        return mask;
+#endif
+    }
+
+    uint64_t getFileSize(const int fd) {
+        struct stat status{};
+        return fstat(fd, &status) == 0 ? static_cast<uint64_t>(status.st_size) : 0;
+    }
+}
+
+const char* LineIndex::findNewLine(const char* data, const size_t size, uint64_t& remaining) {
+    size_t i{};
+
+    // count newlines a block at a time and only look for the exact one in the block that contains it
+    for (; i + blockSize <= size; i += blockSize) {
+        uint64_t mask = newLineMask(data + i);
+        const auto count = static_cast<uint64_t>(__builtin_popcountll(mask));
+
+        if (count < remaining) {
+            remaining -= count;
+            continue;
+        }
+
+        // drop the newlines before the target one
+        for (; remaining > 1; --remaining) {
+            mask &= mask - 1;
+        }
+        remaining = 0;
+        return data + i + __builtin_ctzll(mask);
+    }
+
+    for (; i < size; ++i) {
+        if (data[i] == '\n' and --remaining == 0) {
+            return data + i;
+        }
+    }
+
+    return nullptr;
+}
+
+const char* LineIndex::findNewLineBackward(const char* data, const size_t size, uint64_t& remaining) {
+    size_t end = size;
+
+    for (; end >= blockSize; end -= blockSize) {
+        uint64_t mask = newLineMask(data + end - blockSize);
+        const auto count = static_cast<uint64_t>(__builtin_popcountll(mask));
+
+        if (count < remaining) {
+            remaining -= count;
+            continue;
+        }
+
+        // drop the newlines after the target one
+        for (; remaining > 1; --remaining) {
+            mask &= ~(uint64_t{1} << (63 - __builtin_clzll(mask)));
+        }
+        remaining = 0;
+        return data + end - blockSize + (63 - __builtin_clzll(mask));
+    }
+
+    while (end > 0) {
+        if (data[--end] == '\n' and --remaining == 0) {
+            return data + end;
+        }
+    }
+
+    return nullptr;
+}
+
+uint64_t LineIndex::skipLines(const int fd, uint64_t offset, const uint64_t count, uint64_t& skipped) {
+    skipped = 0;
+    if (count == 0) {
+        return offset;
+    }
+
+    std::vector<char> buffer(scanChunkSize);
+    uint64_t remaining = count;
+
+    while (true) {
+        const ssize_t bytesRead = pread(fd, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        if (const char* newLine = findNewLine(buffer.data(), bytesRead, remaining); newLine != nullptr) {
+            skipped = count;
+            return offset + (newLine - buffer.data()) + 1;
+        }
+
+        offset += bytesRead;
+    }
+
+    skipped = count - remaining;
+    return getFileSize(fd);
+}
+
+uint64_t LineIndex::findPreviousLineStart(const int fd, uint64_t offset, const uint64_t count) {
+    std::vector<char> buffer(scanChunkSize);
+
+    // the newline right before `offset` ends the previous line, so one more is needed
+    uint64_t remaining = count + 1;
+
+    while (offset > 0) {
+        const uint64_t start = offset > scanChunkSize ? offset - scanChunkSize : 0;
+        const ssize_t bytesRead = pread(fd, buffer.data(), offset - start, static_cast<off_t>(start));
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        if (const char* newLine = findNewLineBackward(buffer.data(), bytesRead, remaining); newLine != nullptr) {
+            return start + (newLine - buffer.data()) + 1;
+        }
+
+        offset = start;
+    }
+
+    return 0;
+}
+
+uint64_t LineIndex::findTailStart(const int fd, const uint64_t size, const uint64_t count) {
+    if (size == 0 or count == 0) {
+        return size;
+    }
+
+    // a trailing newline ends the last line rather than starting a new one
+    char last{};
+    if (pread(fd, &last, 1, static_cast<off_t>(size - 1)) == 1 and last == '\n') {
+        return findPreviousLineStart(fd, size, count);
+    }
+
+    // the last line isn't terminated, so it starts after the last newline
+    return findPreviousLineStart(fd, findPreviousLineStart(fd, size, 0), count - 1);
+}
+
+LineIndex::~LineIndex() {
+    stop();
+}
+
+void LineIndex::stop() {
+    cancelled.store(true);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void LineIndex::build(const std::string& path) {
+    // open the file on the caller's thread so the worker isn't affected by directory changes
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    // keep the index if it's for the same, unchanged file
+    if (path == filePath and fd >= 0 and getFileSize(fd) == fileSize) {
+        close(fd);
+        return;
+    }
+
+    stop();
+
+    filePath = path;
+    newLines.store(0);
+    complete.store(false);
+    cancelled.store(false);
+    {
+        std::lock_guard lock(mutex);
+        offsets.assign(1, 0);
+    }
+
+    if (fd < 0) {
+        fileSize = 0;
+        complete.store(true);
+        return;
+    }
+
+    fileSize = getFileSize(fd);
+    worker = std::thread(&LineIndex::buildIndex, this, fd);
+}
+
+void LineIndex::buildIndex(const int fd) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::vector<char> buffer(chunkSize);
+    uint64_t offset{};
+    uint64_t remaining = interval; // newlines left until the next indexed line
+    char lastByte = '\n';
+
+    while (not cancelled.load(std::memory_order_relaxed)) {
+        const ssize_t bytesRead = pread(fd, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        const char* data = buffer.data();
+        size_t left = bytesRead;
+
+        // record the start of every `interval`-th line
+        while (const char* newLine = findNewLine(data, left, remaining)) {
+            remaining = interval;
+
+            const size_t consumed = newLine - data + 1;
+            {
+                std::lock_guard lock(mutex);
+                offsets.push_back(offset + (newLine - buffer.data()) + 1);
+            }
+
+            data += consumed;
+            left -= consumed;
+        }
+
+        // `remaining` now holds the newlines left until the next indexed line
+        newLines.store((offsets.size() - 1) * interval + (interval - remaining), std::memory_order_relaxed);
+        offset += bytesRead;
+        lastByte = buffer[bytesRead - 1];
+    }
+
+    close(fd);
+
+    // the last line isn't followed by a newline, so it wasn't counted
+    unterminatedLastLine = lastByte != '\n';
+    complete.store(not cancelled.load());
+}
+
+const std::string& LineIndex::getPath() const {
+    return filePath;
+}
+
+bool LineIndex::isComplete() const {
+    return complete.load();
+}
+
+std::optional<uint64_t> LineIndex::getLineCount() const {
+    if (not isComplete()) {
+        return std::nullopt;
+    }
+
+    return newLines.load() + (unterminatedLastLine ? 1 : 0);
+}
+
+std::pair<uint64_t, uint64_t> LineIndex::getCheckpoint(const uint64_t line) const {
+    std::lock_guard lock(mutex);
+
+    const uint64_t index = std::min<uint64_t>(line / interval, offsets.size() - 1);
+    return {index * interval, offsets[index]};
+}
+
+std::optional<uint64_t> LineIndex::getLineAt(const uint64_t offset) const {
+    uint64_t checkpointLine, checkpointOffset;
+    {
+        std::lock_guard lock(mutex);
+
+        // the index must reach past the offset to know the lines before it
+        if (not isComplete() and offset >= offsets.back()) {
+            return std::nullopt;
+        }
+
+        const auto next = std::upper_bound(offsets.begin(), offsets.end(), offset);
+        const auto index = static_cast<uint64_t>(std::prev(next) - offsets.begin());
+        checkpointLine = index * interval;
+        checkpointOffset = offsets[index];
+    }
+
+    const int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    // count the newlines between the checkpoint and the offset
+    std::vector<char> buffer(scanChunkSize);
+    uint64_t lines{};
+
+    for (uint64_t position = checkpointOffset; position < offset;) {
+        const ssize_t bytesRead = pread(fd, buffer.data(), std::min<uint64_t>(scanChunkSize, offset - position),
+                                        static_cast<off_t>(position));
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        uint64_t remaining = UINT64_MAX;
+        findNewLine(buffer.data(), bytesRead, remaining);
+        lines += UINT64_MAX - remaining;
+        position += bytesRead;
+    }
+
+    close(fd);
+    return checkpointLine + lines;
+}
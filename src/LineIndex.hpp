@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// sparse index of line offsets in a file, built in the background
+// only the offset of every `interval`-th line is stored, so jumping to any line
+// takes one lookup and a scan over less than `interval` lines
+class LineIndex {
+    // file the index is built for
+    std::string filePath;
+    uint64_t fileSize{};
+
+    mutable std::mutex mutex;
+    // offsets[i] is the offset of the start of line `i * interval`
+    std::vector<uint64_t> offsets;
+    // number of newlines counted so far
+    std::atomic<uint64_t> newLines{};
+    // true if the file doesn't end with a newline, set before `complete`
+    bool unterminatedLastLine{};
+    std::atomic_bool complete{};
+    std::atomic_bool cancelled{};
+
+    std::thread worker;
+
+    // reads the file from `fd` and fills `offsets`, runs on `worker`
+    void buildIndex(int fd);
+    // stops the worker if it's running
+    void stop();
+
+public:
+    // number of lines between two indexed offsets
+    static constexpr uint64_t interval = 1024;
+    // number of bytes read at a time while building the index
+    static constexpr size_t chunkSize = 1024 * 1024;
+    // number of bytes read at a time for the short scans around a single position
+    static constexpr size_t scanChunkSize = 64 * 1024;
+
+    LineIndex() = default;
+    LineIndex(const LineIndex&) = delete;
+    ~LineIndex();
+
+    // starts building the index for the file in the background
+    // does nothing if the index is already built or being built for the same, unchanged file
+    void build(const std::string& path);
+
+    [[nodiscard]] const std::string& getPath() const;
+    [[nodiscard]] bool isComplete() const;
+    // returns the number of lines in the file once the index is complete
+    [[nodiscard]] std::optional<uint64_t> getLineCount() const;
+
+    // returns the nearest indexed line at or before `line` as {line number, offset}
+    [[nodiscard]] std::pair<uint64_t, uint64_t> getCheckpoint(uint64_t line) const;
+    // returns the number of the line starting at `offset` if the index already covers it
+    [[nodiscard]] std::optional<uint64_t> getLineAt(uint64_t offset) const;
+
+    // returns a pointer to the `remaining`-th newline in `data[0, size)` or null if there are fewer,
+    // decrementing `remaining` by the number of newlines passed
+    static const char* findNewLine(const char* data, size_t size, uint64_t& remaining);
+    // same as `findNewLine` but searches backward from the end of `data`
+    static const char* findNewLineBackward(const char* data, size_t size, uint64_t& remaining);
+
+    // returns the offset right after `count` newlines starting at `offset`, or the file size if there are fewer
+    // `skipped` is set to the number of newlines passed
+    static uint64_t skipLines(int fd, uint64_t offset, uint64_t count, uint64_t& skipped);
+    // returns the start of the line `count` lines before the line starting at `offset`, or 0 if there are fewer
+    static uint64_t findPreviousLineStart(int fd, uint64_t offset, uint64_t count);
+    // returns the start of the first line of the last `count` lines of a file of `size` bytes
+    static uint64_t findTailStart(int fd, uint64_t size, uint64_t count);
+};
@@ -0,0 +1,157 @@
+#include "ListingCache.hpp"
+
+#include <chrono>
+#include "FileProperties.hpp"
+#include "Trace.hpp"
+
+ListingCache& ListingCache::getInstance() {
+    static ListingCache cache;
+    return cache;
+}
+
+std::list<ListingCache::Listing>::iterator ListingCache::find(const fs::path& directory) {
+    for (auto it = listings.begin(); it != listings.end(); ++it) {
+        if (it->path == directory) {
+            return it;
+        }
+    }
+    return listings.end();
+}
+
+bool ListingCache::isValid(const Listing& listing, const fs::file_time_type modificationTime) {
+    return not listing.isRacy and listing.modificationTime == modificationTime;
+}
+
+void ListingCache::evict() {
+    // the most recently used listing is always kept, even when it's larger than the limit
+    while (listings.size() > 1 and (listings.size() > maxListings or entryCount > maxEntries)) {
+        entryCount -= listings.back().entries.size() + listings.back().sortedEntries.size();
+        listings.pop_back();
+    }
+}
+
+ListingCache::Listing& ListingCache::getListing(const fs::path& directory) {
+    const fs::file_time_type modificationTime = fs::last_write_time(directory);
+
+    if (const auto it = find(directory); it != listings.end()) {
+        if (isValid(*it, modificationTime)) {
+            listings.splice(listings.begin(), listings, it);
+            return *it;
+        }
+
+        entryCount -= it->entries.size() + it->sortedEntries.size();
+        listings.erase(it);
+    }
+
+    const Trace::Span span("readDirectory");
+
+    Listing listing;
+    listing.path = directory;
+    listing.modificationTime = modificationTime;
+    for (const auto& entry : fs::directory_iterator{directory}) {
+        listing.entries.push_back(entry);
+    }
+
+    // the times have a coarse granularity, a change right after the directory was read may not show in it
+    listing.isRacy = fs::file_time_type::clock::now() - modificationTime < std::chrono::seconds(1);
+
+    entryCount += listing.entries.size();
+    listings.push_front(std::move(listing));
+    evict();
+
+    return listings.front();
+}
+
+const std::vector<fs::directory_entry>& ListingCache::sort(Listing& listing, const bool showHidden,
+                                                           const SortType sortType, const bool reverse) {
+    if (listing.isSorted and listing.showHidden == showHidden and listing.sortType == sortType and
+        listing.reverse == reverse) {
+        return listing.sortedEntries;
+    }
+
+    entryCount -= listing.sortedEntries.size();
+
+    // add the previous directory `..` at the top, relative to the listed directory
+    // and not to the working directory of the process
+    std::vector<fs::directory_entry>& entries = listing.sortedEntries;
+    entries.assign({fs::directory_entry(listing.path / "..")});
+
+    for (const auto& entry : listing.entries) {
+        // only add the entry if it's not hidden or hidden files are allowed
+        if (showHidden or not FileProperties::Utilities::isHidden(entry)) {
+            entries.push_back(entry);
+        }
+    }
+
+    // the sizes and times are taken from the listing's metadata
+    if (sortType != SortType::None) {
+        FileManager::sortEntries(entries, sortType, showHidden, reverse);
+    }
+
+    listing.isSorted = true;
+    listing.showHidden = showHidden;
+    listing.sortType = sortType;
+    listing.reverse = reverse;
+
+    entryCount += entries.size();
+    return entries;
+}
+
+const std::vector<fs::directory_entry>& ListingCache::getSortedEntries(const fs::path& directory,
+                                                                       const bool showHidden, const SortType sortType,
+                                                                       const bool reverse) {
+    Listing& listing = getListing(directory);
+    const std::vector<fs::directory_entry>& entries = sort(listing, showHidden, sortType, reverse);
+    evict();
+    return entries;
+}
+
+const std::vector<fs::directory_entry>* ListingCache::findSortedEntries(const fs::path& directory,
+                                                                        const bool showHidden, const SortType sortType,
+                                                                        const bool reverse) {
+    const auto it = find(directory);
+    if (it == listings.end()) {
+        return nullptr;
+    }
+
+    std::error_code error;
+    if (const fs::file_time_type modificationTime = fs::last_write_time(directory, error);
+        error or not isValid(*it, modificationTime)) {
+        return nullptr;
+    }
+
+    listings.splice(listings.begin(), listings, it);
+    const std::vector<fs::directory_entry>& entries = sort(*it, showHidden, sortType, reverse);
+    evict();
+    return &entries;
+}
+
+std::vector<EntryMetadata> ListingCache::getMetadata(const std::vector<fs::directory_entry>& entries) {
+    std::vector<EntryMetadata> metadata;
+    metadata.reserve(entries.size());
+
+    // the entries of a listing all have the same parent, `..` included
+    const auto listing = entries.empty() ? listings.end() : find(entries.front().path().parent_path());
+
+    for (const auto& entry : entries) {
+        if (listing == listings.end() or entry.path().parent_path() != listing->path) {
+            metadata.push_back(FileManager::readMetadata(entry));
+            continue;
+        }
+
+        const auto [it, inserted] = listing->metadata.try_emplace(entry.path().filename().string());
+        if (inserted) {
+            it->second = FileManager::readMetadata(entry);
+        }
+        metadata.push_back(it->second);
+    }
+
+    return metadata;
+}
+
+void ListingCache::invalidate(const fs::path& directory) {
+    if (const auto it = find(directory); it != listings.end()) {
+        entryCount -= it->entries.size() + it->sortedEntries.size();
+        listings.erase(it);
+    }
+}
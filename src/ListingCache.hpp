@@ -0,0 +1,72 @@
+#pragma once
+#include <filesystem>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileManager.hpp"
+
+namespace fs = std::filesystem;
+
+// the directories read by the tabs and the columns, shared by all of them so showing a directory in a second tab,
+// going back to one, or moving it from a column to another doesn't read it again
+// a listing is reused as long as the modification time of its directory is the same, which changes
+// whenever an entry is added, removed or renamed in it. the sizes and times sorting reads are kept with
+// the listing and read again with it; a file changed in place keeps its old ones until then
+// only used from the input thread
+class ListingCache {
+    struct Listing {
+        fs::path path;
+        fs::file_time_type modificationTime{};
+        // changes made in the same tick as the listing was read don't change the directory's time,
+        // such a listing is read again the next time it's used
+        bool isRacy{};
+        std::vector<fs::directory_entry> entries; // in directory order, without `.` and `..`
+        // read when the directory is first sorted by time or size, by entry name
+        std::unordered_map<std::string, EntryMetadata> metadata;
+
+        // the entries sorted with the last options they were asked for, starting with `..`
+        std::vector<fs::directory_entry> sortedEntries;
+        bool isSorted{};
+        bool showHidden{};
+        SortType sortType{};
+        bool reverse{};
+    };
+
+    // the most recently used first
+    std::list<Listing> listings;
+    // entries in all the listings, the least recently used listings are dropped past `maxEntries`
+    size_t entryCount{};
+
+    ListingCache() = default;
+
+    [[nodiscard]] std::list<Listing>::iterator find(const fs::path& directory);
+    // returns the listing of a directory, reading it if it isn't cached or it changed
+    Listing& getListing(const fs::path& directory);
+    // whether a cached listing is still the directory's contents
+    [[nodiscard]] static bool isValid(const Listing& listing, fs::file_time_type modificationTime);
+    // sorts the listing's entries for the options if they weren't sorted for them already
+    const std::vector<fs::directory_entry>& sort(Listing& listing, bool showHidden, SortType sortType, bool reverse);
+    void evict();
+
+public:
+    static constexpr size_t maxListings = 32;
+    static constexpr size_t maxEntries = 1 << 20;
+
+    ListingCache(const ListingCache&) = delete;
+
+    // returns the entries of a directory in sort order, `..` first, reading it only if it changed since
+    // it was last read and sorting it only if it wasn't sorted with the same options
+    // the reference is valid until the next call, throws `fs::filesystem_error` if it can't be read
+    const std::vector<fs::directory_entry>& getSortedEntries(const fs::path& directory, bool showHidden,
+                                                             SortType sortType, bool reverse);
+    // same as above, but only if the directory is cached and didn't change, it's never read
+    [[nodiscard]] const std::vector<fs::directory_entry>* findSortedEntries(const fs::path& directory, bool showHidden,
+                                                                            SortType sortType, bool reverse);
+    // returns the metadata of each entry, read from disk only for the entries that aren't cached yet
+    [[nodiscard]] std::vector<EntryMetadata> getMetadata(const std::vector<fs::directory_entry>& entries);
+    // forgets a directory, so it's read again the next time
+    void invalidate(const fs::path& directory);
+
+    static ListingCache& getInstance();
+};
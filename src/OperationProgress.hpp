@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// counters of a running file operation, updated by its worker threads and read by the UI
+struct OperationProgress {
+    std::atomic<uint64_t> items{};  // entries processed
+    std::atomic<uint64_t> bytes{};  // bytes processed
+    std::atomic<uint64_t> errors{}; // entries that failed
+    std::atomic_bool cancelled{};   // set to stop the operation as soon as possible
+
+    // totals of the operation if they were measured before it started, 0 if they're unknown
+    std::atomic<uint64_t> totalItems{};
+    std::atomic<uint64_t> totalBytes{};
+
+    // records a failure, keeping the message of the first one
+    void addError(const std::string& message) {
+        std::lock_guard lock(mutex);
+        if (errors.fetch_add(1) == 0) {
+            firstError = message;
+        }
+    }
+
+    [[nodiscard]] std::string getFirstError() const {
+        std::lock_guard lock(mutex);
+        return firstError;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::string firstError;
+};
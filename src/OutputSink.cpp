@@ -0,0 +1,69 @@
+#include "OutputSink.hpp"
+
+#include <iostream>
+
+void FrameBuffer::write(const std::string_view data) {
+    frame += data;
+    totalBytes += data.size();
+}
+
+void FrameBuffer::flush() {
+    // flushing with nothing written isn't a frame
+    if (frame.empty()) {
+        return;
+    }
+
+    lastFrame.swap(frame);
+    frame.clear();
+    ++frameCount;
+}
+
+const std::string& FrameBuffer::getLastFrame() const {
+    return lastFrame;
+}
+
+size_t FrameBuffer::getFrameCount() const {
+    return frameCount;
+}
+
+size_t FrameBuffer::getTotalBytes() const {
+    return totalBytes;
+}
+
+void FrameBuffer::clear() {
+    frame.clear();
+    lastFrame.clear();
+    frameCount = 0;
+    totalBytes = 0;
+}
+
+OutputRedirect::SinkBuffer::SinkBuffer(OutputSink& sink)
+    : sink(sink) {}
+
+OutputRedirect::SinkBuffer::int_type OutputRedirect::SinkBuffer::overflow(const int_type character) {
+    if (not traits_type::eq_int_type(character, traits_type::eof())) {
+        const char c = traits_type::to_char_type(character);
+        sink.write({&c, 1});
+    }
+    return traits_type::not_eof(character);
+}
+
+std::streamsize OutputRedirect::SinkBuffer::xsputn(const char* data, const std::streamsize size) {
+    sink.write({data, static_cast<size_t>(size)});
+    return size;
+}
+
+int OutputRedirect::SinkBuffer::sync() {
+    sink.flush();
+    return 0;
+}
+
+OutputRedirect::OutputRedirect(OutputSink& sink)
+    : buffer(sink), previousBuffer(std::cout.rdbuf()) {
+    std::cout.flush();
+    std::cout.rdbuf(&buffer);
+}
+
+OutputRedirect::~OutputRedirect() {
+    std::cout.rdbuf(previousBuffer);
+}
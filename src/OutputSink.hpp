@@ -0,0 +1,57 @@
+#pragma once
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+// where the output of the UI goes. Terminal++'s `Printer`, `Cursor` and `Screen` write everything,
+// escape sequences included, through `std::cout`, so redirecting it sends a whole frame to a sink
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    virtual void write(std::string_view data) = 0;
+    // called on `Printer::flush`, once a frame is complete
+    virtual void flush() {}
+};
+
+// keeps the output in memory instead of writing it to the terminal, to render without a TTY
+class FrameBuffer final : public OutputSink {
+    std::string frame;      // written since the last flush
+    std::string lastFrame;  // written between the last two flushes
+    size_t frameCount{};
+    size_t totalBytes{};
+
+public:
+    void write(std::string_view data) override;
+    void flush() override;
+
+    // the last complete frame
+    [[nodiscard]] const std::string& getLastFrame() const;
+    [[nodiscard]] size_t getFrameCount() const;
+    // bytes written since the buffer was created or cleared
+    [[nodiscard]] size_t getTotalBytes() const;
+    void clear();
+};
+
+// sends `std::cout` to a sink until it's destroyed
+class OutputRedirect {
+    class SinkBuffer final : public std::streambuf {
+        OutputSink& sink;
+
+    protected:
+        int_type overflow(int_type character) override;
+        std::streamsize xsputn(const char* data, std::streamsize size) override;
+        int sync() override;
+
+    public:
+        explicit SinkBuffer(OutputSink& sink);
+    };
+
+    SinkBuffer buffer;
+    std::streambuf* previousBuffer;
+
+public:
+    explicit OutputRedirect(OutputSink& sink);
+    OutputRedirect(const OutputRedirect&) = delete;
+    ~OutputRedirect();
+};
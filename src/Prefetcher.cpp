@@ -0,0 +1,211 @@
+#include "Prefetcher.hpp"
+
+#include <algorithm>
+#include <tuple>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "FileProperties.hpp"
+#include "ImagePreview.hpp"
+
+bool ListingOptions::operator==(const ListingOptions& other) const {
+    return std::tie(searchQuery, showHidden, sortType, reverse, maxRead) ==
+           std::tie(other.searchQuery, other.showHidden, other.sortType, other.reverse, other.maxRead);
+}
+
+Prefetcher::Prefetcher() {
+    // started once every member is initialized
+    worker = std::thread(&Prefetcher::run, this);
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        ++generation;
+    }
+    condition.notify_one();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+Prefetcher& Prefetcher::getInstance() {
+    static Prefetcher prefetcher;
+    return prefetcher;
+}
+
+void Prefetcher::schedule(PrefetchRequest prefetchRequest) {
+    {
+        std::lock_guard lock(mutex);
+        request = std::move(prefetchRequest);
+        hasRequest = true;
+        ++generation;
+    }
+    condition.notify_one();
+}
+
+void Prefetcher::cancel() {
+    {
+        std::lock_guard lock(mutex);
+        hasRequest = false;
+        ++generation;
+    }
+    condition.notify_one();
+}
+
+bool Prefetcher::isCancelled(const uint64_t requestGeneration) {
+    std::lock_guard lock(mutex);
+    return generation != requestGeneration;
+}
+
+void Prefetcher::run() {
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        condition.wait(lock, [this] { return stopping or hasRequest; });
+        if (stopping) {
+            return;
+        }
+
+        const uint64_t requestGeneration = generation;
+        const PrefetchRequest current = std::move(request);
+        hasRequest = false;
+
+        // only start once no input arrived for `idleDelay`, a key or a new request changes the generation
+        if (condition.wait_for(lock, idleDelay, [&] { return stopping or generation != requestGeneration; })) {
+            continue;
+        }
+
+        lock.unlock();
+
+        const auto deadline = std::chrono::steady_clock::now() + timeBudget;
+        const auto shouldStop = [&] {
+            return std::chrono::steady_clock::now() >= deadline or isCancelled(requestGeneration);
+        };
+
+        // the entries the cursor is most likely to move to next
+        for (const PrefetchTarget& target : current.neighbors) {
+            if (shouldStop()) {
+                break;
+            }
+
+            if (target.isDirectory) {
+                warmDirectory(target, current.listingOptions);
+            } else {
+                warmFile(target.path, current);
+            }
+        }
+
+        // stat the entries of the next page so scrolling to it finds their inodes cached
+        struct stat status{};
+        for (const fs::path& path : current.nextPage) {
+            if (shouldStop()) {
+                break;
+            }
+            lstat(path.c_str(), &status);
+        }
+
+        lock.lock();
+    }
+}
+
+void Prefetcher::warmFile(const fs::path& path, const PrefetchRequest& prefetchRequest) const {
+    struct stat status{};
+    if (stat(path.c_str(), &status) != 0 or not S_ISREG(status.st_mode)) {
+        return;
+    }
+
+    // decode small images so their thumbnail is read from the cache when previewed
+    if (FileProperties::Types::determineFileType(path) == FileType::Image) {
+        if (static_cast<uintmax_t>(status.st_size) <= maxThumbnailFileSize) {
+            ImagePreview().load(path.string(), prefetchRequest.thumbnailWidth, prefetchRequest.thumbnailHeight);
+        }
+        return;
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        return;
+    }
+
+    // start reading the part of the file the preview shows in the background
+#if defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fd, 0, readAheadSize, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+    radvisory advisory{0, static_cast<int>(readAheadSize)};
+    fcntl(fd, F_RDADVISE, &advisory);
+#endif
+
+    close(fd);
+}
+
+void Prefetcher::warmDirectory(const PrefetchTarget& target, const ListingOptions& options) {
+    std::error_code error;
+    const auto modificationTime = fs::last_write_time(target.path, error);
+    if (error) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        for (const CachedListing& listing : listings) {
+            if (listing.path == target.path and listing.modificationTime == modificationTime and
+                listing.options == options and listing.maxEntries >= target.maxEntries) {
+                return;
+            }
+        }
+    }
+
+    DirectoryPage page = FileManager::getDirectoryPage(
+        target.path,
+        options.searchQuery,
+        options.showHidden,
+        options.sortType,
+        options.reverse,
+        target.maxEntries,
+        options.maxRead
+    );
+
+    std::lock_guard lock(mutex);
+
+    // replace an older listing of the same directory or the oldest listing
+    listings.erase(std::remove_if(listings.begin(), listings.end(), [&](const CachedListing& listing) {
+        return listing.path == target.path;
+    }), listings.end());
+
+    if (listings.size() == maxListings) {
+        listings.erase(listings.begin());
+    }
+
+    listings.push_back({target.path, modificationTime, options, target.maxEntries, std::move(page)});
+}
+
+std::optional<DirectoryPage> Prefetcher::getListing(const fs::path& path, const ListingOptions& options,
+                                                    const size_t maxEntries) {
+    std::error_code error;
+    const auto modificationTime = fs::last_write_time(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+
+    std::lock_guard lock(mutex);
+
+    for (const CachedListing& listing : listings) {
+        if (listing.path != path or listing.modificationTime != modificationTime or
+            not (listing.options == options) or listing.maxEntries < maxEntries) {
+            continue;
+        }
+
+        // the listing is sorted, so the first entries of a longer listing are the same as a shorter one
+        DirectoryPage page = listing.page;
+        const size_t kept = std::min(page.entries.size(), std::max<size_t>(maxEntries, 1));
+
+        page.remaining += page.entries.size() - kept;
+        page.entries.erase(page.entries.begin() + static_cast<std::ptrdiff_t>(kept), page.entries.end());
+        return page;
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "FileManager.hpp"
+
+namespace fs = std::filesystem;
+
+// options a directory preview is listed with, a warmed listing is only used if they match
+struct ListingOptions {
+    std::string searchQuery;
+    bool showHidden{};
+    SortType sortType{};
+    bool reverse{};
+    size_t maxRead{};
+
+    bool operator==(const ListingOptions& other) const;
+};
+
+// an entry next to the selected one, warmed the way its preview reads it
+struct PrefetchTarget {
+    fs::path path;
+    bool isDirectory{};
+    size_t maxEntries{}; // number of children the directory preview lists
+};
+
+// what to warm once input is idle, snapshotted on the input thread
+struct PrefetchRequest {
+    std::vector<PrefetchTarget> neighbors; // entries right above and below the selected one
+    std::vector<fs::path> nextPage;        // entries on the page after the selected one
+    ListingOptions listingOptions;
+    int thumbnailWidth{};
+    int thumbnailHeight{};
+};
+
+// warms the previews of the entries next to the selected one while waiting for input
+// work starts after `idleDelay` without input, stops after `timeBudget`, and is cancelled
+// between every step as soon as a key is read, so prefetching never delays handling input
+class Prefetcher {
+    // a directory listing made ahead of time for the preview
+    struct CachedListing {
+        fs::path path;
+        std::filesystem::file_time_type modificationTime;
+        ListingOptions options;
+        size_t maxEntries{};
+        DirectoryPage page;
+    };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread worker;
+
+    // incremented on every new request and cancellation, work for an older generation stops
+    uint64_t generation{};
+    bool hasRequest{};
+    bool stopping{};
+    PrefetchRequest request;
+
+    // most recent warmed listings, guarded by `mutex`
+    std::vector<CachedListing> listings;
+
+    Prefetcher();
+    ~Prefetcher();
+
+    // waits for requests and runs them once input is idle, runs on `worker`
+    void run();
+    [[nodiscard]] bool isCancelled(uint64_t requestGeneration);
+
+    // asks the kernel to read ahead the first bytes of a file, or thumbnails an image
+    void warmFile(const fs::path& path, const PrefetchRequest& prefetchRequest) const;
+    // lists a directory for its preview
+    void warmDirectory(const PrefetchTarget& target, const ListingOptions& options);
+
+public:
+    // time without input before prefetching starts
+    static constexpr std::chrono::milliseconds idleDelay{100};
+    // maximum time spent prefetching for a single request
+    static constexpr std::chrono::milliseconds timeBudget{50};
+    // number of bytes read ahead for each file, what the text preview reads
+    static constexpr size_t readAheadSize = 64 * 1024;
+    // largest image thumbnailed ahead of time
+    static constexpr uintmax_t maxThumbnailFileSize = 8 * 1024 * 1024;
+    // number of warmed directory listings kept
+    static constexpr size_t maxListings = 4;
+
+    Prefetcher(const Prefetcher&) = delete;
+
+    // replaces the pending request, it runs once no input arrives for `idleDelay`
+    void schedule(PrefetchRequest prefetchRequest);
+    // stops the current and pending requests, called as soon as a key is read
+    void cancel();
+
+    // returns the warmed listing of the directory if it's still up to date and has at least `maxEntries` entries
+    std::optional<DirectoryPage> getListing(const fs::path& path, const ListingOptions& options, size_t maxEntries);
+
+    static Prefetcher& getInstance();
+};
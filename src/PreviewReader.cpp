@@ -0,0 +1,97 @@
+#include "PreviewReader.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+size_t PreviewReader::splitLines(const size_t from, const size_t size, const size_t maxLines) {
+    const char* begin = buffer.data();
+    const char* end = begin + size;
+    const char* current = begin + from;
+
+    while (current < end and lines.size() < maxLines) {
+        // memchr is vectorized by the C library, so long lines are skipped at memory bandwidth
+        const auto* newLine = static_cast<const char*>(std::memchr(current, '\n', end - current));
+
+        if (newLine == nullptr) {
+            break;
+        }
+
+        // strip the carriage return of CRLF line endings
+        const char* lineEnd = (newLine > current and newLine[-1] == '\r') ? newLine - 1 : newLine;
+        lines.emplace_back(current, lineEnd - current);
+
+        current = newLine + 1;
+    }
+
+    return current - begin;
+}
+
+bool PreviewReader::read(const std::string& path, const uint64_t offset, const size_t maxLines) {
+    lines.clear();
+    startOffset = endOffset = offset;
+    reachedEnd = false;
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    buffer.resize(byteBudget);
+
+    size_t size{};     // number of bytes read into the buffer
+    size_t consumed{}; // number of bytes taken by complete lines
+    bool failed{};
+
+    // read chunk by chunk so short files and short lines don't pay for the whole budget
+    while (size < byteBudget and lines.size() < maxLines) {
+        const ssize_t bytesRead = pread(fd, buffer.data() + size, std::min(chunkSize, byteBudget - size),
+                                        static_cast<off_t>(offset + size));
+        if (bytesRead < 0) {
+            failed = true;
+            break;
+        }
+        if (bytesRead == 0) {
+            reachedEnd = true;
+            break;
+        }
+
+        size += bytesRead;
+        // only the newly read bytes and the unterminated tail before them are scanned
+        consumed = splitLines(consumed, size, maxLines);
+    }
+
+    close(fd);
+
+    if (failed) {
+        lines.clear();
+        return false;
+    }
+
+    endOffset = offset + consumed;
+
+    // keep the unterminated tail as a partial line, either the last line of the file
+    // or a line longer than the budget that's cut to the window
+    if (consumed < size and lines.size() < maxLines) {
+        const char* tail = buffer.data() + consumed;
+        lines.emplace_back(tail, size - consumed);
+    }
+
+    return true;
+}
+
+const std::vector<std::string_view>& PreviewReader::getLines() const {
+    return lines;
+}
+
+uint64_t PreviewReader::getStartOffset() const {
+    return startOffset;
+}
+
+uint64_t PreviewReader::getEndOffset() const {
+    return endOffset;
+}
+
+bool PreviewReader::reachedEndOfFile() const {
+    return reachedEnd;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// reads a bounded window of a file and splits it into lines
+// never holds more than `byteBudget` bytes of the file in memory, no matter how large the file
+// or how long its lines are, the lines are views into the window and are never copied
+class PreviewReader {
+    // bytes read from the file
+    std::string buffer;
+    // views into `buffer` for each line in the window (without the line terminator)
+    std::vector<std::string_view> lines;
+
+    // file offset of the first byte in `buffer`
+    uint64_t startOffset{};
+    // file offset right after the last line terminator found in the window
+    uint64_t endOffset{};
+    // true if the window reaches the end of the file
+    bool reachedEnd{};
+
+    // appends the lines found in `buffer[from, size)`, stopping after `maxLines` lines
+    // returns the offset in `buffer` right after the last complete line
+    size_t splitLines(size_t from, size_t size, size_t maxLines);
+
+public:
+    // maximum number of bytes read from a file for a single window
+    static constexpr size_t byteBudget = 64 * 1024;
+    // number of bytes read at a time until enough lines are found or the budget is exhausted
+    static constexpr size_t chunkSize = 8 * 1024;
+
+    // reads up to `byteBudget` bytes starting at `offset` and splits them into at most `maxLines` lines
+    // a line that doesn't end within the budget is kept as a partial line
+    // returns false if the file couldn't be opened or read
+    bool read(const std::string& path, uint64_t offset, size_t maxLines);
+
+    [[nodiscard]] const std::vector<std::string_view>& getLines() const;
+    [[nodiscard]] uint64_t getStartOffset() const;
+    [[nodiscard]] uint64_t getEndOffset() const;
+    [[nodiscard]] bool reachedEndOfFile() const;
+};
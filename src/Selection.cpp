@@ -0,0 +1,114 @@
+#include "Selection.hpp"
+
+void Selection::reset(const size_t size) {
+    words.assign((size + 63) / 64, 0);
+    size_ = size;
+    count_ = 0;
+}
+
+void Selection::clear() {
+    reset(size_);
+}
+
+void Selection::toggle(const size_t index) {
+    if (index >= size_) {
+        return;
+    }
+
+    uint64_t& word = words[index / 64];
+    const uint64_t bit = uint64_t{1} << index % 64;
+
+    if (word & bit) {
+        --count_;
+    } else {
+        ++count_;
+    }
+    word ^= bit;
+}
+
+void Selection::select(const size_t index) {
+    if (not isSelected(index) and index < size_) {
+        toggle(index);
+    }
+}
+
+bool Selection::isSelected(const size_t index) const {
+    return index < size_ and words[index / 64] >> index % 64 & 1;
+}
+
+void Selection::insert(const size_t index) {
+    if (index > size_) {
+        return;
+    }
+
+    if (++size_ > words.size() * 64) {
+        words.push_back(0);
+    }
+
+    // shift the bits from `index` up by one, carrying the top bit of each word into the next one
+    const size_t first = index / 64;
+    for (size_t i = words.size() - 1; i > first; --i) {
+        words[i] = words[i] << 1 | words[i - 1] >> 63;
+    }
+
+    const uint64_t lowBits = (uint64_t{1} << index % 64) - 1;
+    words[first] = (words[first] & lowBits) | (words[first] & ~lowBits) << 1;
+}
+
+void Selection::erase(const size_t index) {
+    if (index >= size_) {
+        return;
+    }
+
+    if (isSelected(index)) {
+        --count_;
+    }
+
+    // shift the bits after `index` down by one, carrying the bottom bit of each word into the previous one
+    const size_t first = index / 64;
+    const uint64_t lowBits = (uint64_t{1} << index % 64) - 1;
+    words[first] = (words[first] & lowBits) | (words[first] >> 1 & ~lowBits);
+
+    for (size_t i = first; i + 1 < words.size(); ++i) {
+        words[i] |= words[i + 1] << 63;
+        words[i + 1] >>= 1;
+    }
+
+    if (--size_ <= (words.size() - 1) * 64) {
+        words.pop_back();
+    }
+}
+
+size_t Selection::count() const {
+    return count_;
+}
+
+bool Selection::empty() const {
+    return count_ == 0;
+}
+
+size_t Selection::size() const {
+    return size_;
+}
+
+std::vector<size_t> Selection::getIndices() const {
+    std::vector<size_t> indices;
+    indices.reserve(count_);
+
+    for (size_t i = 0; i < words.size(); ++i) {
+        // visit the set bits only, clearing the lowest one each time
+        for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+            indices.push_back(i * 64 + __builtin_ctzll(word));
+        }
+    }
+
+    return indices;
+}
+
+bool Selection::operator==(const Selection& other) const {
+    return size_ == other.size_ and count_ == other.count_ and words == other.words;
+}
+
+bool Selection::operator!=(const Selection& other) const {
+    return not(*this == other);
+}
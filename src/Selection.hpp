@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// entries marked in the listing, one bit per entry
+// a listing of 300k entries takes under 40KB, and the marked entries are found a word at a time
+class Selection {
+    std::vector<uint64_t> words;
+    size_t size_{};
+    size_t count_{};
+
+public:
+    // resizes the selection to a listing of `size` entries, unmarking every entry
+    void reset(size_t size);
+    void clear();
+
+    void toggle(size_t index);
+    void select(size_t index);
+    [[nodiscard]] bool isSelected(size_t index) const;
+
+    // adds an unmarked entry at `index`, the marks after it move up by one
+    void insert(size_t index);
+    // removes the entry at `index`, the marks after it move down by one
+    void erase(size_t index);
+
+    // number of marked entries
+    [[nodiscard]] size_t count() const;
+    [[nodiscard]] bool empty() const;
+    // number of entries in the listing
+    [[nodiscard]] size_t size() const;
+
+    // indices of the marked entries in ascending order
+    [[nodiscard]] std::vector<size_t> getIndices() const;
+
+    bool operator==(const Selection& other) const;
+    bool operator!=(const Selection& other) const;
+};
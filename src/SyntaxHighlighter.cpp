@@ -0,0 +1,370 @@
+#include "SyntaxHighlighter.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include <sys/stat.h>
+
+namespace {
+    const std::unordered_set<std::string_view> cppKeywords{
+        "alignas", "alignof", "and", "asm", "break", "case", "catch", "class", "concept", "const", "consteval",
+        "constexpr", "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype",
+        "default", "delete", "do", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "final",
+        "for", "friend", "goto", "if", "inline", "mutable", "namespace", "new", "noexcept", "not", "nullptr",
+        "operator", "or", "override", "private", "protected", "public", "register", "reinterpret_cast", "requires",
+        "return", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template", "this",
+        "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union", "using", "virtual",
+        "volatile", "while",
+    };
+
+    const std::unordered_set<std::string_view> cppTypes{
+        "auto", "bool", "char", "char8_t", "char16_t", "char32_t", "double", "float", "int", "long", "short",
+        "signed", "unsigned", "void", "wchar_t", "size_t", "ssize_t", "ptrdiff_t", "int8_t", "int16_t", "int32_t",
+        "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "std", "string", "string_view", "vector",
+    };
+
+    bool isIdentifierStart(const char c) {
+        return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or c == '_';
+    }
+
+    bool isIdentifierChar(const char c) {
+        return isIdentifierStart(c) or (c >= '0' and c <= '9');
+    }
+
+    bool isDigit(const char c) {
+        return c >= '0' and c <= '9';
+    }
+
+    void emit(std::vector<Token>* tokens, const size_t begin, const size_t end, const TokenType type) {
+        if (tokens != nullptr and end > begin) {
+            tokens->push_back({static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin), type});
+        }
+    }
+
+    // returns the index right after the closing quote, or `npos` if the literal isn't closed on this line
+    size_t skipQuoted(const std::string_view line, size_t i, const char quote) {
+        for (; i < line.size(); ++i) {
+            if (line[i] == '\\') {
+                ++i; // skip the escaped character
+            } else if (line[i] == quote) {
+                return i + 1;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    bool startsWith(const std::string_view text, const std::string_view prefix) {
+        return text.substr(0, prefix.size()) == prefix;
+    }
+}
+
+LexState Tokenizers::tokenizeCpp(const std::string_view line, LexState state, std::vector<Token>* tokens) {
+    const size_t n = line.size();
+    size_t i{};
+
+    // finish the multi-line construct started on a previous line
+    if (state == LexState::BlockComment) {
+        const size_t close = line.find("*/");
+        if (close == std::string_view::npos) {
+            emit(tokens, 0, n, TokenType::Comment);
+            return LexState::BlockComment;
+        }
+        i = close + 2;
+        emit(tokens, 0, i, TokenType::Comment);
+    } else if (state == LexState::RawString) {
+        const size_t close = line.find(")\"");
+        if (close == std::string_view::npos) {
+            emit(tokens, 0, n, TokenType::String);
+            return LexState::RawString;
+        }
+        i = close + 2;
+        emit(tokens, 0, i, TokenType::String);
+    } else if (state == LexState::String) {
+        i = skipQuoted(line, 0, '"');
+        if (i == std::string_view::npos) {
+            emit(tokens, 0, n, TokenType::String);
+            return not line.empty() and line.back() == '\\' ? LexState::String : LexState::Normal;
+        }
+        emit(tokens, 0, i, TokenType::String);
+    } else {
+        // preprocessor directive, the included header is highlighted as a string
+        if (const size_t first = line.find_first_not_of(" \t");
+            first != std::string_view::npos and line[first] == '#') {
+            size_t end = line.find_first_not_of(" \t", first + 1);
+            while (end < n and isIdentifierChar(line[end])) {
+                ++end;
+            }
+            end = std::min(end, n);
+            emit(tokens, first, end, TokenType::Preprocessor);
+            i = end;
+
+            if (const size_t header = line.find('<', i); header != std::string_view::npos and
+                                                         line.substr(first, end - first).find("include") !=
+                                                         std::string_view::npos) {
+                const size_t close = line.find('>', header);
+                emit(tokens, header, close == std::string_view::npos ? n : close + 1, TokenType::String);
+                i = close == std::string_view::npos ? n : close + 1;
+            }
+        }
+    }
+
+    while (i < n) {
+        const char c = line[i];
+        const char next = i + 1 < n ? line[i + 1] : '\0';
+
+        if (c == '/' and next == '/') {
+            emit(tokens, i, n, TokenType::Comment);
+            return LexState::Normal;
+        }
+
+        if (c == '/' and next == '*') {
+            const size_t close = line.find("*/", i + 2);
+            if (close == std::string_view::npos) {
+                emit(tokens, i, n, TokenType::Comment);
+                return LexState::BlockComment;
+            }
+            emit(tokens, i, close + 2, TokenType::Comment);
+            i = close + 2;
+        } else if (c == 'R' and next == '"' and (i == 0 or not isIdentifierChar(line[i - 1]))) {
+            const size_t close = line.find(")\"", i + 2);
+            if (close == std::string_view::npos) {
+                emit(tokens, i, n, TokenType::String);
+                return LexState::RawString;
+            }
+            emit(tokens, i, close + 2, TokenType::String);
+            i = close + 2;
+        } else if (c == '"' or c == '\'') {
+            const size_t end = skipQuoted(line, i + 1, c);
+            if (end == std::string_view::npos) {
+                emit(tokens, i, n, TokenType::String);
+                // only strings continued with a backslash span multiple lines
+                return c == '"' and line.back() == '\\' ? LexState::String : LexState::Normal;
+            }
+            emit(tokens, i, end, TokenType::String);
+            i = end;
+        } else if (isDigit(c) or (c == '.' and isDigit(next))) {
+            size_t end = i + 1;
+            while (end < n and (isIdentifierChar(line[end]) or line[end] == '.' or line[end] == '\'' or
+                                ((line[end] == '+' or line[end] == '-') and
+                                 (line[end - 1] == 'e' or line[end - 1] == 'E' or
+                                  line[end - 1] == 'p' or line[end - 1] == 'P')))) {
+                ++end;
+            }
+            emit(tokens, i, end, TokenType::Number);
+            i = end;
+        } else if (isIdentifierStart(c)) {
+            size_t end = i + 1;
+            while (end < n and isIdentifierChar(line[end])) {
+                ++end;
+            }
+
+            if (tokens != nullptr) {
+                const std::string_view word = line.substr(i, end - i);
+                if (cppKeywords.count(word)) {
+                    emit(tokens, i, end, TokenType::Keyword);
+                } else if (cppTypes.count(word)) {
+                    emit(tokens, i, end, TokenType::Type);
+                }
+            }
+            i = end;
+        } else {
+            ++i;
+        }
+    }
+
+    return LexState::Normal;
+}
+
+LexState Tokenizers::tokenizeMarkdown(const std::string_view line, const LexState state, std::vector<Token>* tokens) {
+    const size_t n = line.size();
+    const size_t first = std::min(line.find_first_not_of(" \t"), n);
+    const std::string_view content = line.substr(first);
+
+    const bool isFence = startsWith(content, "```") or startsWith(content, "~~~");
+
+    // fenced code blocks are highlighted as a whole, fences included
+    if (state == LexState::CodeBlock or isFence) {
+        emit(tokens, 0, n, TokenType::Code);
+
+        if (isFence) {
+            return state == LexState::CodeBlock ? LexState::Normal : LexState::CodeBlock;
+        }
+        return LexState::CodeBlock;
+    }
+
+    // everything below is contained in the line, so there's nothing to do when only tracking the state
+    if (tokens == nullptr or content.empty()) {
+        return LexState::Normal;
+    }
+
+    if (content.front() == '#') {
+        emit(tokens, first, n, TokenType::Heading);
+        return LexState::Normal;
+    }
+
+    size_t i = first;
+
+    // block quotes and list markers
+    if (content.front() == '>') {
+        emit(tokens, first, first + 1, TokenType::Quote);
+        i = first + 1;
+    } else if ((content.front() == '-' or content.front() == '*' or content.front() == '+') and
+               content.size() > 1 and content[1] == ' ') {
+        emit(tokens, first, first + 1, TokenType::ListMarker);
+        i = first + 1;
+    } else if (isDigit(content.front())) {
+        size_t end = first;
+        while (end < n and isDigit(line[end])) {
+            ++end;
+        }
+        if (end + 1 < n and (line[end] == '.' or line[end] == ')') and line[end + 1] == ' ') {
+            emit(tokens, first, end + 1, TokenType::ListMarker);
+            i = end + 1;
+        }
+    }
+
+    // inline code, emphasis and links
+    while (i < n) {
+        const char c = line[i];
+
+        if (c == '`') {
+            const size_t close = line.find('`', i + 1);
+            if (close == std::string_view::npos) {
+                break;
+            }
+            emit(tokens, i, close + 1, TokenType::Code);
+            i = close + 1;
+        } else if ((c == '*' or c == '_') and i + 1 < n and line[i + 1] != ' ') {
+            const bool isStrong = line[i + 1] == c;
+            const std::string_view marker = isStrong ? line.substr(i, 2) : line.substr(i, 1);
+            const size_t close = line.find(marker, i + marker.size());
+            if (close == std::string_view::npos) {
+                i += marker.size();
+                continue;
+            }
+            emit(tokens, i, close + marker.size(), TokenType::Emphasis);
+            i = close + marker.size();
+        } else if (c == '[') {
+            const size_t middle = line.find("](", i + 1);
+            const size_t close = middle == std::string_view::npos ? middle : line.find(')', middle + 2);
+            if (close == std::string_view::npos) {
+                ++i;
+                continue;
+            }
+            emit(tokens, i, close + 1, TokenType::Link);
+            i = close + 1;
+        } else {
+            ++i;
+        }
+    }
+
+    return LexState::Normal;
+}
+
+Tokenizer Tokenizers::getTokenizer(const FileType fileType) {
+    if (const auto it = fileTypeTokenizer.find(fileType); it != fileTypeTokenizer.end())
+        return it->second;
+    return nullptr;
+}
+
+bool SyntaxHighlighter::setFile(const std::string& path, const FileType fileType) {
+    tokenizer = Tokenizers::getTokenizer(fileType);
+    if (tokenizer == nullptr) {
+        return false;
+    }
+
+    struct stat status{};
+    if (stat(path.c_str(), &status) != 0) {
+        status = {};
+    }
+
+    // the checkpoints are only valid for the exact content they were computed from
+    if (path != filePath or static_cast<uint64_t>(status.st_size) != fileSize or
+        status.st_mtime != fileModificationTime) {
+        filePath = path;
+        fileSize = status.st_size;
+        fileModificationTime = status.st_mtime;
+
+        checkpoints.clear();
+        checkpoints.push_back({0, LexState::Normal});
+    }
+
+    return true;
+}
+
+LexState SyntaxHighlighter::getStateAt(const uint64_t offset) {
+    if (tokenizer == nullptr or checkpoints.empty()) {
+        return LexState::Normal;
+    }
+
+    // the nearest checkpoint at or before the offset
+    const auto next = std::upper_bound(
+        checkpoints.begin(), checkpoints.end(), offset,
+        [](const uint64_t target, const Checkpoint& checkpoint) {
+            return target < checkpoint.offset;
+        }
+    );
+    const Checkpoint start = *std::prev(next);
+
+    if (start.offset == offset) {
+        return start.state;
+    }
+
+    // too far from any checkpoint, don't stall the preview lexing the whole file
+    if (offset - start.offset > maxCatchUpBytes) {
+        return LexState::Normal;
+    }
+
+    // new checkpoints are only recorded past the last one so they stay `checkpointInterval` lines apart
+    const bool recordCheckpoints = next == checkpoints.end();
+
+    LexState state = start.state;
+    uint64_t position = start.offset;
+    size_t linesSinceCheckpoint{};
+
+    while (position < offset) {
+        if (not reader.read(filePath, position, std::numeric_limits<size_t>::max())) {
+            return LexState::Normal;
+        }
+
+        const auto& lines = reader.getLines();
+        const uint64_t windowEnd = reader.getEndOffset();
+
+        // the line is longer than the reader's budget, give up on tracking the state
+        if (windowEnd == position) {
+            return LexState::Normal;
+        }
+
+        for (size_t i = 0; i < lines.size(); ++i) {
+            const uint64_t lineStart = position + (lines[i].data() - lines.front().data());
+            // stop at the partial line at the end of the window or at the target line
+            if (lineStart >= windowEnd or lineStart >= offset) {
+                break;
+            }
+
+            state = tokenizer(lines[i], state, nullptr);
+
+            if (recordCheckpoints and ++linesSinceCheckpoint == checkpointInterval) {
+                const uint64_t nextLineStart = i + 1 < lines.size()
+                                                   ? position + (lines[i + 1].data() - lines.front().data())
+                                                   : windowEnd;
+                checkpoints.push_back({nextLineStart, state});
+                linesSinceCheckpoint = 0;
+            }
+        }
+
+        position = windowEnd;
+    }
+
+    return state;
+}
+
+void SyntaxHighlighter::highlight(const std::vector<std::string_view>& lines, LexState state,
+                                  std::vector<std::vector<Token>>& tokens) const {
+    tokens.resize(lines.size());
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        tokens[i].clear();
+        state = tokenizer != nullptr ? tokenizer(lines[i], state, &tokens[i]) : LexState::Normal;
+    }
+}
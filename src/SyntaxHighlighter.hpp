@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "FileProperties.hpp"
+#include "PreviewReader.hpp"
+
+// kinds of tokens produced by the tokenizers
+enum class TokenType : uint8_t {
+    Plain,
+    Keyword,
+    Type,
+    String,
+    Number,
+    Comment,
+    Preprocessor,
+    Heading,
+    Emphasis,
+    Code,
+    Link,
+    ListMarker,
+    Quote,
+};
+
+// lexer state carried from the end of a line to the start of the next one
+enum class LexState : uint8_t {
+    Normal,       // not inside any multi-line construct
+    BlockComment, // inside a `/* */` comment
+    String,       // inside a string continued with a trailing backslash
+    RawString,    // inside a `R"( )"` raw string
+    CodeBlock,    // inside a fenced markdown code block
+};
+
+// a highlighted span of a line
+struct Token {
+    uint32_t begin;  // byte offset in the line
+    uint32_t length; // length in bytes
+    TokenType type;
+};
+
+// tokenizes a single line starting in `state` and returns the state at the end of the line
+// tokens are only produced when `tokens` is not null, so skipping over lines only tracks the state
+using Tokenizer = LexState (*)(std::string_view line, LexState state, std::vector<Token>* tokens);
+
+namespace Tokenizers {
+    LexState tokenizeCpp(std::string_view line, LexState state, std::vector<Token>* tokens);
+    LexState tokenizeMarkdown(std::string_view line, LexState state, std::vector<Token>* tokens);
+
+    static inline std::unordered_map<FileType, Tokenizer> fileTypeTokenizer{
+        {FileType::Cpp, tokenizeCpp},
+        {FileType::Header, tokenizeCpp},
+        {FileType::Markdown, tokenizeMarkdown},
+    };
+
+    // returns the tokenizer for the file type or null if it has none
+    Tokenizer getTokenizer(FileType fileType);
+}
+
+// highlights the visible lines of a file
+// the lexer state is checkpointed every `checkpointInterval` lines as the file gets lexed
+// so showing lines deep into a file only re-lexes from the nearest checkpoint before them
+class SyntaxHighlighter {
+    // lexer state at the start of a line
+    struct Checkpoint {
+        uint64_t offset;
+        LexState state;
+    };
+
+    // file the checkpoints belong to
+    std::string filePath;
+    uint64_t fileSize{};
+    int64_t fileModificationTime{};
+
+    Tokenizer tokenizer{};
+
+    // checkpoints at every `checkpointInterval`-th line from the start of the file, sorted by offset
+    std::vector<Checkpoint> checkpoints;
+
+    // reader used to lex the lines between a checkpoint and the visible lines
+    PreviewReader reader;
+
+public:
+    // number of lines between two checkpoints
+    static constexpr size_t checkpointInterval = 256;
+    // maximum number of bytes lexed to find the state of the first visible line
+    // past that the state is assumed to be `LexState::Normal`
+    static constexpr uint64_t maxCatchUpBytes = 4 * 1024 * 1024;
+
+    // selects the tokenizer for the file and drops the checkpoints if it's a different or modified file
+    // returns false if the file type has no tokenizer
+    bool setFile(const std::string& path, FileType fileType);
+
+    // returns the lexer state at the start of the line beginning at `offset`
+    LexState getStateAt(uint64_t offset);
+
+    // tokenizes the given consecutive lines, the first one starting in `state`
+    void highlight(const std::vector<std::string_view>& lines, LexState state,
+                   std::vector<std::vector<Token>>& tokens) const;
+};
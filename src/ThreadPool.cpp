@@ -0,0 +1,67 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+size_t ThreadPool::getDefaultThreadCount() {
+    return std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+}
+
+ThreadPool::ThreadPool(const size_t threadCount, std::function<void()> initializeWorker) {
+    for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) {
+        workers.emplace_back(&ThreadPool::work, this, initializeWorker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back(std::move(task));
+        ++pendingTasks;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(mutex);
+    tasksDone.wait(lock, [this] { return pendingTasks == 0; });
+}
+
+void ThreadPool::work(const std::function<void()>& initializeWorker) {
+    if (initializeWorker != nullptr) {
+        initializeWorker();
+    }
+
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        taskAvailable.wait(lock, [this] { return stopping or not tasks.empty(); });
+        if (tasks.empty()) {
+            return;
+        }
+
+        const std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        if (--pendingTasks == 0) {
+            tasksDone.notify_all();
+        }
+    }
+}
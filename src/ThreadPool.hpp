@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads running submitted tasks
+// tasks can submit more tasks, `wait()` returns once all of them are done, which lets recursive
+// operations on directory trees submit every subdirectory as its own task
+class ThreadPool {
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable tasksDone;
+
+    std::deque<std::function<void()>> tasks;
+    // number of tasks queued or running
+    size_t pendingTasks{};
+    bool stopping{};
+
+    std::vector<std::thread> workers;
+
+    // runs tasks until the pool is destroyed, runs on each worker
+    void work(const std::function<void()>& initializeWorker);
+
+public:
+    // uses one worker per hardware thread, at most 8 and at least 2
+    static size_t getDefaultThreadCount();
+
+    // `initializeWorker` runs on every worker before it takes tasks, e.g. to lower its priority
+    explicit ThreadPool(size_t threadCount = getDefaultThreadCount(),
+                        std::function<void()> initializeWorker = nullptr);
+    ThreadPool(const ThreadPool&) = delete;
+    // finishes the queued tasks and stops the workers
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // blocks until every submitted task, including the ones submitted by other tasks, is done
+    void wait();
+};
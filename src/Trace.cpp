@@ -0,0 +1,106 @@
+#include "Trace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <unistd.h>
+
+Trace::Trace() {
+    if (not isEnabled) {
+        return;
+    }
+
+    outputPath = std::getenv("BFILEX_TRACE");
+    std::atexit([] {
+        Trace& trace = getInstance();
+        trace.dump(trace.outputPath);
+    });
+}
+
+Trace& Trace::getInstance() {
+    static Trace& trace = *new Trace;
+    return trace;
+}
+
+uint64_t Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Trace::Buffer& Trace::getBuffer() {
+    thread_local std::shared_ptr<Buffer> buffer = [this] {
+        auto newBuffer = std::make_shared<Buffer>();
+
+        const std::lock_guard lock(mutex);
+        newBuffer->threadId = static_cast<uint32_t>(buffers.size()) + 1;
+        buffers.push_back(newBuffer);
+        return newBuffer;
+    }();
+    return *buffer;
+}
+
+void Trace::record(const char* name, const uint64_t start, const uint64_t end) {
+    Buffer& buffer = getBuffer();
+
+    // only this thread writes the count, the dump reads it
+    const uint64_t index = buffer.count.load(std::memory_order_relaxed);
+    Event& event = buffer.events[index & (Buffer::capacity - 1)];
+
+    event.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(end - start, std::memory_order_relaxed);
+
+    event.sequence.store(index * 2 + 2, std::memory_order_release);
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const fs::path& path) {
+    std::ofstream file(path);
+    if (not file.is_open()) {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<Buffer>> threadBuffers;
+    {
+        const std::lock_guard lock(mutex);
+        threadBuffers = buffers;
+    }
+
+    const pid_t processId = getpid();
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    bool isFirst = true;
+    for (const auto& buffer : threadBuffers) {
+        const uint64_t count = buffer->count.load(std::memory_order_acquire);
+        const uint64_t first = count > Buffer::capacity ? count - Buffer::capacity : 0;
+
+        for (uint64_t index = first; index < count; ++index) {
+            const Event& event = buffer->events[index & (Buffer::capacity - 1)];
+
+            const uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+            const char* name = event.name.load(std::memory_order_relaxed);
+            const uint64_t start = event.start.load(std::memory_order_relaxed);
+            const uint64_t duration = event.duration.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // the thread wrapped around and overwrote the event while it was read
+            if (sequence != index * 2 + 2 or event.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+
+            // complete events, with the times in microseconds
+            file << (isFirst ? "\n" : ",\n")
+                 << "{\"name\": \"" << name << "\", \"cat\": \"BFileX\", \"ph\": \"X\", \"pid\": " << processId
+                 << ", \"tid\": " << buffer->threadId
+                 << ", \"ts\": " << start / 1000 << '.' << start / 100 % 10 << start / 10 % 10 << start % 10
+                 << ", \"dur\": " << duration / 1000 << '.' << duration / 100 % 10 << duration / 10 % 10
+                 << duration % 10 << '}';
+            isFirst = false;
+        }
+    }
+
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// records how long parts of the app take, enabled by setting `BFILEX_TRACE` to the file the trace is written to
+// when the app exits, in the Chrome trace format that chrome://tracing and Perfetto open
+// spans are recorded by each thread into its own ring buffer, without locking, keeping the most recent ones.
+// when tracing is disabled a span costs a check of a flag set once at startup
+class Trace {
+    struct Event {
+        // a seqlock: odd while the event is written, so the dump can skip one it read half-written
+        std::atomic<uint64_t> sequence{};
+        std::atomic<const char*> name{};
+        std::atomic<uint64_t> start{};    // nanoseconds of the steady clock
+        std::atomic<uint64_t> duration{}; // nanoseconds
+    };
+
+    // the events of a thread, written only by it
+    struct Buffer {
+        static constexpr size_t capacity = 1 << 16; // a power of two
+
+        uint32_t threadId{};
+        std::atomic<uint64_t> count{}; // events written, the latest `capacity` are kept
+        std::array<Event, capacity> events;
+    };
+
+    std::mutex mutex; // guards `buffers`, only taken the first time a thread records a span
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    fs::path outputPath;
+
+    Trace(); // writes the trace when the app exits if it's enabled
+
+    // the buffer of the calling thread, created the first time it records a span
+    Buffer& getBuffer();
+    void record(const char* name, uint64_t start, uint64_t end);
+    [[nodiscard]] static uint64_t now();
+
+public:
+    // set once from the environment, before any span is recorded
+    static inline const bool isEnabled = std::getenv("BFILEX_TRACE") != nullptr;
+
+    Trace(const Trace&) = delete;
+
+    // times the scope it's in, `name` must outlive the trace, a string literal
+    class Span {
+        const char* name;
+        uint64_t start{};
+
+    public:
+        explicit Span(const char* name)
+            : name(name) {
+            if (isEnabled) {
+                start = now();
+            }
+        }
+
+        Span(const Span&) = delete;
+
+        ~Span() {
+            if (isEnabled) {
+                getInstance().record(name, start, now());
+            }
+        }
+    };
+
+    // writes the spans recorded so far by all the threads, returns false if the file can't be written
+    bool dump(const fs::path& path);
+
+    // never destroyed, threads still running at exit can record spans while the trace is written
+    static Trace& getInstance();
+};
@@ -0,0 +1,344 @@
+#include "Trash.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+#include <utility>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "DeleteEngine.hpp"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace {
+    // `.trashinfo` files store paths percent-encoded
+    std::string encodePath(const std::string& path) {
+        constexpr char hexDigits[] = "0123456789ABCDEF";
+
+        std::string encoded;
+        for (const unsigned char c : path) {
+            if (std::isalnum(c) or c == '/' or c == '-' or c == '_' or c == '.' or c == '~') {
+                encoded.push_back(static_cast<char>(c));
+            } else {
+                encoded += {'%', hexDigits[c >> 4], hexDigits[c & 0xf]};
+            }
+        }
+        return encoded;
+    }
+
+    std::string decodePath(const std::string& encoded) {
+        std::string path;
+        for (size_t i = 0; i < encoded.size(); ++i) {
+            if (encoded[i] == '%' and i + 2 < encoded.size() and std::isxdigit(encoded[i + 1]) and
+                std::isxdigit(encoded[i + 2])) {
+                path.push_back(static_cast<char>(std::stoi(encoded.substr(i + 1, 2), nullptr, 16)));
+                i += 2;
+            } else {
+                path.push_back(encoded[i]);
+            }
+        }
+        return path;
+    }
+
+    // reads a `.trashinfo` file, returns false if it isn't valid
+    bool readInfo(const fs::path& infoPath, TrashEntry& entry) {
+        std::ifstream file(infoPath);
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.rfind("Path=", 0) == 0) {
+                entry.originalPath = decodePath(line.substr(5));
+            } else if (line.rfind("DeletionDate=", 0) == 0) {
+                tm time{};
+                if (strptime(line.c_str() + 13, "%Y-%m-%dT%H:%M:%S", &time) != nullptr) {
+                    time.tm_isdst = -1;
+                    entry.deletionTime = mktime(&time);
+                }
+            }
+        }
+
+        return not entry.originalPath.empty();
+    }
+
+    // runs the purger at the lowest CPU and IO priority so it doesn't slow down browsing
+    void lowerPriority() {
+#ifdef __linux__
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+        // IOPRIO_WHO_PROCESS for the calling thread, IOPRIO_CLASS_IDLE
+        syscall(SYS_ioprio_set, 1, 0, 3 << 13);
+#elif defined(__APPLE__)
+        setpriority(PRIO_DARWIN_THREAD, 0, PRIO_DARWIN_BG);
+#endif
+    }
+}
+
+Trash::Trash() {
+    // started once every member is initialized
+    purger = std::thread(&Trash::run, this);
+}
+
+Trash::~Trash() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    purgeProgress.cancelled.store(true);
+    condition.notify_one();
+
+    if (purger.joinable()) {
+        purger.join();
+    }
+}
+
+Trash& Trash::getInstance() {
+    static Trash trash;
+    return trash;
+}
+
+fs::path Trash::getHomeTrashDirectory() {
+    if (const char* dataHome = std::getenv("XDG_DATA_HOME"); dataHome != nullptr and *dataHome != '\0') {
+        return fs::path(dataHome) / "BFileX" / "Trash";
+    }
+    if (const char* home = std::getenv("HOME"); home != nullptr and *home != '\0') {
+        return fs::path(home) / ".local" / "share" / "BFileX" / "Trash";
+    }
+    return {};
+}
+
+fs::path Trash::getMountPoint(const fs::path& path) {
+    fs::path mountPoint = path;
+
+    struct stat status{};
+    if (stat(mountPoint.c_str(), &status) != 0) {
+        return mountPoint;
+    }
+
+    // go up until the parent is on another device
+    while (mountPoint.has_relative_path()) {
+        struct stat parentStatus{};
+        if (stat(mountPoint.parent_path().c_str(), &parentStatus) != 0 or parentStatus.st_dev != status.st_dev) {
+            break;
+        }
+        mountPoint = mountPoint.parent_path();
+    }
+
+    return mountPoint;
+}
+
+fs::path Trash::getTrashDirectory(const fs::path& path, const bool create) {
+    // the device of the entry's directory, an entry can only be renamed within it
+    struct stat status{};
+    if (stat(path.parent_path().c_str(), &status) != 0) {
+        throw fs::filesystem_error("Failed to find a trash directory", path,
+                                   std::error_code(errno, std::generic_category()));
+    }
+
+    fs::path trashDirectory = getHomeTrashDirectory();
+
+    // the home trash may not exist yet, its device is the one of its closest existing parent
+    fs::path existingParent = trashDirectory;
+    struct stat trashStatus{};
+    while (not existingParent.empty() and stat(existingParent.c_str(), &trashStatus) != 0) {
+        existingParent = existingParent.has_relative_path() ? existingParent.parent_path() : fs::path();
+    }
+
+    if (existingParent.empty() or trashStatus.st_dev != status.st_dev) {
+        trashDirectory = getMountPoint(path.parent_path()) / (".BFileX-Trash-" + std::to_string(getuid()));
+    }
+
+    if (create) {
+        fs::create_directories(trashDirectory / "files");
+        fs::create_directories(trashDirectory / "info");
+        fs::permissions(trashDirectory, fs::perms::owner_all);
+
+        // e.g. the home trash is a symlink to another filesystem
+        if (stat(trashDirectory.c_str(), &trashStatus) != 0 or trashStatus.st_dev != status.st_dev) {
+            throw fs::filesystem_error("Failed to find a trash directory", path,
+                                       std::make_error_code(std::errc::cross_device_link));
+        }
+
+        addTrashDirectory(trashDirectory);
+    }
+
+    return trashDirectory;
+}
+
+void Trash::addTrashDirectory(const fs::path& trashDirectory) {
+    std::lock_guard lock(mutex);
+    if (std::find(trashDirectories.begin(), trashDirectories.end(), trashDirectory) == trashDirectories.end()) {
+        trashDirectories.push_back(trashDirectory);
+    }
+}
+
+TrashEntry Trash::moveToTrash(const fs::path& path) {
+    const fs::path trashDirectory = getTrashDirectory(path, true);
+    const std::string name = path.filename().string();
+
+    TrashEntry entry;
+    entry.originalPath = path;
+    entry.deletionTime = std::time(nullptr);
+
+    // reserve a name in the trash by creating its info file, entries with the same name get a number
+    int infoFile = -1;
+    for (int copy = 1; infoFile < 0; ++copy) {
+        const std::string trashedName = copy == 1 ? name : name + "." + std::to_string(copy);
+        entry.path = trashDirectory / "files" / trashedName;
+        entry.infoPath = trashDirectory / "info" / (trashedName + ".trashinfo");
+
+        infoFile = open(entry.infoPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (infoFile < 0 and errno != EEXIST) {
+            throw fs::filesystem_error("Failed to move to the trash", path,
+                                       std::error_code(errno, std::generic_category()));
+        }
+
+        // an entry without an info file was left behind, keep it and use another name
+        std::error_code error;
+        if (infoFile >= 0 and fs::exists(fs::symlink_status(entry.path, error))) {
+            close(infoFile);
+            unlink(entry.infoPath.c_str());
+            infoFile = -1;
+        }
+    }
+
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&entry.deletionTime));
+    const std::string info = "[Trash Info]\nPath=" + encodePath(path.string()) + "\nDeletionDate=" + date + "\n";
+
+    const bool infoWritten = write(infoFile, info.data(), info.size()) == static_cast<ssize_t>(info.size());
+    close(infoFile);
+
+    if (not infoWritten or rename(path.c_str(), entry.path.c_str()) != 0) {
+        const int error = infoWritten ? errno : EIO;
+        unlink(entry.infoPath.c_str());
+        throw fs::filesystem_error("Failed to move to the trash", path,
+                                   std::error_code(error, std::generic_category()));
+    }
+
+    return entry;
+}
+
+std::vector<TrashEntry> Trash::list(const fs::path& directory) {
+    // the trash of the current filesystem may have been used in another session
+    try {
+        if (const fs::path trashDirectory = directory.empty() ? fs::path() : getTrashDirectory(directory / ".", false);
+            not trashDirectory.empty() and fs::is_directory(trashDirectory / "info")) {
+            addTrashDirectory(trashDirectory);
+        }
+        if (const fs::path homeTrashDirectory = getHomeTrashDirectory();
+            fs::is_directory(homeTrashDirectory / "info")) {
+            addTrashDirectory(homeTrashDirectory);
+        }
+    } catch (const fs::filesystem_error&) {}
+
+    std::vector<fs::path> directories;
+    {
+        std::lock_guard lock(mutex);
+        directories = trashDirectories;
+    }
+
+    std::vector<TrashEntry> entries;
+    for (const fs::path& trashDirectory : directories) {
+        std::error_code error;
+        for (const auto& infoFile : fs::directory_iterator(trashDirectory / "info", error)) {
+            if (infoFile.path().extension() != ".trashinfo") {
+                continue;
+            }
+
+            TrashEntry entry;
+            entry.infoPath = infoFile.path();
+            entry.path = trashDirectory / "files" / infoFile.path().stem();
+
+            if (readInfo(entry.infoPath, entry) and fs::exists(fs::symlink_status(entry.path, error))) {
+                entries.push_back(std::move(entry));
+            }
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const TrashEntry& first, const TrashEntry& second) {
+        return first.deletionTime > second.deletionTime;
+    });
+
+    return entries;
+}
+
+void Trash::restore(const TrashEntry& entry) {
+    // never overwrite what was created in its place since
+    if (fs::exists(fs::symlink_status(entry.originalPath))) {
+        throw fs::filesystem_error("Failed to restore", entry.originalPath,
+                                   std::make_error_code(std::errc::file_exists));
+    }
+
+    fs::create_directories(entry.originalPath.parent_path());
+    fs::rename(entry.path, entry.originalPath);
+
+    std::error_code error;
+    fs::remove(entry.infoPath, error);
+}
+
+void Trash::purge(std::vector<TrashEntry> entries) {
+    {
+        std::lock_guard lock(mutex);
+        purgeQueue.insert(purgeQueue.end(), std::make_move_iterator(entries.begin()),
+                          std::make_move_iterator(entries.end()));
+    }
+    condition.notify_one();
+}
+
+void Trash::purgeEntry(const TrashEntry& entry, ThreadPool& pool) {
+    const uint64_t previousErrors = purgeProgress.errors.load();
+
+    std::error_code error;
+    if (fs::exists(fs::symlink_status(entry.path, error))) {
+        DeleteEngine::remove(entry.path, pool, purgeProgress);
+    }
+
+    // the info file is removed last, an entry that wasn't fully deleted is still listed
+    if (purgeProgress.errors.load() == previousErrors and not purgeProgress.cancelled.load()) {
+        fs::remove(entry.infoPath, error);
+    }
+}
+
+void Trash::run() {
+    lowerPriority();
+    ThreadPool pool(1, lowerPriority);
+
+    std::unique_lock lock(mutex);
+    auto nextExpiredPurge = std::chrono::steady_clock::now() + startupDelay;
+
+    while (true) {
+        condition.wait_until(lock, nextExpiredPurge, [this] { return stopping or not purgeQueue.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        std::vector<TrashEntry> entries = std::exchange(purgeQueue, {});
+        const bool purgeExpired = std::chrono::steady_clock::now() >= nextExpiredPurge;
+        lock.unlock();
+
+        if (purgeExpired) {
+            const time_t expiryTime = std::time(nullptr) - std::chrono::seconds(retention).count();
+            for (TrashEntry& entry : list()) {
+                if (entry.deletionTime < expiryTime) {
+                    entries.push_back(std::move(entry));
+                }
+            }
+        }
+
+        for (const TrashEntry& entry : entries) {
+            if (purgeProgress.cancelled.load()) {
+                break;
+            }
+            purgeEntry(entry, pool);
+        }
+
+        lock.lock();
+        if (purgeExpired) {
+            nextExpiredPurge = std::chrono::steady_clock::now() + purgeInterval;
+        }
+    }
+}
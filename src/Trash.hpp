@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "OperationProgress.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+// an entry moved to the trash
+struct TrashEntry {
+    fs::path path;         // the entry inside the trash
+    fs::path infoPath;     // the file recording where it came from
+    fs::path originalPath; // where it's restored to
+    time_t deletionTime{};
+};
+
+// moves deleted entries to a trash directory on the same filesystem, so deleting is a single rename
+// whatever the size of the entry; entries on the home filesystem go to `$XDG_DATA_HOME/BFileX/Trash`,
+// the others to `.BFileX-Trash-<uid>` at the top of their filesystem
+// trash directories use the freedesktop layout, `files` holds the entries and `info` a `.trashinfo`
+// file for each of them. a background thread with the lowest CPU and IO priority purges the entries
+// older than `retention` and the ones deleted from the trash view
+class Trash {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread purger;
+
+    // trash directories used or found, searched when listing the trash
+    std::vector<fs::path> trashDirectories;
+    // entries deleted permanently from the trash view, waiting to be purged
+    std::vector<TrashEntry> purgeQueue;
+    bool stopping{};
+
+    // progress of the running purge, cancelled when quitting
+    OperationProgress purgeProgress;
+
+    Trash();
+    ~Trash();
+
+    // purges queued and expired entries in the background, runs on `purger`
+    void run();
+    void purgeEntry(const TrashEntry& entry, ThreadPool& pool);
+
+    // returns the trash directory on the filesystem of `path`, creating it if `create` is set
+    fs::path getTrashDirectory(const fs::path& path, bool create);
+    void addTrashDirectory(const fs::path& trashDirectory);
+
+    static fs::path getHomeTrashDirectory();
+    // returns the topmost directory containing `path` on the same filesystem
+    static fs::path getMountPoint(const fs::path& path);
+
+public:
+    // time entries stay restorable before they're purged
+    static constexpr std::chrono::hours retention{24 * 7};
+    // time between purges of expired entries
+    static constexpr std::chrono::minutes purgeInterval{30};
+    // time after startup before the first purge, so it doesn't compete with the first listings
+    static constexpr std::chrono::seconds startupDelay{10};
+
+    Trash(const Trash&) = delete;
+
+    // moves an entry to the trash, throws `fs::filesystem_error` if it can't be moved
+    TrashEntry moveToTrash(const fs::path& path);
+    // lists the entries in the known trash directories and the trash of the filesystem of `directory` if given,
+    // the most recently deleted first
+    std::vector<TrashEntry> list(const fs::path& directory = {});
+    // moves an entry back to where it was deleted from, throws `fs::filesystem_error` if it can't be moved
+    void restore(const TrashEntry& entry);
+    // deletes entries from the trash permanently in the background
+    void purge(std::vector<TrashEntry> entries);
+
+    static Trash& getInstance();
+};
@@ -1,9 +1,12 @@
 #include "UI.hpp"
+#include "DisplayWidth.hpp"
 #include "FileProperties.hpp"
 #include "Terminal++.hpp"
+#include "Trace.hpp"
 
 UI::UI() {
-    initialize();
+    // the terminal is set up by `initialize` once the app starts, so nothing is written before the arguments are
+    // parsed, and the UI can be laid out without a TTY
 
     // setting the terminal dimensions
     auto [nWidth, nHeight] = Terminal::size();
@@ -27,7 +30,29 @@ void UI::initialize() {
 
 }
 
-void UI::printEntry(const std::filesystem::directory_entry& entry, const bool highlight) const {
+int UI::getWidth(const std::string& text) const {
+    // ASCII text takes a column per byte, only the rest is measured and cached
+    if (DisplayWidth::asciiPrefixLength(text) == text.size()) {
+        return static_cast<int>(text.size());
+    }
+
+    if (const auto it = widthCache.find(text); it != widthCache.end()) {
+        return it->second;
+    }
+
+    if (widthCache.size() >= maxCachedWidths) {
+        widthCache.clear();
+    }
+    return widthCache[text] = DisplayWidth::width(text);
+}
+
+void UI::printEntry(const std::filesystem::directory_entry& entry, const int width, const bool highlight,
+                    const bool marked) const {
+    // the padding before marked entries is replaced by a mark
+    if (marked) {
+        Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print("*");
+    }
+
     Printer printer;
     printer.setTextStyle(TextStyle::Bold);
 
@@ -39,28 +64,46 @@ void UI::printEntry(const std::filesystem::directory_entry& entry, const bool hi
     else
         printer.setTextColor(color);
 
-    // construct the string to be printed with icon and file name
-    std::string entryStr = FileProperties::Mapper::getIcon(entry).representation +
-                           FileProperties::MetaData::getName(entry).string();
+    // the icon and file name, measured in terminal columns since both can contain multibyte characters
+    const FileProperties::Icon icon = FileProperties::Mapper::getIcon(entry);
+    std::string name = FileProperties::MetaData::getName(entry).string();
+
+    const int iconWidth = getWidth(icon.representation);
+    int nameWidth = getWidth(name);
 
-    // limiting the number of characters printed to terminal width
-    if (static_cast<int>(entryStr.size()) >= highlightWidth)
-        entryStr = entryStr.substr(0, highlightWidth - 5) + "~";
+    // limiting the number of columns printed to the highlight width
+    if (iconWidth + nameWidth >= width) {
+        name = std::string(DisplayWidth::truncate(name, std::max(width - 5 - iconWidth, 0), nameWidth)) + "~";
+        nameWidth = getWidth(name);
+    }
 
-    // adding a whitespace for padding and using std::setw() to limit the highlight to its width
-    printer.print(" ", entryStr, std::setw(highlightWidth - static_cast<int>(entryStr.size())), " ");
+    // adding a whitespace for padding and filling the rest of the highlight width
+    printer.print(marked ? "" : " ", icon.representation, name,
+                  std::string(std::max(width - iconWidth - nameWidth, 1), ' '));
 
     Printer().println();
 }
 
-void UI::renderTopBar(const std::string& currentPath) const {
+void UI::renderTopBar(const std::string& currentPath, const size_t tabCount, const size_t tabIndex) const {
+    // the tabs numbered from 1 with the current one in brackets, or only the current one if they don't fit
+    std::string tabs;
+    if (tabCount > 1) {
+        for (size_t i = 0; i < tabCount; ++i) {
+            tabs += i == tabIndex ? " [" + std::to_string(i + 1) + "]" : "  " + std::to_string(i + 1) + " ";
+        }
+        if (static_cast<int>(tabs.size()) > terminalWidth / 2) {
+            tabs = " [" + std::to_string(tabIndex + 1) + "/" + std::to_string(tabCount) + "]";
+        }
+    }
+    const int pathWidth = terminalWidth - static_cast<int>(tabs.size());
+
     std::string topBar = "$ " + currentPath; // storing the prompt, the absolute path, and the current entry's name
     // finding the index of the last seprator to change the color of the selected entry
     const auto lastSlashIndex = topBar.find_last_of(std::filesystem::path::preferred_separator);
 
-    // limiting it to the terminal width
-    if (topBar.size() > terminalWidth)
-        topBar = topBar.substr(0, terminalWidth - 1) + "~";
+    // limiting it to the width left by the tabs
+    if (DisplayWidth::width(topBar) > pathWidth)
+        topBar = std::string(DisplayWidth::truncate(topBar, pathWidth - 1)) + "~";
 
     // printing the prompt and the path in blue
     Printer(Color::Blue).setTextStyle(TextStyle::Bold).print(
@@ -69,11 +112,17 @@ void UI::renderTopBar(const std::string& currentPath) const {
 
     // check if we can print the current entry's name
     if (lastSlashIndex < static_cast<int>(topBar.length()))
-        Printer().println(topBar.substr(lastSlashIndex + 1));
+        Printer().print(topBar.substr(lastSlashIndex + 1));
+
+    if (not tabs.empty()) {
+        Cursor::moveTo(pathWidth + 1, 1);
+        Printer(Color::Blue).setTextStyle(TextStyle::Bold).print(tabs);
+    }
+    Printer().println();
 }
 
 void UI::renderEntries(const std::vector<fs::directory_entry>& entries, const size_t currentIndex, const int startX,
-                       const int startY) {
+                       const int startY, const Selection* selection, const int width) {
     const size_t totalEntries = entries.size();
     const size_t maxVisibleEntries = terminalHeight - startY; // display height for the entries
 
@@ -100,35 +149,402 @@ void UI::renderEntries(const std::vector<fs::directory_entry>& entries, const si
     // Render visible entries
     for (size_t i = startingIndex; i < endIndex; ++i) {
         Cursor::moveTo(startX, startY + verticalOffset++);
-        printEntry(entries[i], i == currentIndex);
+        printEntry(entries[i], width > 0 ? width : highlightWidth, i == currentIndex,
+                   selection != nullptr and selection->isSelected(i));
     }
 }
 
-void UI::renderPreview(const fs::directory_entry& entry) {
-    // return if it's a binary file
-    if (FileProperties::Utilities::isBinary(entry.path().string())) {
-        return;
+void UI::renderParentEntries(const std::vector<fs::directory_entry>& entries, const size_t currentIndex) const {
+    // the entries are already the rows shown
+    for (size_t i = 0; i < entries.size() and static_cast<int>(i) < terminalHeight - 2; ++i) {
+        Cursor::moveTo(1, 2 + static_cast<int>(i));
+        printEntry(entries[i], parentColumnWidth, i == currentIndex);
     }
+}
+
+std::pair<int, int> UI::getEntriesColumn(const bool showColumns) const {
+    if (showColumns) {
+        return {parentColumnWidth + 2, highlightWidth - parentColumnWidth - 1};
+    }
+    return {1, highlightWidth};
+}
+
+void UI::renderPreview(const fs::directory_entry& entry) {
+    const Trace::Span span("renderPreview");
 
     const EntryType entryType = FileProperties::Types::determineEntryType(entry);
-    
-    if (entryType == EntryType::RegularFile) {
-        const std::string filePath = FileProperties::MetaData::getName(entry).string();
 
-        // renders the preview for selected file
+    if (entryType == EntryType::RegularFile or entryType == EntryType::Executable) {
+        const std::string filePath = entry.path().string();
+
+        // renders the preview for selected file, binary files are shown as hex
         filePreview.render(filePath);
     } else if (entryType == EntryType::Directory and not FileProperties::Utilities::isDotDot(entry)) {
         App& app = App::getInstance();
 
+        constexpr int startY = 3;
+        const size_t rows = std::max(terminalHeight - startY, 1);
+        const size_t cachedIndex = app.getCachedIndex(entry.path());
+
+        const DirectoryPage page = app.getCurrentEntryChildren(getPreviewEntryCount(cachedIndex),
+                                                               maxPreviewReadEntries);
+
         // render preview for the children of the current entry
-        renderEntries(app.getCurrentEntryChildren(), app.getCachedIndex(entry.path()), terminalWidth / 2 + 1, 3);
+        renderEntries(page.entries, cachedIndex, terminalWidth / 2 + 1, startY);
+
+        // mark the entries that weren't listed, with a `+` if the directory wasn't read to the end
+        if ((page.remaining > 0 or not page.complete) and page.entries.size() < rows) {
+            Cursor::moveTo(terminalWidth / 2 + 2, startY + static_cast<int>(page.entries.size()));
+            Printer(Color::Yellow).print(std::to_string(page.remaining), page.complete ? "" : "+", " more");
+        }
     }
 }
 
+size_t UI::getPreviewEntryCount(const size_t cachedIndex) const {
+    const size_t rows = std::max(terminalHeight - 3, 1);
+
+    // only list the rows that fit, leaving the last one for the marker,
+    // or enough to reach the previously selected entry
+    return std::min(std::max(rows - 1, cachedIndex + 1), maxPreviewReadEntries + 1);
+}
+
+size_t UI::getPageSize() const {
+    return std::max(terminalHeight - 2, 1);
+}
+
+std::pair<int, int> UI::getThumbnailSize() const {
+    return filePreview.getThumbnailSize();
+}
+
 void UI::clearPreview() const {
     filePreview.clearPreview();
 }
 
+void UI::renderJobs(const std::vector<std::shared_ptr<Job>>& jobs, const size_t selectedIndex) const {
+    clearPreview();
+
+    constexpr int startY = 3;
+    const int startX = terminalWidth / 2 + 2;
+    const int maxWidth = std::max(terminalWidth - startX, 0);
+
+    Cursor::moveTo(startX, startY);
+    Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print("Jobs");
+
+    if (jobs.empty()) {
+        Cursor::moveTo(startX, startY + 2);
+        Printer().print("No jobs");
+        return;
+    }
+
+    // every job takes two rows: its description and its progress
+    const size_t visibleJobs = std::max((terminalHeight - startY - 2) / 2, 1);
+    const size_t firstJob = selectedIndex >= visibleJobs ? selectedIndex - visibleJobs + 1 : 0;
+
+    for (size_t i = firstJob; i < std::min(firstJob + visibleJobs, jobs.size()); ++i) {
+        const Job& job = *jobs[i];
+        const int row = startY + 2 + static_cast<int>(i - firstJob) * 2;
+
+        Color::Code color = Color::White;
+        switch (job.state.load()) {
+            case JobState::Running:
+                color = Color::Yellow;
+                break;
+            case JobState::Done:
+                color = job.progress.errors.load() > 0 ? Color::Red : Color::Green;
+                break;
+            case JobState::Cancelled:
+                color = Color::Red;
+                break;
+            default:
+                break;
+        }
+
+        Printer printer(color);
+        if (i == selectedIndex) {
+            printer.setTextStyle(TextStyle::Bold);
+        }
+
+        Cursor::moveTo(startX, row);
+        printer.print(DisplayWidth::truncate((i == selectedIndex ? "> " : "  ") + job.description, maxWidth));
+
+        Cursor::moveTo(startX, row + 1);
+        Printer().print(DisplayWidth::truncate("    " + JobQueue::formatProgress(job), maxWidth));
+    }
+}
+
+void UI::renderTrash(const std::vector<TrashEntry>& entries, const size_t selectedIndex) const {
+    clearPreview();
+
+    constexpr int startY = 3;
+    const int startX = terminalWidth / 2 + 2;
+    const int maxWidth = std::max(terminalWidth - startX, 0);
+
+    Cursor::moveTo(startX, startY);
+    Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print("Trash");
+
+    if (entries.empty()) {
+        Cursor::moveTo(startX, startY + 2);
+        Printer().print("The trash is empty");
+        return;
+    }
+
+    // every entry takes two rows: its name and where and when it was deleted from
+    const size_t visibleEntries = std::max((terminalHeight - startY - 2) / 2, 1);
+    const size_t firstEntry = selectedIndex >= visibleEntries ? selectedIndex - visibleEntries + 1 : 0;
+
+    for (size_t i = firstEntry; i < std::min(firstEntry + visibleEntries, entries.size()); ++i) {
+        const TrashEntry& entry = entries[i];
+        const int row = startY + 2 + static_cast<int>(i - firstEntry) * 2;
+
+        Printer printer(FileProperties::Mapper::getColor(fs::directory_entry(entry.path)));
+        if (i == selectedIndex) {
+            printer.setTextStyle(TextStyle::Bold);
+        }
+
+        Cursor::moveTo(startX, row);
+        printer.print(DisplayWidth::truncate((i == selectedIndex ? "> " : "  ") +
+                                             entry.originalPath.filename().string(), maxWidth));
+
+        char date[32];
+        std::strftime(date, sizeof(date), "%b %e %H:%M", std::localtime(&entry.deletionTime));
+
+        Cursor::moveTo(startX, row + 1);
+        Printer().print(DisplayWidth::truncate("    " + std::string(date) + "  " +
+                                               entry.originalPath.parent_path().string(), maxWidth));
+    }
+}
+
+void UI::renderDuplicates(const std::vector<DuplicateGroup>& groups, const fs::path& directory,
+                          const size_t selectedIndex, const Selection& marks) const {
+    clearPreview();
+
+    constexpr int startY = 3;
+    const int startX = terminalWidth / 2 + 2;
+    const int maxWidth = std::max(terminalWidth - startX, 0);
+
+    Cursor::moveTo(startX, startY);
+    Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print("Duplicates");
+
+    if (groups.empty()) {
+        Cursor::moveTo(startX, startY + 2);
+        Printer().print("No duplicates left");
+        return;
+    }
+
+    // every group takes a row for its size followed by a row per file
+    size_t selectedRow = selectedIndex;
+    for (size_t group = 0, files = 0; group < groups.size() and files <= selectedIndex; ++group) {
+        files += groups[group].files.size();
+        ++selectedRow;
+    }
+
+    const size_t visibleRows = std::max(terminalHeight - startY - 2, 1);
+    const size_t firstRow = selectedRow >= visibleRows ? selectedRow - visibleRows + 1 : 0;
+
+    size_t row = 0;
+    size_t fileIndex = 0;
+    for (const DuplicateGroup& group : groups) {
+        if (row >= firstRow + visibleRows) {
+            break;
+        }
+
+        if (row >= firstRow) {
+            Cursor::moveTo(startX, startY + 2 + static_cast<int>(row - firstRow));
+            Printer(Color::Yellow).print(DisplayWidth::truncate(
+                std::to_string(group.files.size()) + " copies of " +
+                FileProperties::MetaData::formatSize(group.size), maxWidth));
+        }
+        ++row;
+
+        for (const DuplicateFile& file : group.files) {
+            if (row >= firstRow and row < firstRow + visibleRows) {
+                Printer printer(FileProperties::Mapper::getColor(fs::directory_entry(file.path)));
+                if (fileIndex == selectedIndex) {
+                    printer.setTextStyle(TextStyle::Bold);
+                }
+
+                Cursor::moveTo(startX, startY + 2 + static_cast<int>(row - firstRow));
+                printer.print(DisplayWidth::truncate(std::string(fileIndex == selectedIndex ? "> " : "  ") +
+                                                     (marks.isSelected(fileIndex) ? "* " : "  ") +
+                                                     file.path.lexically_relative(directory).string(), maxWidth));
+            }
+            ++row;
+            ++fileIndex;
+        }
+    }
+}
+
+void UI::renderTree(const DirectoryTree& tree, const uint32_t topNode, const uint32_t selectedNode) const {
+    Cursor::moveTo(1, 1);
+    Screen::clear(ClearType::Line);
+    renderTopBar(tree.getPath(selectedNode).string());
+
+    constexpr int startY = 2;
+    const int rows = std::max(terminalHeight - startY, 0);
+
+    uint32_t index = topNode;
+    for (int row = 0; row < rows; ++row) {
+        Cursor::moveTo(1, startY + row);
+
+        // clear the rows below the last node
+        if (index == DirectoryTree::noNode) {
+            Printer().print(std::string(std::max(highlightWidth, 0), ' '));
+            continue;
+        }
+
+        const TreeNode& node = tree.getNode(index);
+        std::error_code error;
+        const fs::directory_entry entry(tree.getPath(index), error);
+        const Color::Code color = FileProperties::Mapper::getColor(entry);
+
+        // indented by depth, directories are marked with `+` when collapsed and `-` when expanded
+        std::string text = std::string(2 * (node.depth - 1) + 1, ' ') +
+                           (node.isDirectory ? (node.isExpanded ? "- " : "+ ") : "  ") +
+                           FileProperties::Mapper::getIcon(entry).representation + std::string(tree.getName(index));
+
+        int width = DisplayWidth::width(text);
+        if (width >= highlightWidth) {
+            text = std::string(DisplayWidth::truncate(text, highlightWidth - 2, width)) + "~";
+            ++width;
+        }
+
+        Printer printer;
+        printer.setTextStyle(TextStyle::Bold);
+        if (index == selectedNode) {
+            printer.setTextColor(Color::Black).setBackgroundColor(color);
+        } else {
+            printer.setTextColor(color);
+        }
+        printer.print(text, std::string(std::max(highlightWidth - width, 1), ' '));
+
+        index = tree.getNext(index);
+    }
+}
+
+void UI::renderJumpResults(const std::vector<fs::path>& directories, const size_t selectedIndex) const {
+    clearPreview();
+
+    constexpr int startY = 3;
+    const int startX = terminalWidth / 2 + 2;
+    const int maxWidth = std::max(terminalWidth - startX, 0);
+
+    Cursor::moveTo(startX, startY);
+    Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print("Jump");
+
+    if (directories.empty()) {
+        Cursor::moveTo(startX, startY + 2);
+        Printer().print("No matching directories");
+        return;
+    }
+
+    const size_t visibleDirectories = std::max(terminalHeight - startY - 2, 1);
+    for (size_t i = 0; i < std::min(visibleDirectories, directories.size()); ++i) {
+        Printer printer(Color::Blue);
+        if (i == selectedIndex) {
+            printer.setTextStyle(TextStyle::Bold);
+        }
+
+        Cursor::moveTo(startX, startY + 2 + static_cast<int>(i));
+        printer.print(DisplayWidth::truncate((i == selectedIndex ? "> " : "  ") + directories[i].string(), maxWidth));
+    }
+}
+
+void UI::renderComparison(const std::vector<ComparedEntry>& entries, const fs::path& left, const fs::path& right,
+                          const size_t selectedIndex, const std::string& summary) const {
+    // the view replaces everything but the footer
+    for (int row = 1; row < terminalHeight; ++row) {
+        Cursor::moveTo(1, row);
+        Screen::clear(ClearType::Line);
+    }
+
+    // each side takes half of the screen, with the status of the entries between them
+    const int columnWidth = std::max((terminalWidth - 3) / 2, 0);
+    const int rightX = columnWidth + 4;
+    constexpr int startY = 4;
+
+    Cursor::moveTo(1, 1);
+    Printer(Color::Yellow).setTextStyle(TextStyle::Bold).print(DisplayWidth::truncate("Compare  " + summary,
+                                                                                      terminalWidth));
+    Cursor::moveTo(1, 2);
+    Printer(Color::Blue).setTextStyle(TextStyle::Bold).print(DisplayWidth::truncate(left.string(), columnWidth));
+    Cursor::moveTo(rightX, 2);
+    Printer(Color::Blue).setTextStyle(TextStyle::Bold).print(DisplayWidth::truncate(right.string(), columnWidth));
+
+    if (entries.empty()) {
+        Cursor::moveTo(1, startY);
+        Printer().print("No differences");
+        return;
+    }
+
+    const size_t visibleEntries = std::max(terminalHeight - startY, 1);
+    const size_t firstEntry = selectedIndex >= visibleEntries ? selectedIndex - visibleEntries + 1 : 0;
+
+    for (size_t i = firstEntry; i < std::min(firstEntry + visibleEntries, entries.size()); ++i) {
+        const ComparedEntry& entry = entries[i];
+        const int row = startY + static_cast<int>(i - firstEntry);
+
+        Color::Code color = Color::White;
+        std::string_view status = "=";
+        switch (entry.status) {
+            case ComparisonStatus::OnlyLeft:
+                color = Color::Green;
+                status = ">";
+                break;
+            case ComparisonStatus::OnlyRight:
+                color = Color::Green;
+                status = "<";
+                break;
+            case ComparisonStatus::Different:
+                color = Color::Red;
+                status = "!";
+                break;
+            default:
+                break;
+        }
+
+        Printer printer(color);
+        if (i == selectedIndex) {
+            printer.setTextStyle(TextStyle::Bold);
+        }
+
+        // a side shows the entry's path and the size of files, or nothing if the entry is missing there
+        const auto describe = [&](const ComparedFile& file) {
+            if (not file.exists) {
+                return std::string();
+            }
+            return std::string(i == selectedIndex ? "> " : "  ") + entry.relativePath +
+                   (file.isDirectory ? "/" : "  " + FileProperties::MetaData::formatSize(file.size));
+        };
+
+        Cursor::moveTo(1, row);
+        printer.print(DisplayWidth::truncate(describe(entry.left), columnWidth));
+        Cursor::moveTo(columnWidth + 2, row);
+        printer.print(status);
+        Cursor::moveTo(rightX, row);
+        printer.print(DisplayWidth::truncate(describe(entry.right), columnWidth));
+    }
+}
+
+void UI::startPreviewScroll() {
+    filePreview.startScrolling();
+}
+
+void UI::scrollPreview(const PreviewScroll command, const uint64_t line) {
+    filePreview.scroll(command, line);
+}
+
+bool UI::isPreviewScrollPending() const {
+    return filePreview.isScrollPending();
+}
+
+void UI::resolvePendingPreviewScroll() {
+    filePreview.resolvePendingScroll();
+}
+
+uint64_t UI::getPreviewScrollOffset() const {
+    return filePreview.getScrollOffset();
+}
+
 void UI::renderFooter(App& app) const {
     // move to the bottom of the screen to render the footer
     Cursor::moveTo(1, terminalHeight);
@@ -138,6 +554,33 @@ void UI::renderFooter(App& app) const {
     if (const auto& footer = app.getCustomFooter(); footer != nullptr)
         return footer();
 
+    // show the current entry index and total entries in the directory
+    std::string directoryNumber =
+            " " + std::to_string(app.getCurrentEntryIndex() + 1) +
+            "/" + std::to_string(static_cast<int>(app.getEntries().size()));
+
+    // the number of marked entries is shown before it
+    if (const size_t markedCount = app.getSelection().count(); markedCount > 0) {
+        directoryNumber = " " + std::to_string(markedCount) + " marked " + directoryNumber;
+    }
+
+    // the progress of a running job replaces the entry's details
+    const JobQueue& jobQueue = JobQueue::getInstance();
+    if (const std::shared_ptr<Job> job = jobQueue.getRunningJob(); job != nullptr) {
+        std::string status = job->description + "  " + JobQueue::formatProgress(*job);
+        if (const size_t queued = jobQueue.getQueuedCount(); queued > 0) {
+            status += "  (+" + std::to_string(queued) + " queued)";
+        }
+
+        const int maxWidth = terminalWidth - static_cast<int>(directoryNumber.length()) - 1;
+        Printer(Color::Yellow).print(DisplayWidth::truncate(status, std::max(maxWidth, 0)));
+
+        // move to the end of the row to print the directory index information
+        Cursor::moveTo(terminalWidth - static_cast<int>(directoryNumber.length()) + 1, terminalHeight);
+        Printer().print(directoryNumber);
+        return;
+    }
+
     // getting the entry's last write time
     const time_t lastWriteTime = FileProperties::MetaData::getLastWriteTime(app.getCurrentEntry().path());
 
@@ -166,11 +609,6 @@ void UI::renderFooter(App& app) const {
     // printing the formatted size of the current entry
     Printer().print("  ", FileProperties::MetaData::getSizeAsString(app.getCurrentEntry()));
 
-    // show the current entry index and total entries in the directory
-    const std::string directoryNumber =
-            " " + std::to_string(app.getCurrentEntryIndex() + 1) +
-            "/" + std::to_string(static_cast<int>(app.getEntries().size()));
-
     // move to the end of the row to print the directory index information
     Cursor::moveTo(terminalWidth - static_cast<int>(directoryNumber.length()) + 1, terminalHeight);
     Printer().print(directoryNumber);
@@ -181,6 +619,8 @@ void UI::resize(const int nWidth, const int nHeight) {
     terminalWidth = nWidth, terminalHeight = nHeight;
     // the entry highlighting width is limited to half of the screen
     highlightWidth = terminalWidth / 2;
+    // the parent directory's column takes a third of it
+    parentColumnWidth = highlightWidth / 3;
 
     // resizeing the preview with the new dimensions
     filePreview.resize(terminalWidth, terminalHeight);
@@ -1,7 +1,12 @@
 #pragma once
 
 #include "App.hpp"
+#include "DirectoryComparer.hpp"
+#include "DirectoryTree.hpp"
+#include "DuplicateFinder.hpp"
 #include "FilePreview.hpp"
+#include "JobQueue.hpp"
+#include "Trash.hpp"
 
 class UI {
     // terminal dimensions
@@ -10,6 +15,8 @@ class UI {
 
     // width of the highlighting used to indicate the selected entry
     int highlightWidth{};
+    // width of the parent directory's column, taken from the entries' half of the screen when it's shown
+    int parentColumnWidth{};
 
     // the starting index for rendering directory entries
     size_t startingIndex{};
@@ -17,26 +24,76 @@ class UI {
     // preview renderer for files
     FilePreview filePreview;
 
-    // print a single directory entry with optional highlighting
-    void printEntry(const std::filesystem::directory_entry& entry, bool highlight = false) const;
+    // number of columns of the icons and names of entries that aren't ASCII
+    mutable std::unordered_map<std::string, int> widthCache;
+    // number of widths cached before the cache is cleared
+    static constexpr size_t maxCachedWidths = 4096;
 
-    UI(); // initialize the terminal
+    // returns the number of columns the text takes, caching it if it's not ASCII
+    int getWidth(const std::string& text) const;
+
+    // print a single directory entry `width` columns wide with optional highlighting, marked entries start with a `*`
+    void printEntry(const std::filesystem::directory_entry& entry, int width, bool highlight = false,
+                    bool marked = false) const;
+
+    UI(); // lay out the UI for the terminal's size
 public:
+    // maximum number of children read to preview a directory
+    static constexpr size_t maxPreviewReadEntries = 4096;
+
     UI(UI&) = delete; // deleting the copy constructor
     ~UI();            // restore the terminal to its previous state
 
     // initialize the termianl
     static void initialize();
-    // render the top bar with the current path
-    void renderTopBar(const std::string& currentPath) const;
-    // render the entries
-    void renderEntries(const std::vector<fs::directory_entry>& entries, size_t currentIndex, int startX, int startY);
+    // render the top bar with the current path, and the tabs on the right when there's more than one
+    void renderTopBar(const std::string& currentPath, size_t tabCount = 1, size_t tabIndex = 0) const;
+    // render the entries, `width` columns wide or as wide as the highlighting if 0
+    void renderEntries(const std::vector<fs::directory_entry>& entries, size_t currentIndex, int startX, int startY,
+                       const Selection* selection = nullptr, int width = 0);
+    // render the parent directory's entries in a column on the left, highlighting the one at `currentIndex`
+    void renderParentEntries(const std::vector<fs::directory_entry>& entries, size_t currentIndex) const;
+    // returns the column the entries start at and their width, right of the parent directory's column if it's shown
+    [[nodiscard]] std::pair<int, int> getEntriesColumn(bool showColumns) const;
     // render the footer with file details or a custom set footer
     void renderFooter(App& app) const;
     // render file preview
     void renderPreview(const fs::directory_entry& entry);
     // clear file preview area
     void clearPreview() const;
+    // render the job list in the preview area, highlighting the job at `selectedIndex`
+    void renderJobs(const std::vector<std::shared_ptr<Job>>& jobs, size_t selectedIndex) const;
+    // render the entries in the trash in the preview area, highlighting the entry at `selectedIndex`
+    void renderTrash(const std::vector<TrashEntry>& entries, size_t selectedIndex) const;
+    // render groups of duplicate files in the preview area with paths relative to `directory`,
+    // files are numbered across groups, highlighting the file at `selectedIndex`
+    void renderDuplicates(const std::vector<DuplicateGroup>& groups, const fs::path& directory, size_t selectedIndex,
+                          const Selection& marks) const;
+    // render the nodes of a tree shown from `topNode` in the entry list, highlighting `selectedNode`
+    // only the rows that fit are walked, whatever the size of the tree
+    void renderTree(const DirectoryTree& tree, uint32_t topNode, uint32_t selectedNode) const;
+    // render the directories matching a jump query in the preview area, highlighting the one at `selectedIndex`
+    void renderJumpResults(const std::vector<fs::path>& directories, size_t selectedIndex) const;
+    // render the compared entries of `left` and `right` side by side over the whole screen,
+    // highlighting the entry at `selectedIndex`
+    void renderComparison(const std::vector<ComparedEntry>& entries, const fs::path& left, const fs::path& right,
+                          size_t selectedIndex, const std::string& summary) const;
+    // start scrolling the previewed file
+    void startPreviewScroll();
+    // scroll the previewed file
+    void scrollPreview(PreviewScroll command, uint64_t line = 0);
+    // whether a line jumped to in the preview waits for the file to be indexed up to it
+    [[nodiscard]] bool isPreviewScrollPending() const;
+    // go to the line jumped to in the preview once the file is indexed up to it
+    void resolvePendingPreviewScroll();
+    // offset of the first line shown in the file preview
+    [[nodiscard]] uint64_t getPreviewScrollOffset() const;
+    // number of children listed to preview a directory whose previously selected entry is at `cachedIndex`
+    [[nodiscard]] size_t getPreviewEntryCount(size_t cachedIndex) const;
+    // number of entries shown at once in the entry list
+    [[nodiscard]] size_t getPageSize() const;
+    // size in pixels of image thumbnails in the preview
+    [[nodiscard]] std::pair<int, int> getThumbnailSize() const;
     // resize the UI for the terminal
     void resize(int nWidth, int nHeight);
 
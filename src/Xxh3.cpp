@@ -0,0 +1,311 @@
+#include "Xxh3.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#define BFILEX_XXH3_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr uint32_t prime32_1 = 0x9E3779B1U;
+    constexpr uint32_t prime32_2 = 0x85EBCA77U;
+    constexpr uint32_t prime32_3 = 0xC2B2AE3DU;
+    constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t prime64_3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ULL;
+    constexpr uint64_t primeMx1 = 0x165667919E3779F9ULL;
+    constexpr uint64_t primeMx2 = 0x9FB21C651E98DF25ULL;
+
+    // offsets into the secret used by the long input loop
+    constexpr size_t lastStripeSecretOffset = Xxh3::secretSize - Xxh3::stripeLength - 7;
+    constexpr size_t mergeSecretOffset = 11;
+
+    alignas(64) constexpr unsigned char defaultSecret[Xxh3::secretSize] = {
+        0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+        0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+        0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+        0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+        0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+        0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+        0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+        0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+        0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+        0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+        0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+        0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+    };
+
+    // inputs are read as little-endian words, like the reference implementation
+    uint32_t read32(const unsigned char* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint64_t read64(const unsigned char* data) {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint64_t rotateLeft(const uint64_t value, const int bits) {
+        return value << bits | value >> (64 - bits);
+    }
+
+    // multiplies to 128 bits and folds the halves together
+    uint64_t multiplyFold(const uint64_t first, const uint64_t second) {
+        const unsigned __int128 product = static_cast<unsigned __int128>(first) * second;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+
+    uint64_t xxh64Avalanche(uint64_t hash) {
+        hash ^= hash >> 33;
+        hash *= prime64_2;
+        hash ^= hash >> 29;
+        hash *= prime64_3;
+        return hash ^ hash >> 32;
+    }
+
+    uint64_t avalanche(uint64_t hash) {
+        hash ^= hash >> 37;
+        hash *= primeMx1;
+        return hash ^ hash >> 32;
+    }
+
+    uint64_t rrmxmx(uint64_t hash, const uint64_t length) {
+        hash ^= rotateLeft(hash, 49) ^ rotateLeft(hash, 24);
+        hash *= primeMx2;
+        hash ^= (hash >> 35) + length;
+        hash *= primeMx2;
+        return hash ^ hash >> 28;
+    }
+
+    uint64_t mix16(const unsigned char* data, const unsigned char* secret) {
+        return multiplyFold(read64(data) ^ read64(secret), read64(data + 8) ^ read64(secret + 8));
+    }
+
+    // inputs up to 240 bytes are hashed without the stripe loop
+    uint64_t hashShort(const unsigned char* data, const size_t length) {
+        const unsigned char* secret = defaultSecret;
+
+        if (length == 0) {
+            return xxh64Avalanche(read64(secret + 56) ^ read64(secret + 64));
+        }
+        if (length <= 3) {
+            const uint32_t combined = static_cast<uint32_t>(data[0]) << 16 |
+                                      static_cast<uint32_t>(data[length >> 1]) << 24 |
+                                      static_cast<uint32_t>(data[length - 1]) |
+                                      static_cast<uint32_t>(length) << 8;
+            return xxh64Avalanche(combined ^ static_cast<uint64_t>(read32(secret) ^ read32(secret + 4)));
+        }
+        if (length <= 8) {
+            const uint64_t input = read32(data + length - 4) + (static_cast<uint64_t>(read32(data)) << 32);
+            return rrmxmx(input ^ (read64(secret + 8) ^ read64(secret + 16)), length);
+        }
+        if (length <= 16) {
+            const uint64_t low = read64(data) ^ (read64(secret + 24) ^ read64(secret + 32));
+            const uint64_t high = read64(data + length - 8) ^ (read64(secret + 40) ^ read64(secret + 48));
+            return avalanche(length + __builtin_bswap64(low) + high + multiplyFold(low, high));
+        }
+
+        uint64_t accumulator = length * prime64_1;
+
+        if (length <= 128) {
+            if (length > 32) {
+                if (length > 64) {
+                    if (length > 96) {
+                        accumulator += mix16(data + 48, secret + 96);
+                        accumulator += mix16(data + length - 64, secret + 112);
+                    }
+                    accumulator += mix16(data + 32, secret + 64);
+                    accumulator += mix16(data + length - 48, secret + 80);
+                }
+                accumulator += mix16(data + 16, secret + 32);
+                accumulator += mix16(data + length - 32, secret + 48);
+            }
+            accumulator += mix16(data, secret);
+            accumulator += mix16(data + length - 16, secret + 16);
+            return avalanche(accumulator);
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            accumulator += mix16(data + 16 * i, secret + 16 * i);
+        }
+        accumulator = avalanche(accumulator);
+
+        for (size_t i = 8; i < length / 16; ++i) {
+            accumulator += mix16(data + 16 * i, secret + 16 * (i - 8) + 3);
+        }
+        accumulator += mix16(data + length - 16, secret + 136 - 17);
+        return avalanche(accumulator);
+    }
+
+    void accumulateStripe(uint64_t* accumulators, const unsigned char* data, const unsigned char* secret) {
+        for (size_t i = 0; i < 8; ++i) {
+            const uint64_t value = read64(data + 8 * i);
+            const uint64_t key = value ^ read64(secret + 8 * i);
+            accumulators[i ^ 1] += value;
+            accumulators[i] += (key & 0xFFFFFFFF) * (key >> 32);
+        }
+    }
+
+    void scramble(uint64_t* accumulators, const unsigned char* secret) {
+        for (size_t i = 0; i < 8; ++i) {
+            uint64_t accumulator = accumulators[i];
+            accumulator ^= accumulator >> 47;
+            accumulator ^= read64(secret + 8 * i);
+            accumulators[i] = accumulator * prime32_1;
+        }
+    }
+
+    // accumulates whole blocks, scrambling after each of them
+    void accumulateBlocks(uint64_t* accumulators, const unsigned char* data, const size_t blocks) {
+        for (size_t block = 0; block < blocks; ++block, data += Xxh3::blockLength) {
+            for (size_t stripe = 0; stripe < Xxh3::stripesPerBlock; ++stripe) {
+                accumulateStripe(accumulators, data + stripe * Xxh3::stripeLength, defaultSecret + stripe * 8);
+            }
+            scramble(accumulators, defaultSecret + Xxh3::secretSize - Xxh3::stripeLength);
+        }
+    }
+
+#ifdef BFILEX_XXH3_AVX2
+    // the same loop with four accumulators per instruction
+    __attribute__((target("avx2")))
+    void accumulateBlocksAvx2(uint64_t* accumulators, const unsigned char* data, const size_t blocks) {
+        __m256i lanes[2] = {
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators + 4)),
+        };
+        const __m256i prime = _mm256_set1_epi32(static_cast<int>(prime32_1));
+
+        for (size_t block = 0; block < blocks; ++block, data += Xxh3::blockLength) {
+            for (size_t stripe = 0; stripe < Xxh3::stripesPerBlock; ++stripe) {
+                const unsigned char* input = data + stripe * Xxh3::stripeLength;
+                const unsigned char* secret = defaultSecret + stripe * 8;
+
+                for (size_t i = 0; i < 2; ++i) {
+                    const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 32 * i));
+                    const __m256i key = _mm256_xor_si256(
+                        value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret + 32 * i)));
+                    // low half of each key times its high half
+                    const __m256i product = _mm256_mul_epu32(key, _mm256_srli_epi64(key, 32));
+                    // each value is added to its neighbour's accumulator
+                    const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                    lanes[i] = _mm256_add_epi64(lanes[i], _mm256_add_epi64(product, swapped));
+                }
+            }
+
+            const unsigned char* secret = defaultSecret + Xxh3::secretSize - Xxh3::stripeLength;
+            for (size_t i = 0; i < 2; ++i) {
+                __m256i accumulator = _mm256_xor_si256(lanes[i], _mm256_srli_epi64(lanes[i], 47));
+                accumulator = _mm256_xor_si256(
+                    accumulator, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret + 32 * i)));
+
+                // 64 by 32 bit multiplication from two 32 by 32 bit ones
+                const __m256i low = _mm256_mul_epu32(accumulator, prime);
+                const __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(accumulator, 32), prime);
+                lanes[i] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+            }
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators), lanes[0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators + 4), lanes[1]);
+    }
+#endif
+
+    using AccumulateBlocks = void (*)(uint64_t*, const unsigned char*, size_t);
+
+    AccumulateBlocks getAccumulateBlocks() {
+#ifdef BFILEX_XXH3_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            return accumulateBlocksAvx2;
+        }
+#endif
+        return accumulateBlocks;
+    }
+
+    const AccumulateBlocks accumulateBlocksKernel = getAccumulateBlocks();
+}
+
+Xxh3::Xxh3()
+    : accumulators{prime32_3, prime64_1, prime64_2, prime64_3, prime64_4, prime32_2, prime64_5, prime32_1},
+      buffer{} {}
+
+void Xxh3::update(const void* data, size_t size) {
+    auto input = static_cast<const unsigned char*>(data);
+    length += size;
+
+    // a block is only consumed once more input follows it
+    if (bufferedSize > 0) {
+        const size_t copied = std::min(size, blockLength - bufferedSize);
+        std::memcpy(buffer + bufferedSize, input, copied);
+        bufferedSize += copied;
+        input += copied;
+        size -= copied;
+
+        if (size == 0) {
+            return;
+        }
+
+        accumulateBlocksKernel(accumulators, buffer, 1);
+        std::memcpy(previousStripe, buffer + blockLength - stripeLength, stripeLength);
+        bufferedSize = 0;
+    }
+
+    if (size > blockLength) {
+        const size_t blocks = (size - 1) / blockLength;
+        accumulateBlocksKernel(accumulators, input, blocks);
+
+        input += blocks * blockLength;
+        size -= blocks * blockLength;
+        std::memcpy(previousStripe, input - stripeLength, stripeLength);
+    }
+
+    std::memcpy(buffer, input, size);
+    bufferedSize = size;
+}
+
+uint64_t Xxh3::digest() const {
+    // short inputs are still whole in the buffer
+    if (length <= 240) {
+        return hashShort(buffer, length);
+    }
+
+    uint64_t finalAccumulators[8];
+    std::memcpy(finalAccumulators, accumulators, sizeof(accumulators));
+
+    // the stripes of the last block, without scrambling
+    const size_t stripes = (bufferedSize - 1) / stripeLength;
+    for (size_t stripe = 0; stripe < stripes; ++stripe) {
+        accumulateStripe(finalAccumulators, buffer + stripe * stripeLength, defaultSecret + stripe * 8);
+    }
+
+    // the last stripe ends at the end of the input, overlapping the previous block if needed
+    unsigned char lastStripe[stripeLength];
+    if (bufferedSize >= stripeLength) {
+        std::memcpy(lastStripe, buffer + bufferedSize - stripeLength, stripeLength);
+    } else {
+        const size_t previousSize = stripeLength - bufferedSize;
+        std::memcpy(lastStripe, previousStripe + stripeLength - previousSize, previousSize);
+        std::memcpy(lastStripe + previousSize, buffer, bufferedSize);
+    }
+    accumulateStripe(finalAccumulators, lastStripe, defaultSecret + lastStripeSecretOffset);
+
+    uint64_t result = length * prime64_1;
+    for (size_t i = 0; i < 4; ++i) {
+        const unsigned char* secret = defaultSecret + mergeSecretOffset + 16 * i;
+        result += multiplyFold(finalAccumulators[2 * i] ^ read64(secret),
+                               finalAccumulators[2 * i + 1] ^ read64(secret + 8));
+    }
+    return avalanche(result);
+}
+
+uint64_t Xxh3::hash(const void* data, const size_t size) {
+    Xxh3 hasher;
+    hasher.update(data, size);
+    return hasher.digest();
+}
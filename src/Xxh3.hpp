@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// streaming XXH3 64-bit hash with the default secret and seed, matching `xxhsum -H3`
+// on x86-64 the stripes are accumulated with AVX2 when the CPU supports it
+class Xxh3 {
+public:
+    static constexpr size_t stripeLength = 64;
+    static constexpr size_t secretSize = 192;
+    // stripes accumulated before the accumulators are scrambled
+    static constexpr size_t stripesPerBlock = (secretSize - stripeLength) / 8;
+    static constexpr size_t blockLength = stripeLength * stripesPerBlock;
+
+private:
+    uint64_t accumulators[8];
+    // input not consumed yet, the last block is only consumed once the length is known
+    unsigned char buffer[blockLength];
+    size_t bufferedSize{};
+    // the end of the last consumed block, the last stripe can overlap it
+    unsigned char previousStripe[stripeLength]{};
+    uint64_t length{};
+
+public:
+    Xxh3();
+
+    void update(const void* data, size_t size);
+    [[nodiscard]] uint64_t digest() const;
+
+    // hashes a whole input at once
+    static uint64_t hash(const void* data, size_t size);
+};